@@ -1,13 +1,341 @@
+#define _GNU_SOURCE		// Pour struct ucred (identité du client du démon)
 #include <stdio.h>
 #include <stdlib.h>
 #include "gmp.h"
 #include <time.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdint.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <pthread.h>
+#include <errno.h>
+#include <limits.h>
 #include <math.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
-#define K 200        // Le nombre de premiers utilisés pour le crible K<=1000
-#define securite 10  // t le paramètre entier de sécurité pour Miller-Rabin
+#define K 200        // Le nombre de premiers utilisés pour le crible sans profil de l'hôte
+
+#define NB_OPTIONS 15 // Le nombre d'options du menu principal
+#define MENU "1 : Générer de nouvelles clés RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n7 : Mesurer les performances\n8 : Lancer le démon\n9 : Vérifier un lot de signatures\n10 : Signer un fichier en arbre de Merkle\n11 : Vérifier une signature en arbre de Merkle\n12 : Générer un lot de clés RSA\n13 : Remplir la réserve de nombres premiers\n14 : Optimiser les réglages pour cette machine\n15 : Chiffrer un fichier pour plusieurs destinataires\n\n"
+
+
+// Cette fonction renvoie le temps écoulé en secondes depuis une origine fixe
+// Entrée : vide
+// Sortie : un double contenant le temps en secondes
+double chrono()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+};
+
+
+// Instrumentation des opérations, activée en compilant avec -DINSTRUMENTATION (et -DINSTRUMENTATION_PROMETHEUS pour le format Prometheus)
+// Sans ces options les macros STATS_* sont vides et l'instrumentation ne coûte rien
+enum { STAT_BLOCS, STAT_EXPONENTIATIONS, STAT_TOURS_MILLER_RABIN, STAT_CANDIDATS_TESTES, STAT_CANDIDATS_REJETES_CRIBLE, STAT_HACHAGES, STAT_OCTETS_LUS, STAT_OCTETS_ECRITS, STAT_PREMIERS_RESERVE, NB_COMPTEURS };
+enum { STAT_TOTAL, STAT_PADDING, STAT_HACHAGE, STAT_EXPONENTIATION, STAT_ENTREES_SORTIES, STAT_GENERATION_PREMIERS, STAT_COMPRESSION, NB_CHRONOS };
+
+#ifdef INSTRUMENTATION
+
+const char* noms_compteurs[NB_COMPTEURS] = {"blocs", "exponentiations", "tours_miller_rabin", "candidats_testes", "candidats_rejetes_crible", "hachages", "octets_lus", "octets_ecrits", "premiers_reserve"};
+const char* noms_chronos[NB_CHRONOS] = {"total", "padding", "hachage", "exponentiation", "entrees_sorties", "generation_premiers", "compression"};
+
+struct
+{
+	unsigned long compteurs[NB_COMPTEURS];
+	double secondes[NB_CHRONOS];
+} statistiques;
+
+_Thread_local double debuts_statistiques[NB_CHRONOS];			// Chaque thread chronomètre ses propres étapes
+pthread_mutex_t verrou_statistiques = PTHREAD_MUTEX_INITIALIZER;
+
+#define STATS_AJOUTER(compteur, valeur) __atomic_fetch_add(&statistiques.compteurs[compteur], (valeur), __ATOMIC_RELAXED)
+#define STATS_DEBUT(chrono_etape) (debuts_statistiques[chrono_etape] = chrono())
+#define STATS_FIN(chrono_etape) ajouter_duree(chrono_etape, chrono() - debuts_statistiques[chrono_etape])
+#define STATS_REINITIALISER() memset(&statistiques, 0, sizeof(statistiques))
+#define STATS_EXPORTER(operation) exporter_statistiques(operation)
+
+
+// Cette fonction ajoute une durée au temps d'une étape, les étapes du pipeline étant mesurées depuis plusieurs threads
+// Entrée : un entier chrono_etape et une durée en secondes
+// Sortie : vide
+void ajouter_duree(int chrono_etape, double duree)
+{
+	pthread_mutex_lock(&verrou_statistiques);
+	statistiques.secondes[chrono_etape] += duree;
+	pthread_mutex_unlock(&verrou_statistiques);
+};
+
+
+// Cette fonction écrit le résumé des compteurs et des temps de l'opération qui vient de se terminer
+// En JSON une ligne est ajoutée au fichier statistiques.json, au format Prometheus le fichier statistiques.prom est réécrit
+// Les compteurs sont remis à zéro à chaque opération : ce sont des valeurs par exécution, exportées en gauge et non en counter
+// Les temps sont inclusifs : le padding comprend les hachages de MGF1 qu'il déclenche. Les étapes du pipeline se recouvrent, leur somme peut dépasser le total
+// Entrée : une chaîne de caractère contenant le nom de l'opération
+// Sortie : vide
+void exporter_statistiques(const char* operation)
+{
+#ifdef INSTRUMENTATION_PROMETHEUS
+	FILE* sortie = fopen("statistiques.prom","w");
+	if(sortie == NULL)
+	{
+		return;
+	}
+	for(int i = 0; i < NB_COMPTEURS; i++)
+	{
+		fprintf(sortie, "# TYPE rsa_%s gauge\nrsa_%s{operation=\"%s\"} %lu\n", noms_compteurs[i], noms_compteurs[i], operation, statistiques.compteurs[i]);
+	}
+	fprintf(sortie, "# TYPE rsa_duree_secondes gauge\n");
+	for(int i = 0; i < NB_CHRONOS; i++)
+	{
+		fprintf(sortie, "rsa_duree_secondes{operation=\"%s\",etape=\"%s\"} %.6f\n", operation, noms_chronos[i], statistiques.secondes[i]);
+	}
+#else
+	FILE* sortie = fopen("statistiques.json","a");
+	if(sortie == NULL)
+	{
+		return;
+	}
+	fprintf(sortie, "{\"operation\":\"%s\"", operation);
+	for(int i = 0; i < NB_COMPTEURS; i++)
+	{
+		fprintf(sortie, ",\"%s\":%lu", noms_compteurs[i], statistiques.compteurs[i]);
+	}
+	for(int i = 0; i < NB_CHRONOS; i++)
+	{
+		fprintf(sortie, ",\"secondes_%s\":%.6f", noms_chronos[i], statistiques.secondes[i]);
+	}
+	fprintf(sortie, "}\n");
+#endif
+	fclose(sortie);
+};
+
+#else
+
+#define STATS_AJOUTER(compteur, valeur) ((void)0)
+#define STATS_DEBUT(chrono_etape) ((void)0)
+#define STATS_FIN(chrono_etape) ((void)0)
+#define STATS_REINITIALISER() ((void)0)
+#define STATS_EXPORTER(operation) ((void)0)
+
+#endif
+
+
+// Générateur pseudo-aléatoire cryptographique ChaCha20, un par thread, initialisé avec getrandom()
+// Chaque recharge produit TAILLE_RESERVE_ALEA octets dont les 32 premiers remplacent la clef (effacement rapide de la clef)
+#define TAILLE_RESERVE_ALEA 1024		// Le nombre d'octets produits à chaque recharge du générateur
+#define RECHARGES_AVANT_RESEMENCE 65536	// Le nombre de recharges entre deux appels à getrandom()
+
+typedef struct
+{
+	uint32_t cle[8];
+	uint64_t compteur;
+	unsigned char reserve[TAILLE_RESERVE_ALEA];
+	unsigned int position;
+	unsigned int recharges;
+} generateur_chacha20;
+
+_Thread_local generateur_chacha20 alea_thread = { .position = TAILLE_RESERVE_ALEA };
+
+#define ROTATION(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define QUART_DE_TOUR(a, b, c, d) 																	\
+	a += b; d ^= a; d = ROTATION(d, 16); 															\
+	c += d; b ^= c; b = ROTATION(b, 12); 															\
+	a += b; d ^= a; d = ROTATION(d, 8); 															\
+	c += d; b ^= c; b = ROTATION(b, 7)
+
+
+// Cette fonction calcule un bloc de 64 octets du flux ChaCha20 (nonce nul, compteur sur 64 bits)
+// Entrée : un tableau sortie de 64 octets, une clef de 8 mots de 32 bits et un compteur de bloc
+// Sortie : vide mais sortie contient le bloc du flux en little-endian
+void bloc_chacha20(unsigned char* sortie, uint32_t* cle, uint64_t compteur)
+{
+	uint32_t etat[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};	// ##
+	memcpy(etat+4, cle, 32);												// #  Constantes, clef, compteur et nonce nul
+	etat[12] = (uint32_t) compteur;											// #
+	etat[13] = (uint32_t) (compteur >> 32);									// ##
+
+	uint32_t x[16];
+	memcpy(x, etat, sizeof(x));
+	for(int i = 0; i < 10; i++)												// ##
+	{																		// #
+		QUART_DE_TOUR(x[0], x[4], x[8], x[12]);								// #
+		QUART_DE_TOUR(x[1], x[5], x[9], x[13]);								// #
+		QUART_DE_TOUR(x[2], x[6], x[10], x[14]);							// #
+		QUART_DE_TOUR(x[3], x[7], x[11], x[15]);							// #  20 tours : 10 doubles tours colonnes puis diagonales
+		QUART_DE_TOUR(x[0], x[5], x[10], x[15]);							// #
+		QUART_DE_TOUR(x[1], x[6], x[11], x[12]);							// #
+		QUART_DE_TOUR(x[2], x[7], x[8], x[13]);								// #
+		QUART_DE_TOUR(x[3], x[4], x[9], x[14]);								// #
+	}																		// ##
+
+	for(int i = 0; i < 16; i++)												// ##
+	{																		// #
+		uint32_t mot = x[i] + etat[i];										// #
+		sortie[4*i] = mot;													// #  Ajout de l'état initial et sérialisation
+		sortie[4*i+1] = mot >> 8;											// #
+		sortie[4*i+2] = mot >> 16;											// #
+		sortie[4*i+3] = mot >> 24;											// #
+	}																		// ##
+};
+
+
+// Cette fonction recharge la réserve du générateur du thread et renouvelle sa clef, en la ressemant avec getrandom() au premier appel puis périodiquement
+// Entrée : un générateur
+// Sortie : vide mais la réserve contient TAILLE_RESERVE_ALEA-32 octets neufs
+void recharger_alea(generateur_chacha20* generateur)
+{
+	if(generateur->recharges % RECHARGES_AVANT_RESEMENCE == 0)								// ##
+	{																						// #
+		uint32_t graine[8];																	// ##
+		size_t lu = 0;																		// #
+		while(lu < sizeof(graine))															// #
+		{																					// #
+			ssize_t r = getrandom((unsigned char*) graine + lu, sizeof(graine) - lu, 0);	// #
+			if(r > 0)																		// #
+			{																				// #
+				lu += r;																	// #
+			}																				// #  Semence (ou resemence) avec l'aléa du noyau : getrandom() n'est
+			else if(errno != EINTR)															// #  relancé qu'après une interruption, sinon (noyau sans getrandom(), ENOSYS)
+			{																				// #  on lit /dev/urandom et on s'arrête s'il est absent
+				FILE* urandom = fopen("/dev/urandom","rb");									// #
+				if((urandom == NULL) || (fread((unsigned char*) graine + lu, 1, sizeof(graine) - lu, urandom) != sizeof(graine) - lu))	// #
+				{																			// #
+					fprintf(stderr, "\nAucune source d'aléa du noyau n'est disponible.\n");	// #
+					abort();																// #
+				}																			// #
+				fclose(urandom);															// #
+				lu = sizeof(graine);														// #
+			}																				// #
+		}																					// #
+		for(int i = 0; i < 8; i++)															// #
+		{																					// #
+			generateur->cle[i] ^= graine[i];												// #
+		}																					// #
+		memset(graine, 0, sizeof(graine));													// #
+	}																						// ##
+	generateur->recharges++;
+
+	for(unsigned int i = 0; i < TAILLE_RESERVE_ALEA; i += 64)								// ##
+	{																						// #  Production de la réserve
+		bloc_chacha20(generateur->reserve + i, generateur->cle, generateur->compteur++);	// #
+	}																						// ##
+
+	memcpy(generateur->cle, generateur->reserve, 32);										// ##
+	memset(generateur->reserve, 0, 32);														// #  Les 32 premiers octets deviennent la nouvelle clef
+	generateur->position = 32;																// ##
+};
+
+
+// Cette fonction remplit un tampon d'octets aléatoires avec le générateur du thread appelant
+// Entrée : un tableau tampon et sa taille
+// Sortie : vide mais tampon contient taille octets aléatoires
+void alea_octets(unsigned char* tampon, size_t taille)
+{
+	generateur_chacha20* generateur = &alea_thread;
+	while(taille > 0)
+	{
+		if(generateur->position == TAILLE_RESERVE_ALEA)							// #  Recharge lorsque la réserve est vide
+		{																		// #
+			recharger_alea(generateur);											// #
+		}																		// #
+		size_t morceau = TAILLE_RESERVE_ALEA - generateur->position;			// ##
+		if(morceau > taille)													// #
+		{																		// #
+			morceau = taille;													// #
+		}																		// #  Copie puis effacement des octets servis
+		memcpy(tampon, generateur->reserve + generateur->position, morceau);	// #
+		memset(generateur->reserve + generateur->position, 0, morceau);			// #
+		generateur->position += morceau;										// #
+		tampon += morceau;														// #
+		taille -= morceau;														// ##
+	}
+};
+
+
+// Cette fonction remplit un tampon d'octets aléatoires non nuls, pour le padding PKCS#1 v1.5
+// Entrée : un tableau tampon et sa taille
+// Sortie : vide mais tampon contient taille octets aléatoires entre 1 et 255
+void alea_octets_non_nuls(unsigned char* tampon, size_t taille)
+{
+	alea_octets(tampon, taille);
+	for(size_t i = 0; i < taille; i++)
+	{
+		while(tampon[i] == 0)			// #  Nouveau tirage des octets nuls
+		{								// #
+			alea_octets(tampon+i, 1);	// #
+		}								// #
+	}
+};
+
+
+// Cette fonction initialise un générateur GMP avec 256 bits issus du générateur ChaCha20
+// Entrée : un générateur aléatoire GMP
+// Sortie : vide mais le générateur est semé
+void semer_generateur_gmp(gmp_randstate_t generateur)
+{
+	unsigned char graine[32];
+	mpz_t z;
+	alea_octets(graine, sizeof(graine));
+	mpz_init(z);
+	mpz_import(z, sizeof(graine), 1, 1, 1, 0, graine);
+	gmp_randseed(generateur, z);
+	mpz_clear(z);
+	memset(graine, 0, sizeof(graine));
+};
+
+
+// Cette fonction tire un mpz uniforme entre 0 et borne-1 directement avec le générateur ChaCha20 du thread, en rejetant les tirages trop grands
+// Les valeurs secrètes (bases de Miller-Rabin, candidats premiers, aléas d'aveuglement) ne passent ainsi jamais par le générateur de GMP
+// Entrée : deux mpz resultat et borne, avec borne > 0
+// Sortie : vide mais resultat contient le tirage
+void alea_mpz(mpz_t resultat, const mpz_t borne)
+{
+	size_t bits = mpz_sizeinbase(borne, 2);
+	size_t octets = (bits + 7) / 8;
+	unsigned char* tampon = malloc(octets);
+	do
+	{
+		alea_octets(tampon, octets);
+		tampon[0] &= 0xFF >> (8*octets - bits);					// #  Autant de bits que borne, moins d'un tirage sur deux est rejeté
+		mpz_import(resultat, octets, 1, 1, 1, 0, tampon);
+	}while(mpz_cmp(resultat, borne) >= 0);
+	memset(tampon, 0, octets);
+	free(tampon);
+};
+
+
+// Cette fonction donne au générateur ChaCha20 du thread une clef fixe, pour que les mesures de optimisation_crible() tirent les mêmes candidats
+// resemer_alea_thread() doit être appelée après les mesures
+// Entrée : un entier graine
+// Sortie : vide
+void fixer_alea_thread(uint64_t graine)
+{
+	memset(&alea_thread, 0, sizeof(alea_thread));
+	alea_thread.compteur = graine;
+	alea_thread.recharges = 1;									// #  Pas de semence par getrandom() à la prochaine recharge
+	alea_thread.position = TAILLE_RESERVE_ALEA;
+};
+
+
+// Cette fonction efface l'état du générateur ChaCha20 du thread : la prochaine recharge le ressème entièrement avec l'aléa du noyau
+// Entrée : vide
+// Sortie : vide
+void resemer_alea_thread()
+{
+	memset(&alea_thread, 0, sizeof(alea_thread));
+	alea_thread.position = TAILLE_RESERVE_ALEA;
+};
 
 
 // Cette fonction renvoie le reste modulaire d'un unsigned int
@@ -78,1221 +406,6726 @@ void ui_expo_ui(mpz_t resultat, unsigned int a, unsigned int b)
 };
 
 
-// Cette fonction calcule une exponentiation modulaire et l'affecte à un mpz
-// Entrée : quatre mpz resultat,m,d et n
-// Sortie : void mais resultat = m^d [n]
-void exp_mod(mpz_t resultat, mpz_t m, mpz_t d, mpz_t n) 
+// Profil de l'hôte : réglages mesurés sur la machine par les modes d'optimisation, lus au démarrage dans FICHIER_PROFIL
+// Une ligne par réglage, les lignes inconnues sont ignorées. Sans profil les valeurs par défaut sont utilisées
+#define FICHIER_PROFIL "profil_hote.txt"
+#define MAX_K 8192					// Le nombre maximal de premiers du crible, calculés au démarrage
+#define NB_TAILLES_PROFIL 16		// Le nombre de tailles de premiers et de tailles de clefs réglées dans le profil
+#define MAX_FENETRE 6				// La plus grande fenêtre d'exponentiation des noyaux de Montgomery
+#define BLOCS_PAR_LOT 64			// Le nombre de blocs traités ensemble par chaque étape du pipeline sans profil de l'hôte
+#define MAX_BLOCS_PAR_LOT 4096		// Le plus grand nombre de blocs par lot accepté dans le profil
+#define MAX_WORKERS_PROFIL 256		// Le plus grand nombre de workers d'exponentiation accepté dans le profil
+
+// Réglage du crible pour une taille de premier : nombre de premiers du crible et tours de Miller-Rabin
+typedef struct
 {
-	mpz_t a;								// ##
-	mpz_t b;								// #
-	mpz_inits(a,b,NULL);					// #
-											// #  Initialisation des variables
-	mpz_set(a,m);							// #
-	mpz_set(b,d);							// #
-	mpz_set_ui(resultat,1);					// ##
+	unsigned int bits;
+	unsigned int k;
+	unsigned int tours;
+} reglage_crible;
 
-	while(mpz_cmp_ui(b,0) != 0)				// ##
-	{										// #
-		if(modulo_ui(b,2) == 1)				// #
-		{									// #
-			mpz_mul(resultat,resultat,a);	// #
-			modulo(resultat,resultat,n);	// #  Calcul de a^b par l'exponentiation rapide avec calcule de restes modulo n
-			mpz_sub_ui(b,b,1);				// #
-		}									// #
-		mpz_mul(a,a,a);						// #
-		modulo(a,a,n);						// #
-		mpz_divexact_ui(b,b,2);				// #
-	}										// ##
+// Réglage du calcul pour une taille de module : fenêtre d'exponentiation (0 pour le choix par défaut), workers d'exponentiation et blocs par lot du pipeline
+typedef struct
+{
+	unsigned int bits;
+	unsigned int fenetre;
+	unsigned int nb_workers;
+	unsigned int blocs_par_lot;
+} reglage_cle;
 
-	mpz_clears(a,b,NULL);
-};
+struct
+{
+	reglage_crible crible[NB_TAILLES_PROFIL];
+	unsigned int nb_crible;
+	reglage_cle cles[NB_TAILLES_PROFIL];
+	unsigned int nb_cles;
+} profil_hote;
 
+unsigned int premiers_crible[MAX_K];								// Les MAX_K plus petits premiers
+pthread_once_t calcul_premiers_crible = PTHREAD_ONCE_INIT;
 
-// Cette fonction est la même que la précédente mais l'exposant est un entier
-// Entrée : trois mpz resultat, m et n et un entier d
-// Sortie : vide mais resultat = m^d [n]
-void exp_mod_ui(mpz_t resultat, mpz_t m, unsigned int d, mpz_t n)
+
+// Cette fonction calcule les MAX_K plus petits premiers par le crible d'Eratosthène
+// Entrée : vide
+// Sortie : vide mais premiers_crible est rempli
+void calculer_premiers_crible()
 {
-	mpz_t z_d;
-	mpz_init_set_ui(z_d,d);		// Convertion de d d'entier à mpz
+	unsigned int limite = 100000;									// ##
+	unsigned char* compose = calloc(limite, 1);						// #
+	unsigned int nb = 0;											// #
+	for(unsigned int i = 2; (i < limite) && (nb < MAX_K); i++)		// #
+	{																// #
+		if(compose[i] == 0)											// #  Le MAX_K-ième premier (84589 pour 8192) est sous la limite
+		{															// #
+			premiers_crible[nb++] = i;								// #
+			for(unsigned long j = (unsigned long) i*i; j < limite; j += i)	// #
+			{														// #
+				compose[j] = 1;										// #
+			}														// #
+		}															// #
+	}																// #
+	free(compose);													// ##
+};
 
-	exp_mod(resultat,m,z_d,n);	// Calcul du résultat via la fonction précédente exp_mod()
 
-	mpz_clear(z_d);
+// Cette fonction donne le nombre de tours de Miller-Rabin pour une probabilité d'erreur inférieure à 2^-80 sur un candidat aléatoire
+// Les seuils sont ceux de la table 4.4 du Handbook of Applied Cryptography (Damgård, Landrock et Pomerance)
+// Entrée : un entier bits
+// Sortie : le nombre de tours
+unsigned int tours_miller_rabin(unsigned int bits)
+{
+	unsigned int seuils[11] = {1300, 850, 650, 550, 450, 400, 350, 300, 250, 200, 150};
+	unsigned int tours[11] = {2, 3, 4, 5, 6, 7, 8, 9, 12, 15, 18};
+	for(int i = 0; i < 11; i++)
+	{
+		if(bits >= seuils[i])
+		{
+			return tours[i];
+		}
+	}
+	return 27;
 };
 
 
-// Cette fonction calcule PGCD(a,b) et les coefficients de Bezout associés avec euclide étendu
-// Entrée : cinq mpz a,b,x,y et pgcd
-// Sortie : vide mais pgcd = PGCD(a,b) et pgcd = ax + by
-void euclid_gcd(mpz_t a,mpz_t b, mpz_t x, mpz_t y, mpz_t pgcd)
+// Cette fonction donne le réglage du profil le plus proche d'une taille de premier
+// Entrée : un entier bits
+// Sortie : un pointeur vers le réglage, NULL si le profil n'en contient pas
+reglage_crible* reglage_crible_pour(unsigned int bits)
 {
-	mpz_t u,v,q,r,m,n;				// ##
-	mpz_inits(u,v,q,r,m,n, NULL);	// #
-	mpz_set_ui(u,1);				// #  Initialisation des variables
-	mpz_set_ui(y,1);				// #
-	mpz_set_ui(x,0);				// #
-	mpz_set_ui(v,0);				// ##
+	reglage_crible* meilleur = NULL;
+	for(unsigned int i = 0; i < profil_hote.nb_crible; i++)
+	{
+		reglage_crible* reglage = &profil_hote.crible[i];
+		if((meilleur == NULL) || (abs((int) reglage->bits - (int) bits) < abs((int) meilleur->bits - (int) bits)))
+		{
+			meilleur = reglage;
+		}
+	}
+	return meilleur;
+};
 
-	while (mpz_cmp_ui(b,0) !=0)		// ##
-	{								// #
-		mpz_fdiv_qr(q,r,a,b);		// #
-		mpz_mul(m,u,q);				// #
-		mpz_mul(n,v,q);				// #
-		mpz_sub(m,x,m);				// #
-		mpz_sub(n,y,n);				// #  
-		mpz_set(a,b);				// #  Calcul du PGCD par euclide étendu
-		mpz_set(b,r);				// #
-		mpz_set(x,u);				// #
-		mpz_set(y,v);				// #
-		mpz_set(u,m);				// #
-		mpz_set(v,n);				// #
-	}								// #
-	mpz_set(pgcd,a);				// ##
 
-	mpz_clears(u,v,q,r,m,n,NULL);		
+// Cette fonction donne le nombre de premiers du crible pour une taille de premier, K sans profil
+// Entrée : un entier bits
+// Sortie : le nombre de premiers du crible
+unsigned int taille_crible(unsigned int bits)
+{
+	reglage_crible* reglage = reglage_crible_pour(bits);
+	return (reglage != NULL) ? reglage->k : K;
 };
 
 
-// Cette fonction calcule l'inverse modulaire si il existe
-// Entrée : trois mpz inv_mod,b et a
-// Sortie : vide mais inv_mod = b^(-1) [a]
-void modular_inv(mpz_t inv_mod, mpz_t b, mpz_t a)
+// Cette fonction donne le nombre de tours de Miller-Rabin pour une taille de premier, celui de la table sans profil
+// Entrée : un entier bits
+// Sortie : le nombre de tours
+unsigned int nb_tours_miller_rabin(unsigned int bits)
 {
-	mpz_t save_a,x,y,pgcd,save_b;				// ##
-	mpz_inits(save_a,x,y,pgcd,save_b,NULL);		// #  Initialisation des variables et sauvegarde de a et b
-	mpz_set(save_a,a);							// #
-	mpz_set(save_b,b);							// ##
-	
-	euclid_gcd(a,b,x,y,pgcd);					// Calcul du PGCD et des coefficients de Bezout
-	
-	if (mpz_cmp_ui(pgcd,1) != 0)				// ##
-	{											// #
-		mpz_set_ui(inv_mod,0);					// #  Vérification de PGCD(a,b) = 1
-		mpz_clears(x,y,pgcd,NULL);				// #
-		return;									// #
-	}											// ##
-	
-	modulo(inv_mod , x , save_a);				// ##
-	mpz_set(a,save_a);							// #  Réduction et affectattion de b^(-1) [a] et remise de a et b à leur valeur initiale
-	mpz_set(b,save_b);							// ##
-	
-	mpz_clears(x,y,pgcd,save_a,save_b,NULL);
+	reglage_crible* reglage = reglage_crible_pour(bits);
+	return ((reglage != NULL) && (reglage->bits == bits)) ? reglage->tours : tours_miller_rabin(bits);
 };
 
 
-// Cette fonction vérifie si un nombre et premier par Miller-Rabin
-// Entrée : un mpz nombre et un générateur aléatoire generateur
-// Sortie : 0 si nombre est composé et 1 s'il est probablement premier
-int Miller_Rabin(mpz_t nombre, gmp_randstate_t generateur)
+// Cette fonction ajoute ou remplace le réglage d'une taille de premier dans le profil
+// Le profil peut seulement augmenter le nombre de tours : il ne descend jamais sous celui de tours_miller_rabin()
+// Entrée : trois entiers bits, k et tours
+// Sortie : vide
+void regler_crible(unsigned int bits, unsigned int k, unsigned int tours)
 {
-	mpz_t r, a, y, j;
-	mpz_inits(r, a, y, j, NULL);											// ##
-	mpz_set(r, nombre);														// #  Initialisation des variables
-	mpz_sub_ui(r,r,1);														// #
-	int s = 0;																// ##
-	
-	while(modulo_ui(r,2) == 0)												// ##
-	{																		// #
-		s++;																// #  Calcul de r et s tel que nombre-1 = r x 2^s
-		mpz_divexact_ui(r,r,2);												// #
-	}																		// ##
-
-	for(unsigned int i =1; i< securite; i++)								// Boucle avec le paramètre de sécurité
+	reglage_crible* reglage = reglage_crible_pour(bits);
+	if((reglage == NULL) || (reglage->bits != bits))
 	{
-		mpz_sub_ui(nombre,nombre,3);										// ##
-		mpz_urandomm(a, generateur, nombre);								// #  Tirage aléatoire de a entre 2 et n-2
-		mpz_add_ui(nombre,nombre,3);										// #
-		mpz_add_ui(a, a, 2);												// ##
-
-		exp_mod(y,a,r,nombre);												// Calcul de y = a^r [nombre]
-		
-		mpz_sub_ui(nombre,nombre,1); 										
-		if((mpz_cmp_ui(y,1) != 0) && (mpz_cmp(y,nombre) != 0))				
+		if(profil_hote.nb_crible == NB_TAILLES_PROFIL)
 		{
-			mpz_set_ui(j,1);
-			while((mpz_cmp_ui(j,(s-1)) <= 0) && (mpz_cmp(y,nombre) != 0))	// ##
-			{																// #
-				mpz_add_ui(nombre,nombre,1);								// #
-				exp_mod_ui(y,y,2,nombre);									// #
-				mpz_sub_ui(nombre,nombre,1); 								// #
-				if(mpz_cmp_ui(y,1) == 0)									// #
-				{															// #
-					mpz_add_ui(nombre,nombre,1); 							// #
-					mpz_clears(r, a, y, j, NULL);							// #
-					return 0;												// #
-				}															// #  Test de Miller-Rabin
-				mpz_add_ui(j,j,1);											// #
-			}																// #									
-			if(mpz_cmp(y,nombre) != 0)										// #
-			{																// #
-				mpz_add_ui(nombre,nombre,1); 								// #
-				mpz_clears(r, a, y, j, NULL);								// #
-				return 0;													// #
-			}																// #
-		}																	// #
-		mpz_add_ui(nombre,nombre,1);										// ##
+			return;
+		}
+		reglage = &profil_hote.crible[profil_hote.nb_crible++];
 	}
+	reglage->bits = bits;
+	reglage->k = (k > MAX_K) ? MAX_K : ((k < 1) ? 1 : k);
+	reglage->tours = (tours < tours_miller_rabin(bits)) ? tours_miller_rabin(bits) : tours;
+};
 
-	mpz_clears(r, a, y, j, NULL);
-	return 1;
+
+// Cette fonction donne le réglage du profil le plus proche d'une taille de module
+// Entrée : un entier bits
+// Sortie : un pointeur vers le réglage, NULL si le profil n'en contient pas
+reglage_cle* reglage_cle_pour(unsigned int bits)
+{
+	reglage_cle* meilleur = NULL;
+	for(unsigned int i = 0; i < profil_hote.nb_cles; i++)
+	{
+		reglage_cle* reglage = &profil_hote.cles[i];
+		if((meilleur == NULL) || (abs((int) reglage->bits - (int) bits) < abs((int) meilleur->bits - (int) bits)))
+		{
+			meilleur = reglage;
+		}
+	}
+	return meilleur;
 };
 
 
-// Cette fonction génère aléatoirement un nombre premier par la méthode du crible optimisé
-// Entrée : un mpz nb_premier, un entier b et un générateur alétoire state
-// Sortie : vide mais nb_premier est un nombre premier de taille b bits
-void optimized_crible_generation(mpz_t nb_premier, unsigned int b, gmp_randstate_t state)
+// Cette fonction donne la fenêtre d'exponentiation pour un module et un exposant, celle du profil pour les exposants de plus de 20 bits
+// Entrée : deux entiers bits_module et bits_exposant
+// Sortie : la largeur de la fenêtre entre 1 et MAX_FENETRE
+unsigned int fenetre_exponentiation(unsigned int bits_module, unsigned int bits_exposant)
 {
-	mpz_t sub;												// ##																			
-	mpz_t s_1;												// #  Initialisation des variables
-	mpz_t s_2;												// #
-	mpz_inits(sub,s_1,s_2,NULL);							// ##
+	if(bits_exposant <= 20)
+	{
+		return 1;
+	}
+	reglage_cle* reglage = reglage_cle_pour(bits_module);
+	if((reglage != NULL) && (reglage->fenetre != 0))
+	{
+		return reglage->fenetre;
+	}
+	return (bits_exposant <= 512) ? 4 : 5;
+};
 
-	unsigned int res[K];									// ##
-	unsigned int r;											// #  Déclaration d'un tableau de résidus et d'un tableau de premiers de taille K
-	unsigned int premiers[K];								// ##
-	
-	FILE* fichier;											// #  Ouverture du fichier contenant les XX premiers nombres premiers
-	fichier = fopen("primes.txt","r");						// #
-	
-	for(unsigned int i = 0; i< K; i++)						// ##
-	{														// #
-		fscanf(fichier,"%d",premiers+i);					// #  Lecture et stockage des K plus petits premiers
-		fgetc(fichier);										// #
-	}														// ##
-	
-	ui_expo_ui(s_1,2,b);									// ##
-	ui_expo_ui(s_2,2,b-1);									// #  Calcul de sub = 2^b - 2^(b-1) -1
-	mpz_sub(sub,s_1,s_2);									// #
-	mpz_sub_ui(sub,sub,1);									// ##
-	
-	do 														// ##
-	{														// #
-		mpz_urandomm(nb_premier,state,sub);					// #  Génération d'un nombre aléatoire impaire s'écrivant sur b bits
-		mpz_add(nb_premier,nb_premier,s_2);					// #
-		r = modulo_ui(nb_premier,2);						// #
-	}while(r == 0);											// ##
-	
-	for(int i=0;i<K;i++) 									// ## 
-	{														// #
-		r = modulo_ui(nb_premier,premiers[i]);				// #  Initialisation du tableau de résidus
-		res[i] = r;											// #
-	}														// ##
 
-	etiquette:
-		for(unsigned int j=0;j<K;j++)						// ##
-		{													// #
-			while(res[j] == 0)								// #
-			{												// #
-				for(unsigned int l=0;l<K;l++)				// #
-				{											// #  Modification de nb_premier jusqu'à trouver un candidat
-					res[l] = mod(res[l]+2, premiers[l]);	// #
-				}											// #
-				mpz_add_ui(nb_premier,nb_premier,2);		// #
-			}												// #
-		}													// ##
+// Cette fonction donne le nombre de workers de l'étape d'exponentiation du pipeline pour une taille de clef, 1 sans profil
+// Entrée : un entier bits
+// Sortie : le nombre de workers
+unsigned int workers_exponentiation(unsigned int bits)
+{
+	reglage_cle* reglage = reglage_cle_pour(bits);
+	return (reglage != NULL) ? reglage->nb_workers : 1;
+};
 
-		if(Miller_Rabin(nb_premier,state) == 0)				// ##
-		{													// #
-			for(int m=0;m<K;m++)							// #
-			{												// #
-				res[m] = mod(res[m]+2, premiers[m]);		// #  Appel de la fonction Miller_Rabin() pour tester notre candidat, on recommence au cas échéant
-			}												// #
-			mpz_add_ui(nb_premier,nb_premier,2);			// #
-			goto etiquette;									// #
-		}													// ##
-		goto etiquette2;
 
-	etiquette2:
-		fclose(fichier);
-		mpz_clears(sub,s_1,s_2,NULL);
+// Cette fonction donne le nombre de blocs par lot du pipeline pour une taille de clef, BLOCS_PAR_LOT sans profil
+// Entrée : un entier bits
+// Sortie : le nombre de blocs par lot
+unsigned int blocs_par_lot(unsigned int bits)
+{
+	reglage_cle* reglage = reglage_cle_pour(bits);
+	return (reglage != NULL) ? reglage->blocs_par_lot : BLOCS_PAR_LOT;
 };
 
 
-// Cette fonction génère l'ensemble des clefs publique et secrète nécessaire pour RSA
-// Entrée : un entier nombre_bit et un génnérateur aléatoire generateur
-// Sortie : vide mais création d'un fichier contenant une clef publique et un autre la clef secrète associée
-void generation_cle(unsigned int nombre_bit, gmp_randstate_t generateur)
+// Cette fonction ajoute ou remplace le réglage d'une taille de module dans le profil
+// Entrée : quatre entiers bits, fenetre, nb_workers et blocs
+// Sortie : vide
+void regler_cle(unsigned int bits, unsigned int fenetre, unsigned int nb_workers, unsigned int blocs)
 {
+	reglage_cle* reglage = reglage_cle_pour(bits);
+	if((reglage == NULL) || (reglage->bits != bits))
+	{
+		if(profil_hote.nb_cles == NB_TAILLES_PROFIL)
+		{
+			return;
+		}
+		reglage = &profil_hote.cles[profil_hote.nb_cles++];
+	}
+	reglage->bits = bits;
+	reglage->fenetre = (fenetre > MAX_FENETRE) ? MAX_FENETRE : fenetre;
+	reglage->nb_workers = (nb_workers > MAX_WORKERS_PROFIL) ? MAX_WORKERS_PROFIL : ((nb_workers < 1) ? 1 : nb_workers);
+	reglage->blocs_par_lot = (blocs > MAX_BLOCS_PAR_LOT) ? MAX_BLOCS_PAR_LOT : ((blocs < 1) ? 1 : blocs);
+};
 
-	mpz_t borne, phi, e, cle_publique, cle_prive, p, q, Ip;							// ##
-	mpz_inits(borne,phi,e, cle_publique, cle_prive, p, q, Ip, NULL);				// #  Initialisation des variables
-	mpz_set_ui(e,65537);															// #
-	char choix;																		// ##
 
-	char nom_fichier_cle_publique[100];																									// ##
-	etiquette:																															// #
-		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker la clé publique?\n\n");									// #
-		scanf(" %99s", nom_fichier_cle_publique);																							// #
-		if(access( nom_fichier_cle_publique, F_OK ) == 0)																				// #
-		{																																// #
-			printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
-			scanf(" %c",&choix);																										// #
-			while((choix != 'Y') & (choix != 'N'))																						// #
-			{																															// #  Création et ouverture du fichier qui contiendra la clef publique
-				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
-				scanf(" %c",&choix);																									// #
-			}																															// #
-			if(choix == 'N')																											// #
-			{																															// #
-				goto etiquette;																											// #
-			}																															// #
-		}																																// #
-	FILE* publique = fopen(nom_fichier_cle_publique,"wb+");																				// ##
+// Cette fonction lit le profil de l'hôte s'il existe
+// Entrée : vide
+// Sortie : vide mais profil_hote contient les réglages du fichier
+void charger_profil_hote()
+{
+	FILE* fichier = fopen(FICHIER_PROFIL,"r");
+	if(fichier == NULL)
+	{
+		return;
+	}
+	char ligne[256];
+	unsigned int bits, k, tours, fenetre, nb_workers, blocs;
+	while(fgets(ligne, sizeof(ligne), fichier) != NULL)
+	{
+		if(sscanf(ligne, "crible %u %u %u", &bits, &k, &tours) == 3)
+		{
+			regler_crible(bits, k, tours);
+		}
+		else if(sscanf(ligne, "cle %u %u %u %u", &bits, &fenetre, &nb_workers, &blocs) == 4)
+		{
+			regler_cle(bits, fenetre, nb_workers, blocs);
+		}
+	}
+	fclose(fichier);
+};
 
 
-	char nom_fichier_cle_secrete[100];																									// ##
-	etiquette2:																															// #
-    	printf("\nQuel est le nom du fichier dans lequel vous désirez stocker la clé privée?\n\n");										// #
-   		scanf(" %99s", nom_fichier_cle_secrete);																							// #
-   		if(access( nom_fichier_cle_secrete, F_OK ) == 0)																				// #
-		{																																// #
-			printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
-			scanf(" %c",&choix);																										// #
-			while((choix != 'Y') & (choix != 'N'))																						// #
-			{																															// #  Création et ouverture du fichier qui contiendra la clef secrète
-				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
-				scanf(" %c",&choix);																									// #
-			}																															// #
-			if(choix == 'N')																											// #
-			{																															// #
-				goto etiquette2;																										// #
-			}																															// #
-		}																																// #
-	FILE* secret = fopen(nom_fichier_cle_secrete,"wb+");																				// ##
+// Cette fonction écrit le profil de l'hôte
+// Entrée : vide
+// Sortie : vide mais FICHIER_PROFIL contient tous les réglages de profil_hote
+void ecrire_profil_hote()
+{
+	FILE* fichier = fopen(FICHIER_PROFIL,"w");
+	fprintf(fichier, "# Profil de l'hôte, écrit par les modes d'optimisation\n");
+	fprintf(fichier, "# crible <bits du premier> <premiers du crible> <tours de Miller-Rabin>\n");
+	for(unsigned int i = 0; i < profil_hote.nb_crible; i++)
+	{
+		fprintf(fichier, "crible %u %u %u\n", profil_hote.crible[i].bits, profil_hote.crible[i].k, profil_hote.crible[i].tours);
+	}
+	fprintf(fichier, "# cle <bits du module> <fenêtre d'exponentiation> <workers d'exponentiation> <blocs par lot>\n");
+	for(unsigned int i = 0; i < profil_hote.nb_cles; i++)
+	{
+		fprintf(fichier, "cle %u %u %u %u\n", profil_hote.cles[i].bits, profil_hote.cles[i].fenetre, profil_hote.cles[i].nb_workers, profil_hote.cles[i].blocs_par_lot);
+	}
+	fclose(fichier);
+};
 
 
-	ui_expo_ui(borne,2,nombre_bit-1);												// ##
-	do 																				// #
-	{																				// #
-		if( mod(nombre_bit,2) == 0)													// #
-		{																			// #
-			optimized_crible_generation(p, nombre_bit/2, generateur);				// #
-			optimized_crible_generation(q, nombre_bit/2, generateur);				// #
-		}																			// #
-		else																		// # Appel de la fonction optimized_crible_generation() pour génèrer p et q et calcul de la clef publique avec vériffication de sa taille
-		{																			// #
-			optimized_crible_generation(p, (nombre_bit-1)/2, generateur);			// #
-			optimized_crible_generation(q, (nombre_bit+1)/2, generateur);			// #
-		}																			// #
-		mpz_mul(cle_publique, p, q);												// #
-	}																				// #
-	while(mpz_cmp(cle_publique,borne) >= 0);										// ##
+// Arithmétique de Montgomery à nombre de limbs fixe pour les modules de 1024, 1536, 2048, 3072 et 4096 bits
+// Chaque taille a ses propres fonctions générées par DEFINIR_MONTGOMERY(N) : toutes les boucles ont une longueur connue à la compilation, sans allocation ni choix de taille pendant le calcul
+// exp_mod() les utilise pour les modules impairs de ces tailles et garde GMP pour les autres
+#if (GMP_NUMB_BITS == 64) && defined(__SIZEOF_INT128__)
 
-	mpz_sub_ui(p,p,1);																// ## 
-	mpz_sub_ui(q,q,1);																// #
-	mpz_mul(phi,p,q);																// #  Calcul de phi
-	mpz_add_ui(p,p,1);																// #
-	mpz_add_ui(q,q,1);																// ##
+#define MONTGOMERY_FIXE
+#define MAX_LIMBS_FIXES 64				// Le plus grand nombre de limbs de 64 bits traité par les noyaux fixes (4096 bits)
+#define TAILLE_CACHE_MONTGOMERY 4		// Le nombre de modules dont chaque thread garde les constantes de Montgomery
 
-	modular_inv(cle_prive, e, phi);													// #  Calcul de la clef secrète
-	modular_inv(Ip,p,q);															// #
+typedef unsigned __int128 double_limb;
 
-	mpz_out_raw(publique,cle_publique);												// #  Ecriture des clefs dans leur fichier respectifs
-	mpz_out_raw(secret,cle_prive);													// #
-	mpz_out_raw(secret,p);
-	mpz_out_raw(secret,q);
-	mpz_out_raw(secret,Ip);
-	
-	mpz_clears(borne, phi, e, cle_publique, cle_prive, p, q, Ip, NULL);
-	fclose(publique);
-	fclose(secret);
-};
+// acc:c2 est l'accumulateur de Comba sur trois limbs : acc reçoit le produit, c2 compte les débordements
+#define MAC_COMBA(acc, c2, x, y)																	\
+	do																								\
+	{																								\
+		double_limb produit_ = (double_limb) (x) * (y);												\
+		(acc) += produit_;																			\
+		(c2) += ((acc) < produit_);																	\
+	} while(0)
 
+// Décale l'accumulateur d'un limb vers la droite une fois la colonne écrite
+#define DECALER_COMBA(acc, c2)																		\
+	do																								\
+	{																								\
+		(acc) = ((acc) >> 64) | ((double_limb) (c2) << 64);											\
+		(c2) = 0;																					\
+	} while(0)
 
-// Cette fonction donne la taille d'un nombre en base 256
-// Entrée : un mpz n
-// Sortie : un entier compteur donnant en combien d'octet s'écrit n
-unsigned int taille_256(mpz_t n)
-{
-	mpz_t a;						// ##
-	mpz_init_set_ui(a,256);			// #  Initialisation des variables
-	unsigned int compteur = 1;		// ##
 
-	while(mpz_cmp(n,a) > 0)			// ##
-	{								// #
-		mpz_mul_ui(a,a,256);		// #  Boucle comparant n avec les puissances de 256 jusqu'à ce que n < 256^a
-		compteur = compteur+1;		// #
-	}								// ##
+// Cette fonction termine une réduction de Montgomery : r = t - n si t dépasse n, t sinon
+// Entrée : un tableau résultat r, un tableau t de nb limbs et sa retenue, un module n et un entier nb
+// Sortie : vide mais r contient t réduit
+void finir_montgomery(uint64_t* r, const uint64_t* t, uint64_t retenue, const uint64_t* n, int nb)
+{
+	int superieur = (retenue != 0);
+	if(superieur == 0)
+	{
+		superieur = 1;
+		for(int i = nb-1; i >= 0; i--)
+		{
+			if(t[i] != n[i])
+			{
+				superieur = (t[i] > n[i]);
+				break;
+			}
+		}
+	}
 
-	mpz_clear(a);
-	return(compteur);
+	uint64_t emprunt = 0;
+	for(int i = 0; i < nb; i++)
+	{
+		uint64_t x = t[i];
+		uint64_t y = superieur ? n[i] : 0;
+		r[i] = x - y - emprunt;
+		emprunt = (x < y) || ((x == y) && emprunt);
+	}
 };
 
 
-// Cette fonction hashe un fichier à partir de son nom
-// Entrée : une chaine de caractere contenant le nom du fichier à hasher
-// Sortie : vide mais crée un fichier de 256 bits contenant le hasher du fichier d'entrée sous le nom HASHER
-void SHA256(char* nom_du_fichier_a_hasher)
+// Génère pour N limbs : le produit et le carré de Comba (colonne par colonne avec un accumulateur de trois limbs), la réduction de Montgomery et leurs combinaisons
+// Les boucles internes sont déroulées par le compilateur, les boucles sur les colonnes restent des boucles pour garder un code de taille raisonnable
+#define DEFINIR_MONTGOMERY(N)																		\
+void produit_comba_##N(uint64_t* t, const uint64_t* a, const uint64_t* b)							\
+{																									\
+	double_limb acc = 0;																			\
+	uint64_t c2 = 0;																				\
+	for(int k = 0; k < 2*N-1; k++)																	\
+	{																								\
+		int debut = (k < N) ? 0 : k-N+1;															\
+		int fin = (k < N) ? k : N-1;																\
+		_Pragma("GCC unroll 8")																		\
+		for(int i = debut; i <= fin; i++)															\
+		{																							\
+			MAC_COMBA(acc, c2, a[i], b[k-i]);														\
+		}																							\
+		t[k] = (uint64_t) acc;																		\
+		DECALER_COMBA(acc, c2);																		\
+	}																								\
+	t[2*N-1] = (uint64_t) acc;																		\
+}																									\
+																									\
+void carre_comba_##N(uint64_t* t, const uint64_t* a)												\
+{																									\
+	double_limb acc = 0;																			\
+	uint64_t c2 = 0;																				\
+	for(int k = 0; k < 2*N-1; k++)																	\
+	{																								\
+		int debut = (k < N) ? 0 : k-N+1;															\
+		double_limb croise = 0;																		\
+		uint64_t c2_croise = 0;																		\
+		_Pragma("GCC unroll 8")																		\
+		for(int i = debut; i < k-i; i++)															\
+		{																							\
+			MAC_COMBA(croise, c2_croise, a[i], a[k-i]);												\
+		}																							\
+		c2_croise = (c2_croise << 1) | (uint64_t) (croise >> 127);									\
+		croise <<= 1;																				\
+		acc += croise;																				\
+		c2 += c2_croise + (acc < croise);															\
+		if(k % 2 == 0)																				\
+		{																							\
+			MAC_COMBA(acc, c2, a[k/2], a[k/2]);														\
+		}																							\
+		t[k] = (uint64_t) acc;																		\
+		DECALER_COMBA(acc, c2);																		\
+	}																								\
+	t[2*N-1] = (uint64_t) acc;																		\
+}																									\
+																									\
+void reduire_montgomery_##N(uint64_t* r, uint64_t* t, const uint64_t* n, uint64_t n0)				\
+{																									\
+	uint64_t m[N];																					\
+	double_limb acc = 0;																			\
+	uint64_t c2 = 0;																				\
+	for(int k = 0; k < N; k++)																		\
+	{																								\
+		_Pragma("GCC unroll 8")																		\
+		for(int i = 0; i < k; i++)																	\
+		{																							\
+			MAC_COMBA(acc, c2, m[i], n[k-i]);														\
+		}																							\
+		acc += t[k];																				\
+		c2 += (acc < t[k]);																			\
+		m[k] = (uint64_t) acc * n0;																	\
+		MAC_COMBA(acc, c2, m[k], n[0]);																\
+		DECALER_COMBA(acc, c2);																		\
+	}																								\
+	for(int k = N; k < 2*N; k++)																	\
+	{																								\
+		_Pragma("GCC unroll 8")																		\
+		for(int i = k-N+1; i < N; i++)																\
+		{																							\
+			MAC_COMBA(acc, c2, m[i], n[k-i]);														\
+		}																							\
+		acc += t[k];																				\
+		c2 += (acc < t[k]);																			\
+		t[k] = (uint64_t) acc;																		\
+		DECALER_COMBA(acc, c2);																		\
+	}																								\
+	finir_montgomery(r, t+N, (uint64_t) acc, n, N);													\
+}																									\
+																									\
+void mul_montgomery_##N(uint64_t* r, const uint64_t* a, const uint64_t* b, const uint64_t* n, uint64_t n0)	\
+{																									\
+	uint64_t t[2*N];																				\
+	produit_comba_##N(t, a, b);																		\
+	reduire_montgomery_##N(r, t, n, n0);															\
+}																									\
+																									\
+void carre_montgomery_##N(uint64_t* r, const uint64_t* a, const uint64_t* n, uint64_t n0)			\
+{																									\
+	uint64_t t[2*N];																				\
+	carre_comba_##N(t, a);																			\
+	reduire_montgomery_##N(r, t, n, n0);															\
+}
+
+DEFINIR_MONTGOMERY(16)
+DEFINIR_MONTGOMERY(24)
+DEFINIR_MONTGOMERY(32)
+DEFINIR_MONTGOMERY(48)
+DEFINIR_MONTGOMERY(64)
+
+
+// Noyau de Montgomery pour une taille de module : r = a*b/R [n] et r = a*a/R [n] avec R = 2^bits_r
+// Les opérandes sont dans la représentation du noyau (taille mots de 64 bits), entrer() et sortir() la convertissent depuis et vers des limbs de 64 bits
+typedef struct noyau_montgomery noyau_montgomery;
+struct noyau_montgomery
 {
-	mpz_t h;										// ##
-	mpz_init(h);									// #
-	char resultat[64];								// #	Initialisation des variables
-	char commande[100] = "openssl sha256 ";			// #
-	strcat(commande,nom_du_fichier_a_hasher);		// ##
+	unsigned int nb_limbs;
+	unsigned int taille;
+	unsigned int bits_r;
+	void (*mul)(uint64_t*, const uint64_t*, const uint64_t*, const uint64_t*, uint64_t);
+	void (*carre)(uint64_t*, const uint64_t*, const uint64_t*, uint64_t);
+	void (*entrer)(uint64_t*, const uint64_t*, const noyau_montgomery*);
+	void (*sortir)(uint64_t*, const uint64_t*, const noyau_montgomery*);
+};
 
-	FILE* hash = popen(commande,"r");				// ##
-	fscanf(hash, "%64s",resultat);					// #	utilisation et récupération de la commande openssl sha256 "nom_fichier"
-	fscanf(hash, "%64s",resultat);					// ##
+#define NB_NOYAUX_MONTGOMERY 5
+#define MAX_MOTS_MONTGOMERY 80			// La plus grande représentation d'un noyau, 80 chiffres de 52 bits pour 4096 bits en AVX-512 IFMA
 
-	
-	mpz_set_str(h,resultat,16);						// ##
-	FILE* fichier_hash = fopen("HASHER","wb+");		// #	stockage du résultat dans le fichier HASHER
-	mpz_out_raw(fichier_hash,h);					// ##
 
-	mpz_clear(h);									// ##
-	pclose(hash);									// #	Fermeture des fichiers et libération de l'espace
-	fclose(fichier_hash);							// ##
+// Cette fonction convertit un nombre entre les limbs de 64 bits et la représentation des noyaux qui travaillent directement sur les limbs
+// Entrée : un tableau destination, un tableau source et le noyau
+// Sortie : vide mais destination contient les nb_limbs limbs de source
+void copier_limbs(uint64_t* destination, const uint64_t* source, const noyau_montgomery* noyau)
+{
+	memcpy(destination, source, noyau->nb_limbs*8);
 };
 
 
-// Cette fonction permet de hasher une chaîne de caractère et la stocke dans un fichier
-// Entrée : une chaîne de caractère à hasher
-// Sortie : vide mais ajoute le hasher de la chaine de caractère à la fin du fichier MGF1
-void sha256sum(char* txt)
+// Jeu de noyaux de Montgomery pour toutes les tailles, un par type de processeur
+typedef struct
 {
-	mpz_t h;										// ##
-	mpz_init(h);									// #
-	char resultat[64];								// #	
-	char commande1[100] = "echo -n ";				// #  Initialisation des variables et construction de la commande à envoyer au terminale
-	char commande2[100] =" | sha256sum";			// #
-	strcat(commande1,txt);							// #
-	strcat(commande1,commande2);					// ##
+	const char* nom;
+	noyau_montgomery noyaux[NB_NOYAUX_MONTGOMERY];
+} backend_montgomery;
 
-	FILE* hash = popen(commande1,"r");				// #  Utilisation et récupération de la commande echo -n "txt" | sha256sum
-	fscanf(hash, "%64s",resultat);					// #
+backend_montgomery backend_portable = {"portable", {
+	{16, 16, 1024, mul_montgomery_16, carre_montgomery_16, copier_limbs, copier_limbs},
+	{24, 24, 1536, mul_montgomery_24, carre_montgomery_24, copier_limbs, copier_limbs},
+	{32, 32, 2048, mul_montgomery_32, carre_montgomery_32, copier_limbs, copier_limbs},
+	{48, 48, 3072, mul_montgomery_48, carre_montgomery_48, copier_limbs, copier_limbs},
+	{64, 64, 4096, mul_montgomery_64, carre_montgomery_64, copier_limbs, copier_limbs}
+}};
 
-	mpz_set_str(h,resultat,16);						// ##
-	FILE* T = fopen("MGF1","a");					// #  Stockage du résultat dans le fichier HASHER
-	gmp_fprintf(T, "%Zx",h );						// ##
+backend_montgomery* backend_actif = &backend_portable;		// Remplacé au démarrage par choisir_backend_montgomery() si le processeur a mieux
 
-	mpz_clear(h);									// ##
-	pclose(hash);									// #  Fermeture des fichiers et libération de l'espace
-	fclose(T);										// ##
-}
 
+// Noyaux x86-64 choisis à l'exécution d'après CPUID : MULX/ADCX/ADOX (Broadwell et suivants) et AVX-512 IFMA en base 2^52 (Ice Lake et suivants)
+// Le même exécutable tourne partout, les instructions absentes du processeur ne sont jamais exécutées
+#if defined(__x86_64__) && defined(__GNUC__)
 
-// Cette fonction convertit un caractère en hexadécimal en un entier en décimal. 
-// Entrée : un caractère c écrit en hexadécimal
-// Sortie : un entier correspondant à la valeur en décimal de c
-int hex_to_int(char c)
+#define MONTGOMERY_X86
+
+// Une étape de la ligne MULX : le produit x*b[j] est ajouté à t[j] avec deux chaînes de retenues indépendantes, CF pour les poids forts et OF pour t
+#define PAS_ADX(j)									\
+	"mulx " #j "*8(%[b]), %%r9, %%r10\n\t"			\
+	"adcx %[c], %%r9\n\t"							\
+	"adox " #j "*8(%[t]), %%r9\n\t"					\
+	"mov %%r9, " #j "*8(%[t])\n\t"					\
+	"mov %%r10, %[c]\n\t"
+
+
+// Cette fonction ajoute x*b à t sur nb limbs avec MULX, ADCX et ADOX, par paquets de 8 limbs
+// Entrée : un tableau t, un tableau b, un limb x et un entier nb
+// Sortie : la retenue sortante, t[0..nb-1] contient t + x*b sur nb limbs
+uint64_t ajouter_produit_adx(uint64_t* t, const uint64_t* b, uint64_t x, int nb)
 {
-	if(c >= '0' && c <= '9')						// ##	
-	{												// #
-		return(c - '0');							// #
-	}												// #  Conversion de c en décimal 
-	if(c >= 'a' && c <= 'f')						// #
-	{												// #
-		return(c - 'a' + 10);						// #
-	}												// ##
-}
+	uint64_t retenue = 0;
+	int j = 0;
+	for(; j+8 <= nb; j += 8)																	// ##
+	{																							// #
+		__asm__ volatile(																		// #
+			"xor %%r8d, %%r8d\n\t"																// #
+			PAS_ADX(0) PAS_ADX(1) PAS_ADX(2) PAS_ADX(3)											// #  Paquets de 8 limbs, les retenues CF et OF
+			PAS_ADX(4) PAS_ADX(5) PAS_ADX(6) PAS_ADX(7)											// #  sont rassemblées dans la retenue à la fin
+			"adcx %%r8, %[c]\n\t"																// #
+			"adox %%r8, %[c]\n\t"																// #
+			: [c] "+r" (retenue)																// #
+			: "d" (x), [b] "r" (b+j), [t] "r" (t+j)												// #
+			: "r8", "r9", "r10", "cc", "memory");												// #
+	}																							// ##
+	for(; j < nb; j++)																			// ##
+	{																							// #
+		double_limb s = (double_limb) x * b[j] + t[j] + retenue;								// #  Limbs restants
+		t[j] = (uint64_t) s;																	// #
+		retenue = (uint64_t) (s >> 64);															// #
+	}																							// ##
+	return retenue;
+};
 
 
-// Cette fonction convertit un entier en décimal en un caractère en hexadécimal. 
-// Entrée : un entier a compris entre 0 et 15
-// Sortie : un caractère correspondant à la valeur en hexadécimal de a
-char int_to_hex(int a)
+// Cette fonction réduit un produit de 2*nb limbs avec les lignes MULX
+// Entrée : un tableau résultat r, un tableau t de 2*nb limbs, un module n, n0 = -1/n [2^64] et un entier nb
+// Sortie : vide mais r = t/R [n]
+void reduire_montgomery_adx(uint64_t* r, uint64_t* t, const uint64_t* n, uint64_t n0, int nb)
 {
-	if(a < 10)										// ##
-	{												// #
-		return(a + '0');							// #
-	}												// #  Conversion de a en hexadécimal
-	else											// #
-	{												// #
-		return(a + 'a' - 10);						// #
-	}												// ##
-}
+	uint64_t retenue = 0;
+	for(int i = 0; i < nb; i++)
+	{
+		uint64_t c = ajouter_produit_adx(t+i, n, t[i]*n0, nb);
+		double_limb s = (double_limb) t[i+nb] + c + retenue;
+		t[i+nb] = (uint64_t) s;
+		retenue = (uint64_t) (s >> 64);
+	}
+	finir_montgomery(r, t+nb, retenue, n, nb);
+};
 
 
-// Cette fonction correspond à la fonction utiliser dans MGF1
-// Entrée : un mpz_t counter qui correspond à une seed et un pointeur sur un caractère pour récupérer le résultat
-// Sortie : vide mais le résultat est stocké dans la chaine resultat
-void I2OSP(mpz_t counter,char *resultat)
+// Cette fonction calcule un carré de nb limbs avec les lignes MULX : produits croisés, doublement puis carrés des limbs
+// Entrée : un tableau t de 2*nb limbs, un tableau a et un entier nb
+// Sortie : vide mais t = a*a
+void carre_adx(uint64_t* t, const uint64_t* a, int nb)
 {
-	mpz_t div;											// ##
-	mpz_t puissance;									// #
-	mpz_t save;											// #
-	mpz_inits(div,puissance,save,NULL);					// #  Initialisation des variables
-	ui_expo_ui(puissance,16,7);							// #
-	mpz_set(save,counter);								// #
-	int i = 0;											// #
-	int j;												// ##
+	memset(t, 0, 2*nb*8);
+	for(int i = 0; i < nb-1; i++)
+	{
+		t[i+nb] = ajouter_produit_adx(t+2*i+1, a+i+1, a[i], nb-1-i);
+	}
 
-	while(mpz_cmp_ui(puissance,0) != 0)					// ##
-	{													// #
-		mpz_fdiv_q(div,save,puissance);					// #
-		j = mpz_get_ui(div);							// #
-		*(resultat+i) = int_to_hex(j);					// #
-														// #
-		if(mpz_cmp_ui(div,0) != 0)						// #
-		{												// #  Algorithme I2OSP
-			mpz_mul(puissance,puissance,div);			// #
-			mpz_sub(save,save,puissance);				// #
-			mpz_divexact(puissance,puissance,div);		// #
-		}												// #
-		mpz_divexact_ui(puissance,puissance,16);		// #
-		i = i+1;										// #
-	}													// ##
+	uint64_t haut = 0;
+	double_limb c = 0;
+	for(int i = 0; i < nb; i++)
+	{
+		double_limb carre = (double_limb) a[i] * a[i];
+		uint64_t bas = (t[2*i] << 1) | haut;
+		haut = t[2*i+1] >> 63;
+		uint64_t milieu = (t[2*i+1] << 1) | (t[2*i] >> 63);
+		c += (double_limb) bas + (uint64_t) carre;
+		t[2*i] = (uint64_t) c;
+		c = (c >> 64) + milieu + (uint64_t) (carre >> 64);
+		t[2*i+1] = (uint64_t) c;
+		c >>= 64;
+	}
+};
 
-	mpz_clears(div,puissance,save,NULL);
-}
 
+// Génère pour N limbs la multiplication et le carré de Montgomery en MULX/ADX
+#define DEFINIR_MONTGOMERY_ADX(N)																	\
+void mul_montgomery_adx_##N(uint64_t* r, const uint64_t* a, const uint64_t* b, const uint64_t* n, uint64_t n0)	\
+{																									\
+	uint64_t t[2*N] = { 0 };																		\
+	for(int i = 0; i < N; i++)																		\
+	{																								\
+		t[i+N] = ajouter_produit_adx(t+i, b, a[i], N);												\
+	}																								\
+	reduire_montgomery_adx(r, t, n, n0, N);															\
+}																									\
+																									\
+void carre_montgomery_adx_##N(uint64_t* r, const uint64_t* a, const uint64_t* n, uint64_t n0)		\
+{																									\
+	uint64_t t[2*N];																				\
+	carre_adx(t, a, N);																				\
+	reduire_montgomery_adx(r, t, n, n0, N);															\
+}
 
-// Cette fonction correspond à la fonction MGF1 utilisée pour OAEP
-// Entrée : un mpz_t correspondant à la taille de la sortie souhaitée
-// Sortie : vide mais la sortie de l'algorithme est stockée dans le fichier "MGF1"
-void MGF1(mpz_t seed, mpz_t l)
+DEFINIR_MONTGOMERY_ADX(16)
+DEFINIR_MONTGOMERY_ADX(24)
+DEFINIR_MONTGOMERY_ADX(32)
+DEFINIR_MONTGOMERY_ADX(48)
+DEFINIR_MONTGOMERY_ADX(64)
+
+backend_montgomery backend_adx = {"mulx_adx", {
+	{16, 16, 1024, mul_montgomery_adx_16, carre_montgomery_adx_16, copier_limbs, copier_limbs},
+	{24, 24, 1536, mul_montgomery_adx_24, carre_montgomery_adx_24, copier_limbs, copier_limbs},
+	{32, 32, 2048, mul_montgomery_adx_32, carre_montgomery_adx_32, copier_limbs, copier_limbs},
+	{48, 48, 3072, mul_montgomery_adx_48, carre_montgomery_adx_48, copier_limbs, copier_limbs},
+	{64, 64, 4096, mul_montgomery_adx_64, carre_montgomery_adx_64, copier_limbs, copier_limbs}
+}};
+
+
+// AVX-512 IFMA : les nombres sont écrits en chiffres de 52 bits, un par mot de 64 bits, huit par registre zmm
+// La multiplication est celle de Montgomery « presque réduite » : entrées et sortie restent inférieures à 2n, ce qui demande 4n < R = 2^(52*taille)
+#define MASQUE_52 0xfffffffffffffULL
+
+// Cette fonction convertit des limbs de 64 bits en chiffres de 52 bits
+// Entrée : un tableau chiffres, un tableau limbs et le noyau
+// Sortie : vide mais chiffres contient les taille chiffres de limbs
+void entrer_base_52(uint64_t* chiffres, const uint64_t* limbs, const noyau_montgomery* noyau)
 {
-	mpz_t a;											// ##
-	mpz_init(a);										// #  Initialisation des variables
-	ui_expo_ui(a,2,37);									// ##
+	for(unsigned int i = 0; i < noyau->taille; i++)
+	{
+		unsigned int bit = 52*i;
+		unsigned int l = bit / 64;
+		uint64_t x = 0;
+		if(l < noyau->nb_limbs)
+		{
+			x = limbs[l] >> (bit % 64);
+			if((bit % 64 > 12) && (l+1 < noyau->nb_limbs))
+			{
+				x |= limbs[l+1] << (64 - bit % 64);
+			}
+		}
+		chiffres[i] = x & MASQUE_52;
+	}
+};
 
-	if(mpz_cmp(l,a) > 0)								// ##
-	{													// #  Vérification de la taille l
-		printf("\nMasque trop long\n");					// #
-	}													// ##
-	else
+
+// Cette fonction convertit des chiffres de 52 bits normalisés en limbs de 64 bits
+// Entrée : un tableau limbs, un tableau chiffres et le noyau
+// Sortie : vide mais limbs contient les nb_limbs premiers limbs du nombre
+void sortir_base_52(uint64_t* limbs, const uint64_t* chiffres, const noyau_montgomery* noyau)
+{
+	memset(limbs, 0, noyau->nb_limbs*8);
+	for(unsigned int i = 0; i < noyau->taille; i++)
 	{
-		mpz_t counter_max;								// ##
-		mpz_t i;										// #
-		mpz_inits(counter_max,i,NULL);					// #
-		mpz_fdiv_q_ui(counter_max,l,32);				// #
-		mpz_add_ui(counter_max,counter_max,1);			// #
-														// #
-		char chaine[24] = { 0 };						// #
-		char * pointeur;								// #
-		mpz_get_str(chaine,16,seed);					// #
-		pointeur = &chaine[16];							// #
-														// #  Algorithme MGF1
-		mpz_set_ui(i,0);								// #
-		while(mpz_cmp_ui(counter_max,0) > 0)			// #
-		{												// #
-			I2OSP(i,pointeur);							// #
-			sha256sum(chaine);							// #
-			mpz_sub_ui(counter_max,counter_max,1);		// #
-			mpz_add_ui(i,i,1);							// #
-		}												// ##
-		mpz_clears(counter_max,NULL);
+		unsigned int bit = 52*i;
+		unsigned int l = bit / 64;
+		if(l < noyau->nb_limbs)
+		{
+			limbs[l] |= chiffres[i] << (bit % 64);
+		}
+		if((bit % 64 > 12) && (l+1 < noyau->nb_limbs))
+		{
+			limbs[l+1] |= chiffres[i] >> (64 - bit % 64);
+		}
 	}
-	mpz_clear(a);
-}
+};
 
 
-// Cette fonction permet d'effectuer le XOR entre 2 valeurs hexadécimales et renvoie le résultat en hexadécimal.
-// Entrée : deux caractères en hexadécimal a et b a xorer entre eux
-// Sortie : un caractère en hexadécimal c = XOR(a,b)
-char XOR(char a,char b)
+// Cette fonction calcule une multiplication de Montgomery presque réduite sur nv registres de huit chiffres de 52 bits
+// Chaque tour ajoute a*b[i] et m*n puis décale l'accumulateur d'un chiffre : les poids faibles des produits avant le décalage, les poids forts après
+// Les chiffres de l'accumulateur ne sont normalisés qu'à la fin, 64 bits suffisent pour 4*8*nv produits de 52 bits
+// Entrée : un tableau résultat r, trois tableaux a, b et n de 8*nv chiffres, n0 = -1/n [2^64] et un entier nv
+// Sortie : vide mais r = a*b/R [n] à n près
+static inline __attribute__((always_inline, target("avx512f,avx512ifma"))) void mul_ifma(uint64_t* r, const uint64_t* a, const uint64_t* b, const uint64_t* n, uint64_t n0, const int nv)
 {
-	char c;													// ##
-	int int_a = 0;											// #
-	int int_b = 0;											// #
-	int int_c = 0;											// #  Déclaration et initialisation des variables
-	int div_a;												// #
-	int div_b;												// #
-	int puissance = 8;										// ##
-
-	int_a = hex_to_int(a);									// #  Conversion de a et b en décimal
-	int_b = hex_to_int(b);									// #
+	__m512i va[10], vn[10], acc[10];
+	const __m512i zero = _mm512_setzero_si512();
+	for(int v = 0; v < nv; v++)
+	{
+		va[v] = _mm512_loadu_si512(a+8*v);
+		vn[v] = _mm512_loadu_si512(n+8*v);
+		acc[v] = zero;
+	}
 
-	while(puissance != 0)									// ##
-	{														// #
-		div_a = int_a / puissance;							// #
-		div_b = int_b / puissance;							// #
-		int_c = int_c + (div_a^div_b) * puissance;			// #
-															// #
-		if(div_a != 0)										// #
-		{													// #
-			puissance = puissance * div_a;					// #
-			int_a = int_a - puissance;						// #
-			puissance = puissance / div_a;					// #  Calcul du XOR entre a et b
-		}													// #
-															// #
-		if(div_b != 0)										// #
-		{													// #
-			puissance = puissance * div_b;					// #
-			int_b = int_b - puissance;						// #
-			puissance = puissance / div_b;					// #
-		}													// #
-															// #
-		puissance = puissance / 2;							// #
-	}														// ##
+	for(int i = 0; i < 8*nv; i++)
+	{
+		__m512i bi = _mm512_set1_epi64(b[i]);												// ##
+		for(int v = 0; v < nv; v++)															// #
+		{																					// #  Poids faibles de a*b[i], puis m tel que le chiffre 0 s'annule
+			acc[v] = _mm512_madd52lo_epu64(acc[v], va[v], bi);								// #
+		}																					// #
+		uint64_t chiffre_0 = _mm_cvtsi128_si64(_mm512_castsi512_si128(acc[0]));				// #
+		uint64_t m = (chiffre_0 * n0) & MASQUE_52;											// ##
 
-	c = int_to_hex(int_c);									// #  Conversion de c en hexadécimal
+		__m512i mi = _mm512_set1_epi64(m);													// ##
+		for(int v = 0; v < nv; v++)															// #
+		{																					// #  Poids faibles de m*n et décalage d'un chiffre
+			acc[v] = _mm512_madd52lo_epu64(acc[v], vn[v], mi);								// #  La retenue du chiffre 0 passe au nouveau chiffre 0
+		}																					// #
+		uint64_t retenue = (chiffre_0 + ((m * n[0]) & MASQUE_52)) >> 52;					// #
+		for(int v = 0; v < nv-1; v++)														// #
+		{																					// #
+			acc[v] = _mm512_alignr_epi64(acc[v+1], acc[v], 1);								// #
+		}																					// #
+		acc[nv-1] = _mm512_alignr_epi64(zero, acc[nv-1], 1);								// #
+		acc[0] = _mm512_mask_add_epi64(acc[0], 1, acc[0], _mm512_set1_epi64(retenue));		// ##
+
+		for(int v = 0; v < nv; v++)															// ##
+		{																					// #  Poids forts des deux produits
+			acc[v] = _mm512_madd52hi_epu64(acc[v], va[v], bi);								// #
+			acc[v] = _mm512_madd52hi_epu64(acc[v], vn[v], mi);								// #
+		}																					// ##
+	}
 
-	return(c);
-}
+	uint64_t brut[8*10];																	// ##
+	for(int v = 0; v < nv; v++)																// #
+	{																						// #
+		_mm512_storeu_si512(brut+8*v, acc[v]);												// #
+	}																						// #  Normalisation des chiffres à 52 bits
+	uint64_t retenue = 0;																	// #
+	for(int i = 0; i < 8*nv; i++)															// #
+	{																						// #
+		uint64_t x = brut[i] + retenue;														// #
+		r[i] = x & MASQUE_52;																// #
+		retenue = x >> 52;																	// #
+	}																						// ##
+};
 
 
-// Cette fonction applique la padding OAEP à un sous-message et l'écrit dans un fichier
-// Entrée : un entier length_n correspondant à la taille du sous-message sans le padding, un entier dernier nous indiquant si nous sommes au dernier bloc et un flux correspondant au fichier à chiffrer
-// Sortie : vide mais un sous-message est ajouté à la suite du fichier OAEP
-void OAEP(int length_n,int dernier, FILE* fichier)
-{
-	srand(time(NULL));													// #  Initialisation du random pour générer l'aléa
+// Génère la multiplication et le carré IFMA sur NV registres, le carré est une multiplication de a par lui-même
+#define DEFINIR_MONTGOMERY_IFMA(NV)																	\
+__attribute__((target("avx512f,avx512ifma"))) void mul_montgomery_ifma_##NV(uint64_t* r, const uint64_t* a, const uint64_t* b, const uint64_t* n, uint64_t n0)	\
+{																									\
+	mul_ifma(r, a, b, n, n0, NV);																	\
+}																									\
+																									\
+__attribute__((target("avx512f,avx512ifma"))) void carre_montgomery_ifma_##NV(uint64_t* r, const uint64_t* a, const uint64_t* n, uint64_t n0)	\
+{																									\
+	mul_ifma(r, a, a, n, n0, NV);																	\
+}
 
-	mpz_t l;															// ##
-	mpz_t n;															// #
-	mpz_t m;															// #
-	mpz_t puissance;													// #
-	mpz_t div;															// #
-	mpz_init_set_ui(l,length_n);										// #
-	mpz_init_set_ui(n,0);												// #
-	mpz_init_set_ui(m,0);												// #
-	mpz_init_set_ui(puissance,0);										// #  Déclaration des variables
-	mpz_init_set_ui(div,0);												// #
-	char c1;															// #
-	char c2;															// #
-	char c3;															// #
-	char chaine[16] = { 0 };											// #
-	int A;																// #
-	int h1;																// #
-	int h2;																// ##
+DEFINIR_MONTGOMERY_IFMA(3)
+DEFINIR_MONTGOMERY_IFMA(4)
+DEFINIR_MONTGOMERY_IFMA(5)
+DEFINIR_MONTGOMERY_IFMA(8)
+DEFINIR_MONTGOMERY_IFMA(10)
 
-	if (dernier==0)														// ##
-	{																	// #
-		for (int i = 0; i <8 ;i++)										// #
-	    {																// #
-	    	mpz_mul_ui(m,m,256);										// #  Test si nous sommes au dernier bloc à chiffrer :
-	    	A = (int)(rand() / (double)RAND_MAX * (255 - 17))+16;		// #
-	    	mpz_add_ui(m,m,A);											// #  	- si non on génère 8 octets aléatoirement dans m
-	    }																// #
-	}																	// #	- si oui on affecte la taille du dernier bloc dans m
-	else																// #
-	{																	// #
-		mpz_set_ui(m,dernier);											// #
-	}																	// ##
+backend_montgomery backend_ifma = {"avx512_ifma", {
+	{16, 24, 52*24, mul_montgomery_ifma_3, carre_montgomery_ifma_3, entrer_base_52, sortir_base_52},
+	{24, 32, 52*32, mul_montgomery_ifma_4, carre_montgomery_ifma_4, entrer_base_52, sortir_base_52},
+	{32, 40, 52*40, mul_montgomery_ifma_5, carre_montgomery_ifma_5, entrer_base_52, sortir_base_52},
+	{48, 64, 52*64, mul_montgomery_ifma_8, carre_montgomery_ifma_8, entrer_base_52, sortir_base_52},
+	{64, 80, 52*80, mul_montgomery_ifma_10, carre_montgomery_ifma_10, entrer_base_52, sortir_base_52}
+}};
 
-	MGF1(m,l);															// #  Passage de m dans MGF1 avec l pour taille de sortie
+#endif
 
-	FILE* MGF = fopen("MGF1","r");										// #  Ouverture des fichiers OAEP et MGF1
-	FILE* OAE = fopen("OAEP","a");										// #
 
-	for(int a=0;a<length_n;a++)											// #  Boucle pour créer X (sachant que le bloc créé à la fin est de la forme X||Y)
+// Cette fonction choisit au démarrage les noyaux de Montgomery les plus rapides que le processeur sait exécuter
+// AVX-512 demande aussi que le système sauvegarde les registres zmm (XCR0), MULX et ADX sont dans BMI2 et ADX
+// Entrée : vide
+// Sortie : vide mais backend_actif pointe sur les noyaux choisis
+void choisir_backend_montgomery()
+{
+#ifdef MONTGOMERY_X86
+	unsigned int eax, ebx, ecx, edx;
+	unsigned int ebx7 = 0;
+	int zmm = 0;
+	if(__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_OSXSAVE))						// ##
+	{																						// #
+		unsigned int xcr0, xcr0_haut;														// #  Etat AVX-512 (opmask, zmm hauts et bas) sauvegardé par le système
+		__asm__("xgetbv" : "=a" (xcr0), "=d" (xcr0_haut) : "c" (0));						// #
+		zmm = ((xcr0 & 0xe6) == 0xe6);														// #
+	}																						// ##
+	if(__get_cpuid_count(7, 0, &eax, &ebx7, &ecx, &edx) == 0)
 	{
-		if(!feof(fichier))												// ##
-		{																// #
-			A = fgetc(fichier);											// #
-		}																// #
-		else															// #  Lecture d'un octet A du fichier à chiffrer et initialisation de h1 et h2 tel que A = h1*16 + h2
-		{																// #
-			A = 0;														// #
-		}																// #
-		h1 = A/16;														// #
-		h2 = A - (h1*16);												// ##
-
-		c1 = fgetc(MGF);												// #  Lecture d'une valeur hexa du fichier MGF1
-
-		c2 = int_to_hex(h1);											// #  XOR entre le message et MGF1 qui donne les octets de X
-		c3 = XOR(c1,c2);												// #
-
-		if(a<8)															// ##
-		{																// #
-			mpz_mul_ui(n,n,16);											// #  Stockage des 8 premiers octets de X (1)
-			A = hex_to_int(c3);											// #
-    		mpz_add_ui(n,n,A);											// #
-		}																// ##
+		return;
+	}
 
-		fprintf(OAE,"%c",c3);											// #  Ecriture dans le fichier OAEP
+	if(zmm && (ebx7 & bit_AVX512F) && (ebx7 & bit_AVX512IFMA))								// ##
+	{																						// #
+		backend_actif = &backend_ifma;														// #
+	}																						// #  Le meilleur disponible : IFMA, puis MULX/ADX, puis portable
+	else if((ebx7 & bit_BMI2) && (ebx7 & bit_ADX))											// #
+	{																						// #
+		backend_actif = &backend_adx;														// #
+	}																						// ##
+#endif
+};
 
-		c1 = fgetc(MGF);												// #  Lecture d'une valeur hexa du fichier MGF1
-		
-		c2 = int_to_hex(h2);											// #  XOR entre le message et MGF1 qui donne les octets de X
-		c3 = XOR(c1,c2);												// #
 
-		if (a<8)														// ##
-		{																// #
-			mpz_mul_ui(n,n,16);											// #  Stockage des 8 premiers octets de X (2)
-    		A = hex_to_int(c3);											// #
-    		mpz_add_ui(n,n,A);											// #
-		}																// ##
+// Constantes de Montgomery d'un module pour un noyau : ses limbs, le module et R^2 [n] dans la représentation du noyau et n0 = -1/n [2^64]
+typedef struct
+{
+	noyau_montgomery* noyau;
+	uint64_t n[MAX_LIMBS_FIXES];
+	uint64_t n_noyau[MAX_MOTS_MONTGOMERY];
+	uint64_t r2[MAX_MOTS_MONTGOMERY];
+	uint64_t n0;
+} contexte_montgomery;
 
-		fprintf(OAE,"%c",c3);											// #  Ecriture dans le fichier OAEP
-	}
+_Thread_local contexte_montgomery cache_montgomery[TAILLE_CACHE_MONTGOMERY];			// Les modules récents de chaque thread, le CRT alterne entre p et q
+_Thread_local unsigned int prochain_cache_montgomery = 0;
 
-	fclose(MGF);														// #  Fermeture et suppression du fichier MGF1
-	remove("MGF1");														// #
 
-	mpz_set_ui(l,8);													// ##
-	MGF1(n,l);															// #  Passage de X dans MGF1 avec 8 pour taille de sortie et ouverture de MGF1
-	MGF = fopen("MGF1","r");											// ##
+// Cette fonction donne les constantes de Montgomery d'un module, calculées une fois puis gardées dans le cache du thread
+// Entrée : un mpz n impair
+// Sortie : les constantes du module, NULL si aucun noyau fixe ne correspond à sa taille
+contexte_montgomery* preparer_montgomery(mpz_t n)
+{
+	size_t nb = mpz_size(n);
+	const mp_limb_t* limbs = mpz_limbs_read(n);
 
-	if(dernier == 0)													// ##
-	{																	// #
-		mpz_get_str(chaine,16,m);										// #
-	}																	// #
-	else																// #
-	{																	// #
-		for (int j=15;j>=0;j--)											// #
-		{																// #
-			ui_expo_ui(puissance,16,j);									// #  Initialisation de chaine qui va contenir le padding
-			mpz_fdiv_q(div,m,puissance);								// #
-																		// #
-			A = mpz_get_ui(div);										// #
-			chaine[15-j] = int_to_hex(A);								// #
-																		// #
-			mpz_mul(puissance,puissance,div);							// #
-			mpz_sub(m,m,puissance);										// #
-		}																// #
-	}																	// ##
+	noyau_montgomery* noyau = NULL;															// ##
+	for(int i = 0; i < NB_NOYAUX_MONTGOMERY; i++)											// #
+	{																						// #
+		if(backend_actif->noyaux[i].nb_limbs == nb)											// #  Choix du noyau d'après la taille
+		{																					// #
+			noyau = &backend_actif->noyaux[i];												// #
+		}																					// #
+	}																						// #
+	if(noyau == NULL)																		// #
+	{																						// #
+		return NULL;																		// #
+	}																						// ##
 
- 	for(int b=0;b<16;b++)												// ##
-	{																	// #
-		c1 = chaine[b];													// #
-		c2 = fgetc(MGF);												// #  Calcul et écriture de Y = XOR(MGF1(X),padding) dans le fichier OAEP à la suite de X
-		c3 = XOR(c1,c2);												// #
-		fprintf(OAE,"%c",c3);											// #
-	}																	// ##
+	for(int i = 0; i < TAILLE_CACHE_MONTGOMERY; i++)										// ##
+	{																						// #
+		contexte_montgomery* contexte = &cache_montgomery[i];								// #
+		if((contexte->noyau == noyau) && (memcmp(contexte->n, limbs, nb*8) == 0))			// #  Module déjà dans le cache
+		{																					// #
+			return contexte;																// #
+		}																					// #
+	}																						// ##
 
-	fclose(MGF);														// #  Fermeture et suppression du fichier MGF1
-	remove("MGF1");														// #
-	
-	fclose(OAE);														// #  Fermeture du fichier OAEP qui contient le bloc X||Y à chiffrer
-	
-	mpz_clears(l,n,m,puissance,div,NULL);
-}
+	contexte_montgomery* contexte = &cache_montgomery[prochain_cache_montgomery];			// ##
+	prochain_cache_montgomery = (prochain_cache_montgomery + 1) % TAILLE_CACHE_MONTGOMERY;	// #
+	contexte->noyau = noyau;																// #
+	memcpy(contexte->n, limbs, nb*8);														// #
+	noyau->entrer(contexte->n_noyau, contexte->n, noyau);									// #
+	uint64_t inverse = limbs[0];															// #
+	for(int i = 0; i < 5; i++)																// #
+	{																						// #
+		inverse *= 2 - limbs[0] * inverse;													// #
+	}																						// #  Calcul de n0 par Newton et de R^2 [n] par GMP
+	contexte->n0 = -inverse;																// #
+	mpz_t r2;																				// #
+	mpz_init(r2);																			// #
+	mpz_setbit(r2, 2*noyau->bits_r);														// #
+	mpz_mod(r2, r2, n);																		// #
+	uint64_t r2_limbs[MAX_LIMBS_FIXES] = { 0 };												// #
+	memcpy(r2_limbs, mpz_limbs_read(r2), mpz_size(r2)*8);									// #
+	noyau->entrer(contexte->r2, r2_limbs, noyau);											// #
+	mpz_clear(r2);																			// ##
+	return contexte;
+};
 
 
-// Cette fonction supprime le padding d'un bloc et écrit le résultat à la suite du fichier clair
-// Entrée : un entier length_n correspondant à la taille d'un bloc, un entier dernier nous indiquant si nous sommes au dernier bloc, un mpz correspondant à un bloc et un flux correspondant au fichier destination
-// Sortie : vide mais le sous-message est écrit à la fin du fichier clair
-void inv_OAEP(int length_n, int dernier, mpz_t chiffre,FILE* clair)
+// Cette fonction calcule une exponentiation modulaire avec les noyaux de Montgomery fixes, par fenêtres fixes de gauche à droite
+// Elle n'est pas en temps constant et ne sert qu'à exp_mod()
+// Entrée : quatre mpz resultat, m, d et n
+// Sortie : 1 si resultat = m^d [n] a été calculé, 0 si n n'a pas de noyau fixe
+int exp_mod_montgomery(mpz_t resultat, mpz_t m, mpz_t d, mpz_t n)
 {
-	mpz_t puissance;									// ##
-	mpz_t z_X;											// #
-	mpz_t div;											// #
-	mpz_t temp;											// #
-	mpz_t r;											// #
-	mpz_t l;											// #
-	mpz_inits(puissance,z_X,div,temp,r,l,NULL);			// #
-	mpz_set_ui(r,0);									// #
-	mpz_set_ui(div,0);									// #
-	mpz_set_ui(temp,0);									// #
-	mpz_set_ui(l,8);									// #  Déclaration des variables
-	char MGF1_X;										// #
-	char Y;												// #
-	char c1;											// #
-	char c2;											// #
-	char c3;											// #
-	unsigned int lettre = 0;							// #
-	int A;												// #
-	int B;												// #
-	int int_r;											// #
-	int rtemp;											// ##
-	
-	ui_expo_ui(puissance,256,(length_n-8));				// #  Récupération des 8 premiers octets de X
-	mpz_fdiv_q(z_X,chiffre,puissance);					// #
-	
-	MGF1(z_X,l);										// #  Passage des 8 premiers octets de X dans MGF1 avec 8 pour taille de sortie et ouverture de MGF1
-	FILE* MGF = fopen("MGF1","r");						// #
-
-	ui_expo_ui(puissance,256,8);						// ##
-	mpz_fdiv_q(div,chiffre,puissance);					// #  Récupération de X 
-	mpz_set(z_X,div);									// ##
-
-	mpz_mul(puissance,puissance,div);					// #  Récupération de Y
-	mpz_sub(temp,chiffre,puissance);					// #
-
-	for(int i=15;i>=0;i--)								// #  Boucle pour calculer XOR(MGF1(X),Y)
+	if(mpz_even_p(n) || (mpz_sgn(d) < 0))
 	{
-		MGF1_X = fgetc(MGF);							// #  Lecture d'une valeur hexadécimale de MGF1(X)
+		return 0;
+	}
+	contexte_montgomery* contexte = preparer_montgomery(n);
+	if(contexte == NULL)
+	{
+		return 0;
+	}
+	noyau_montgomery* noyau = contexte->noyau;
+	int nb = noyau->nb_limbs;
+	const uint64_t* module = contexte->n_noyau;
+
+	uint64_t limbs[MAX_LIMBS_FIXES] = { 0 };												// ##
+	uint64_t base[MAX_MOTS_MONTGOMERY];														// #
+	uint64_t un[MAX_MOTS_MONTGOMERY];														// #
+	uint64_t accumulateur[MAX_MOTS_MONTGOMERY];												// #
+	uint64_t table[1 << MAX_FENETRE][MAX_MOTS_MONTGOMERY];									// #
+	mpz_t reduit;																			// #
+	mpz_init(reduit);																		// #
+	mpz_mod(reduit, m, n);																	// #  Passage de m réduit modulo n en représentation de Montgomery
+	memcpy(limbs, mpz_limbs_read(reduit), mpz_size(reduit)*8);								// #
+	mpz_clear(reduit);																		// #
+	noyau->entrer(base, limbs, noyau);														// #
+	memset(limbs, 0, nb*8);																	// #
+	limbs[0] = 1;																			// #
+	noyau->entrer(un, limbs, noyau);														// #
+	noyau->mul(table[1], base, contexte->r2, module, contexte->n0);						// #
+	noyau->mul(table[0], un, contexte->r2, module, contexte->n0);							// ##
+
+	int nb_bits = mpz_sizeinbase(d, 2);														// ##
+	int fenetre = fenetre_exponentiation(mpz_sizeinbase(n, 2), nb_bits);					// #
+	for(int i = 2; i < (1 << fenetre); i++)													// #  Table des puissances de la base pour la fenêtre choisie
+	{																						// #
+		noyau->mul(table[i], table[i-1], table[1], module, contexte->n0);					// #
+	}																						// ##
 
-		ui_expo_ui(puissance,16,i);						// ##
-		mpz_fdiv_q(div,temp,puissance);					// #  Récupération d'une valeur hexadécimale de Y
-		int_r = mpz_get_ui(div);						// #
-		Y = int_to_hex(int_r);							// ##
-		
-		c1 = XOR(MGF1_X,Y);								// #  XOR entre MGF1(X) et Y
+	memcpy(accumulateur, table[0], noyau->taille*8);
+	for(int position = ((nb_bits + fenetre - 1) / fenetre) * fenetre; position > 0; )
+	{
+		position -= fenetre;																// ##
+		unsigned int valeur = 0;															// #
+		for(int b = fenetre-1; b >= 0; b--)													// #
+		{																					// #
+			noyau->carre(accumulateur, accumulateur, module, contexte->n0);					// #
+			valeur = (valeur << 1) | mpz_tstbit(d, position + b);							// #  Une fenêtre : carrés puis multiplication par la puissance correspondante
+		}																					// #
+		if(valeur != 0)																		// #
+		{																					// #
+			noyau->mul(accumulateur, accumulateur, table[valeur], module, contexte->n0);	// #
+		}																					// #
+	}																						// ##
 
-		A = hex_to_int(c1);								// ##
-		mpz_mul_ui(r,r,16);								// #  stockage du résultat dans r
-		mpz_add_ui(r,r,A);								// ##
+	noyau->mul(accumulateur, accumulateur, un, module, contexte->n0);						// ##
+	noyau->sortir(limbs, accumulateur, noyau);												// #
+	finir_montgomery(limbs, limbs, 0, contexte->n, nb);										// #  Retour en représentation normale, réduite une dernière fois pour les noyaux presque réduits
+	mp_limb_t* sortie = mpz_limbs_write(resultat, nb);										// #
+	memcpy(sortie, limbs, nb*8);															// #
+	mpz_limbs_finish(resultat, nb);															// ##
+	return 1;
+};
 
-		mpz_mul(puissance,puissance,div);				// #  Décrémentation de Y
-		mpz_sub(temp,temp,puissance);					// #
-	}
+#define NOM_BACKEND_MONTGOMERY (backend_actif->nom)
 
-	fclose(MGF);										// #  Fermeture et suppression du fichier MGF1
-	remove("MGF1");										// #
+#else
 
-	mpz_set_ui(l,(length_n - 8));						// ##
-	MGF1(r,l);											// #  Passage du padding (r) dans MGF1 avec la taille d'un bloc moins la taille du padding pour taille de sortie et ouverture de MGF1
-	MGF = fopen("MGF1","r");							// ##
+#define NOM_BACKEND_MONTGOMERY "gmp"
 
-	if(dernier != 0)									// ##
-	{													// #  Si on est au dernier bloc on récupère la taille du dernier sous-message
-		rtemp = mpz_get_ui(r);							// #
-	}													// ##
+#endif
 
-	ui_expo_ui(puissance,16,((2*(length_n-8))-1));		// #  Initialisation de puissance
 
-	for(int j=0;j<(length_n - 8);j++)					// #  Boucle pour le dernier XOR entre X et MGF1(r)
+// Cette fonction calcule une exponentiation modulaire et l'affecte à un mpz
+// Entrée : quatre mpz resultat,m,d et n
+// Sortie : void mais resultat = m^d [n]
+void exp_mod(mpz_t resultat, mpz_t m, mpz_t d, mpz_t n) 
+{
+	mpz_t a;								// ##
+	mpz_t b;								// #
+	mpz_inits(a,b,NULL);					// #
+											// #  Initialisation des variables
+	mpz_set(a,m);							// #
+	mpz_set(b,d);							// #
+	mpz_set_ui(resultat,1);					// ##
+	STATS_AJOUTER(STAT_EXPONENTIATIONS,1);	// Comptage des exponentiations
+
+#ifdef MONTGOMERY_FIXE
+	if(exp_mod_montgomery(resultat,a,b,n) == 1)	// ##
+	{										// #  Noyau de Montgomery fixe si la taille de n en a un
+		mpz_clears(a,b,NULL);				// #
+		return;								// #
+	}										// ##
+#endif
+
+	while(mpz_cmp_ui(b,0) != 0)				// ##
+	{										// #
+		if(modulo_ui(b,2) == 1)				// #
+		{									// #
+			mpz_mul(resultat,resultat,a);	// #
+			modulo(resultat,resultat,n);	// #  Calcul de a^b par l'exponentiation rapide avec calcule de restes modulo n
+			mpz_sub_ui(b,b,1);				// #
+		}									// #
+		mpz_mul(a,a,a);						// #
+		modulo(a,a,n);						// #
+		mpz_divexact_ui(b,b,2);				// #
+	}										// ##
+
+	mpz_clears(a,b,NULL);
+};
+
+
+// Cette fonction est la même que la précédente mais l'exposant est un entier
+// Entrée : trois mpz resultat, m et n et un entier d
+// Sortie : vide mais resultat = m^d [n]
+void exp_mod_ui(mpz_t resultat, mpz_t m, unsigned int d, mpz_t n)
+{
+	mpz_t z_d;
+	mpz_init_set_ui(z_d,d);		// Convertion de d d'entier à mpz
+
+	exp_mod(resultat,m,z_d,n);	// Calcul du résultat via la fonction précédente exp_mod()
+
+	mpz_clear(z_d);
+};
+
+
+// Cette fonction calcule une exponentiation modulaire en temps constant pour les opérations privées
+// La fenêtre fixe et les lectures de table uniformes sont celles de mpn_sec_powm(), l'exposant est complété à la taille du module
+// Entrée : quatre mpz resultat, m, d et n avec n impair
+// Sortie : vide mais resultat = m^d [n]
+void exp_mod_sec(mpz_t resultat, mpz_t m, mpz_t d, mpz_t n)
+{
+	STATS_AJOUTER(STAT_EXPONENTIATIONS,1);												// Comptage des exponentiations
+	mp_size_t nn = mpz_size(n);															// ##
+	mp_bitcnt_t enb = mpz_sizeinbase(n,2);												// #
+	if(mpz_sizeinbase(d,2) > enb)														// #
+	{																					// #
+		enb = mpz_sizeinbase(d,2);														// #  Tailles fixes : nn limbs pour la base et le module, enb bits pour l'exposant
+	}																					// #
+	mp_size_t en = (enb + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;							// #
+	mp_size_t bn = (mpz_size(m) > (size_t) nn) ? (mp_size_t) mpz_size(m) : nn;			// #
+	mp_size_t tn = mpn_sec_powm_itch(nn, enb, nn);										// #
+	if(mpn_sec_div_r_itch(bn, nn) > tn) tn = mpn_sec_div_r_itch(bn, nn);				// ##
+
+	mp_limb_t* bp = calloc(bn, sizeof(mp_limb_t));										// ##
+	mp_limb_t* ep = calloc(en, sizeof(mp_limb_t));										// #  Allocation de la base, de l'exposant, du résultat et de l'espace de travail
+	mp_limb_t* rp = calloc(nn, sizeof(mp_limb_t));										// #
+	mp_limb_t* tp = calloc(tn, sizeof(mp_limb_t));										// ##
+
+	mpz_export(bp, NULL, -1, sizeof(mp_limb_t), 0, 0, m);								// ##
+	mpn_sec_div_r(bp, bn, mpz_limbs_read(n), nn, tp);									// #  Recopie de m [n] et de d sur des tailles fixes
+	mpz_export(ep, NULL, -1, sizeof(mp_limb_t), 0, 0, d);								// ##
+
+	mpn_sec_powm(rp, bp, nn, ep, enb, mpz_limbs_read(n), nn, tp);						// #  Exponentiation à fenêtre fixe
+
+	mp_limb_t* r = mpz_limbs_write(resultat, nn);										// ##
+	memcpy(r, rp, nn * sizeof(mp_limb_t));												// #  Conversion du résultat en mpz
+	mpz_limbs_finish(resultat, nn);														// ##
+
+	memset(tp, 0, tn * sizeof(mp_limb_t));												// ##
+	memset(ep, 0, en * sizeof(mp_limb_t));												// #
+	memset(rp, 0, nn * sizeof(mp_limb_t));												// #  Effacement des données sensibles et libération de l'espace
+	free(bp);																			// #
+	free(ep);																			// #
+	free(rp);																			// #
+	free(tp);																			// ##
+};
+
+
+// Cette fonction recombine les deux moitiés CRT en temps constant
+// Entrée : six mpz resultat, mp, mq, p, q et Ip avec mp = c^dp [p], mq = c^dq [q] et Ip = p^(-1) [q]
+// Sortie : vide mais resultat = mp + p*((mq - mp)*Ip [q])
+void crt_sec(mpz_t resultat, mpz_t mp, mpz_t mq, mpz_t p, mpz_t q, mpz_t Ip)
+{
+	mp_size_t pn = mpz_size(p);															// ##
+	mp_size_t qn = mpz_size(q);															// #
+	mp_size_t l = (pn > qn) ? pn : qn;													// #  Tailles fixes des opérandes
+	mp_size_t rn = pn + qn;																// ##
+
+	mp_size_t tn = mpn_sec_div_r_itch(l, qn);											// ##
+	if(mpn_sec_div_r_itch(l+1+qn, qn) > tn) tn = mpn_sec_div_r_itch(l+1+qn, qn);		// #
+	if(mpn_sec_mul_itch(l+1, qn) > tn) tn = mpn_sec_mul_itch(l+1, qn);					// #  Taille de l'espace de travail
+	if(mpn_sec_mul_itch(pn, qn) > tn) tn = mpn_sec_mul_itch(pn, qn);					// #
+	if(mpn_sec_mul_itch(qn, pn) > tn) tn = mpn_sec_mul_itch(qn, pn);					// ##
+
+	mp_limb_t* a = calloc(l+1, sizeof(mp_limb_t));										// ##
+	mp_limb_t* b = calloc(l, sizeof(mp_limb_t));										// #
+	mp_limb_t* c = calloc(l, sizeof(mp_limb_t));										// #
+	mp_limb_t* ip = calloc(qn, sizeof(mp_limb_t));										// #  Allocation des opérandes complétés à taille fixe
+	mp_limb_t* h = calloc(l+1+qn, sizeof(mp_limb_t));									// #
+	mp_limb_t* s = calloc(rn, sizeof(mp_limb_t));										// #
+	mp_limb_t* x = calloc(rn, sizeof(mp_limb_t));										// #
+	mp_limb_t* tp = calloc(tn, sizeof(mp_limb_t));										// ##
+
+	mpz_export(c, NULL, -1, sizeof(mp_limb_t), 0, 0, mp);								// ##
+	mpn_sec_div_r(c, l, mpz_limbs_read(q), qn, tp);										// #  c = mp [q]
+	memset(c+qn, 0, (l-qn) * sizeof(mp_limb_t));										// ##
+
+	mpz_export(a, NULL, -1, sizeof(mp_limb_t), 0, 0, mq);								// ##
+	mpz_export(b, NULL, -1, sizeof(mp_limb_t), 0, 0, q);								// #  a = mq + q - c, toujours positif
+	a[l] = mpn_add_n(a, a, b, l);														// #
+	a[l] -= mpn_sub_n(a, a, c, l);														// ##
+
+	mpz_export(ip, NULL, -1, sizeof(mp_limb_t), 0, 0, Ip);								// ##
+	mpn_sec_mul(h, a, l+1, ip, qn, tp);													// #  h = a*Ip [q]
+	mpn_sec_div_r(h, l+1+qn, mpz_limbs_read(q), qn, tp);								// ##
+
+	if(pn >= qn)																		// ##
+	{																					// #
+		mpn_sec_mul(s, mpz_limbs_read(p), pn, h, qn, tp);								// #
+	}																					// #  s = p*h + mp
+	else																				// #
+	{																					// #
+		mpn_sec_mul(s, h, qn, mpz_limbs_read(p), pn, tp);								// #
+	}																					// #
+	mpz_export(x, NULL, -1, sizeof(mp_limb_t), 0, 0, mp);								// #
+	mpn_add_n(s, s, x, rn);																// ##
+
+	mp_limb_t* r = mpz_limbs_write(resultat, rn);										// ##
+	memcpy(r, s, rn * sizeof(mp_limb_t));												// #  Conversion du résultat en mpz
+	mpz_limbs_finish(resultat, rn);														// ##
+
+	memset(a, 0, (l+1) * sizeof(mp_limb_t));											// ##
+	memset(c, 0, l * sizeof(mp_limb_t));												// #
+	memset(h, 0, (l+1+qn) * sizeof(mp_limb_t));											// #
+	memset(s, 0, rn * sizeof(mp_limb_t));												// #
+	memset(x, 0, rn * sizeof(mp_limb_t));												// #
+	memset(tp, 0, tn * sizeof(mp_limb_t));												// #
+	free(a);																			// #  Effacement des données sensibles et libération de l'espace
+	free(b);																			// #
+	free(c);																			// #
+	free(ip);																			// #
+	free(h);																			// #
+	free(s);																			// #
+	free(x);																			// #
+	free(tp);																			// ##
+};
+
+
+// Table de précalcul pour les exponentiations répétées d'une même base (méthode BGMW)
+// puissances[i] contient base^(2^(fenetre*i)) [module]
+typedef struct
+{
+	mpz_t* puissances;
+	unsigned int nb_puissances;
+	unsigned int fenetre;
+	mpz_t module;
+} table_base_fixe;
+
+
+// Cette fonction construit la table de précalcul d'une base fixe
+// Entrée : une table, deux mpz base et n, la taille maximale en bit des exposants et la largeur de fenêtre (0 pour un choix automatique)
+// Sortie : vide mais la table contient les puissances base^(2^(fenetre*i)) [n] couvrant des exposants de taille_exposant bits
+void init_table_base_fixe(table_base_fixe* table, mpz_t base, mpz_t n, unsigned int taille_exposant, unsigned int fenetre)
+{
+	if(fenetre == 0)																	// ##
+	{																					// #
+		fenetre = 1;																	// #  Choix de la fenêtre minimisant le nombre de multiplications
+		while((fenetre < 16) && ((taille_exposant + fenetre) / (fenetre + 1) + (1u << (fenetre + 1)) < (taille_exposant + fenetre - 1) / fenetre + (1u << fenetre)))
+		{																				// #  ceil(t/w) + 2^w
+			fenetre++;																	// #
+		}																				// #
+	}																					// ##
+
+	table->fenetre = fenetre;															// ##
+	table->nb_puissances = (taille_exposant + fenetre - 1) / fenetre;					// #
+	if(table->nb_puissances == 0)														// #  Initialisation de la table
+	{																					// #
+		table->nb_puissances = 1;														// #
+	}																					// #
+	table->puissances = malloc(table->nb_puissances * sizeof(mpz_t));					// #
+	mpz_init_set(table->module, n);														// ##
+
+	mpz_init(table->puissances[0]);														// ##
+	modulo(table->puissances[0], base, n);												// #
+	for(unsigned int i = 1; i < table->nb_puissances; i++)								// #
+	{																					// #
+		mpz_init_set(table->puissances[i], table->puissances[i-1]);						// #  Calcul des puissances successives par fenetre élévations au carré
+		for(unsigned int j = 0; j < fenetre; j++)										// #
+		{																				// #
+			mpz_mul(table->puissances[i], table->puissances[i], table->puissances[i]);	// #
+			modulo(table->puissances[i], table->puissances[i], n);						// #
+		}																				// #
+	}																					// ##
+};
+
+
+// Cette fonction calcule une exponentiation modulaire d'une base fixe à partir de sa table de précalcul
+// Entrée : un mpz resultat, une table construite par init_table_base_fixe() et un mpz d
+// Sortie : vide mais resultat = base^d [n]
+void exp_mod_base_fixe(mpz_t resultat, table_base_fixe* table, mpz_t d)
+{
+	unsigned int w = table->fenetre;
+	unsigned int nb = table->nb_puissances;
+
+	if(mpz_sizeinbase(d,2) > (size_t) nb * w)											// ##
+	{																					// #  Exposant plus grand que la table : exponentiation classique
+		exp_mod(resultat, table->puissances[0], d, table->module);						// #
+		return;																			// #
+	}																					// ##
+
+	unsigned int* chiffres = malloc(nb * sizeof(unsigned int));							// ##
+	for(unsigned int i = 0; i < nb; i++)												// #
+	{																					// #
+		chiffres[i] = 0;																// #  Découpage de d en chiffres de w bits
+		for(unsigned int j = 0; j < w; j++)												// #
+		{																				// #
+			chiffres[i] |= mpz_tstbit(d, i*w + j) << j;									// #
+		}																				// #
+	}																					// ##
+
+	mpz_t a, b;																			// ##
+	mpz_init_set_ui(a,1);																// #  Initialisation des accumulateurs
+	mpz_init_set_ui(b,1);																// #
+	int b_vaut_un = 1;																	// ##
+
+	for(unsigned int valeur = (1u << w) - 1; valeur > 0; valeur--)						// ##
+	{																					// #
+		for(unsigned int i = 0; i < nb; i++)											// #
+		{																				// #
+			if(chiffres[i] == valeur)													// #
+			{																			// #
+				mpz_mul(b, b, table->puissances[i]);									// #  b = produit des puissances dont le chiffre est >= valeur
+				modulo(b, b, table->module);											// #  a = produit des b successifs, soit base^d
+				b_vaut_un = 0;															// #
+			}																			// #
+		}																				// #
+		if(b_vaut_un == 0)																// #
+		{																				// #
+			mpz_mul(a, a, b);															// #
+			modulo(a, a, table->module);												// #
+		}																				// #
+	}																					// ##
+
+	mpz_set(resultat, a);
+	mpz_clears(a, b, NULL);
+	free(chiffres);
+};
+
+
+// Cette fonction libère la mémoire occupée par une table de précalcul
+// Entrée : une table construite par init_table_base_fixe()
+// Sortie : vide
+void clear_table_base_fixe(table_base_fixe* table)
+{
+	for(unsigned int i = 0; i < table->nb_puissances; i++)
+	{
+		mpz_clear(table->puissances[i]);
+	}
+	free(table->puissances);
+	mpz_clear(table->module);
+};
+
+
+// Cette fonction calcule PGCD(a,b) et les coefficients de Bezout associés avec euclide étendu
+// Entrée : cinq mpz a,b,x,y et pgcd
+// Sortie : vide mais pgcd = PGCD(a,b) et pgcd = ax + by
+void euclid_gcd(mpz_t a,mpz_t b, mpz_t x, mpz_t y, mpz_t pgcd)
+{
+	mpz_t u,v,q,r,m,n;				// ##
+	mpz_inits(u,v,q,r,m,n, NULL);	// #
+	mpz_set_ui(u,1);				// #  Initialisation des variables
+	mpz_set_ui(y,1);				// #
+	mpz_set_ui(x,0);				// #
+	mpz_set_ui(v,0);				// ##
+
+	while (mpz_cmp_ui(b,0) !=0)		// ##
+	{								// #
+		mpz_fdiv_qr(q,r,a,b);		// #
+		mpz_mul(m,u,q);				// #
+		mpz_mul(n,v,q);				// #
+		mpz_sub(m,x,m);				// #
+		mpz_sub(n,y,n);				// #  
+		mpz_set(a,b);				// #  Calcul du PGCD par euclide étendu
+		mpz_set(b,r);				// #
+		mpz_set(x,u);				// #
+		mpz_set(y,v);				// #
+		mpz_set(u,m);				// #
+		mpz_set(v,n);				// #
+	}								// #
+	mpz_set(pgcd,a);				// ##
+
+	mpz_clears(u,v,q,r,m,n,NULL);		
+};
+
+
+// Cette fonction calcule l'inverse modulaire si il existe
+// Entrée : trois mpz inv_mod,b et a
+// Sortie : vide mais inv_mod = b^(-1) [a]
+void modular_inv(mpz_t inv_mod, mpz_t b, mpz_t a)
+{
+	mpz_t save_a,x,y,pgcd,save_b;				// ##
+	mpz_inits(save_a,x,y,pgcd,save_b,NULL);		// #  Initialisation des variables et sauvegarde de a et b
+	mpz_set(save_a,a);							// #
+	mpz_set(save_b,b);							// ##
+	
+	euclid_gcd(a,b,x,y,pgcd);					// Calcul du PGCD et des coefficients de Bezout
+	
+	if (mpz_cmp_ui(pgcd,1) != 0)				// ##
+	{											// #
+		mpz_set_ui(inv_mod,0);					// #  Vérification de PGCD(a,b) = 1
+		mpz_clears(x,y,pgcd,NULL);				// #
+		return;									// #
+	}											// ##
+	
+	modulo(inv_mod , x , save_a);				// ##
+	mpz_set(a,save_a);							// #  Réduction et affectattion de b^(-1) [a] et remise de a et b à leur valeur initiale
+	mpz_set(b,save_b);							// ##
+	
+	mpz_clears(x,y,pgcd,save_a,save_b,NULL);
+};
+
+
+#define TAILLE_ALEA_AVEUGLEMENT 256	// La taille en bit de l'exposant k tiré pour chaque nouvelle paire d'aveuglement (r0^k)^e, r0^(-k)
+
+
+// Contexte d'aveuglement de la base pour les opérations privées
+// r_e = r^e [n] sert à aveugler le chiffré et r_inv = r^(-1) [n] à retirer l'aveuglement du résultat
+// base_e et base_inv sont les tables de précalcul de r0^e et r0^(-1) pour l'aléa r0 tiré à l'initialisation
+typedef struct
+{
+	mpz_t r_e;
+	mpz_t r_inv;
+	mpz_t n;
+	table_base_fixe base_e;
+	table_base_fixe base_inv;
+	int tables_valides;
+} contexte_aveuglement;
+
+
+// Cette fonction initialise un contexte d'aveuglement avec un aléa r0 inversible modulo n et les tables de précalcul de r0^e et r0^(-1)
+// Les tables sont vérifiées une fois contre mpz_powm(), en cas d'écart les paires suivantes sont calculées par exp_mod()
+// Entrée : un contexte, deux mpz e et n correspondant à la clef publique, l'aléa est tiré du générateur ChaCha20 du thread
+// Sortie : vide mais le contexte contient la paire (r^e [n], r^(-1) [n]) avec r = r0^k
+void init_aveuglement(contexte_aveuglement* contexte, mpz_t e, mpz_t n)
+{
+	mpz_t r, borne;																		// ##
+	mpz_inits(r, borne, NULL);															// #  Initialisation des variables
+	mpz_inits(contexte->r_e, contexte->r_inv, NULL);									// #
+	mpz_init_set(contexte->n, n);														// ##
+
+	do 																					// ##
+	{																					// #
+		mpz_sub_ui(borne, n, 2);														// #
+		alea_mpz(r, borne);																// #  Tirage de r entre 2 et n-1 jusqu'à ce qu'il soit inversible
+		mpz_add_ui(r, r, 2);															// #  (borne sert de copie de n, modifiée par modular_inv() en cas d'échec)
+		mpz_set(borne, n);																// #
+		modular_inv(contexte->r_inv, r, borne);											// #
+	}while(mpz_cmp_ui(contexte->r_inv, 0) == 0);										// ##
+
+	exp_mod(contexte->r_e, r, e, n);													// #  Calcul de r0^e [n]
+
+	init_table_base_fixe(&contexte->base_e, contexte->r_e, n, TAILLE_ALEA_AVEUGLEMENT, 0);		// ##
+	init_table_base_fixe(&contexte->base_inv, contexte->r_inv, n, TAILLE_ALEA_AVEUGLEMENT, 0);	// #  Précalcul des puissances de r0^e et r0^(-1)
+	contexte->tables_valides = 1;														// ##
+
+	mpz_t k;																			// ##
+	mpz_init(k);																		// #
+	mpz_set_ui(borne, 0);																// #
+	mpz_setbit(borne, TAILLE_ALEA_AVEUGLEMENT);											// #
+	alea_mpz(k, borne);																	// #
+	exp_mod_base_fixe(contexte->r_e, &contexte->base_e, k);								// #
+	exp_mod_base_fixe(contexte->r_inv, &contexte->base_inv, k);							// #  Première paire par les tables, vérifiée contre mpz_powm()
+	mpz_powm(r, contexte->base_e.puissances[0], k, n);									// #
+	mpz_powm(borne, contexte->base_inv.puissances[0], k, n);							// #
+	if((mpz_cmp(r, contexte->r_e) != 0) || (mpz_cmp(borne, contexte->r_inv) != 0))		// #
+	{																					// #
+		contexte->tables_valides = 0;													// #
+		mpz_set(contexte->r_e, r);														// #
+		mpz_set(contexte->r_inv, borne);												// #
+	}																					// ##
+
+	mpz_set_ui(k, 0);
+	mpz_set_ui(r, 0);
+	mpz_set_ui(borne, 0);
+	mpz_clears(k, r, borne, NULL);
+};
+
+
+// Cette fonction tire une nouvelle paire d'aveuglement indépendante des précédentes : r = r0^k pour un exposant k aléatoire
+// Avec les tables de base fixe la paire coûte environ 2*(TAILLE_ALEA_AVEUGLEMENT/fenetre + 2^fenetre) multiplications, sans inversion
+// Entrée : un contexte d'aveuglement initialisé par init_aveuglement()
+// Sortie : vide mais le contexte contient la paire ((r0^e)^k [n], (r0^(-1))^k [n])
+void renouveler_aveuglement(contexte_aveuglement* contexte)
+{
+	mpz_t k, borne;																		// ##
+	mpz_inits(k, borne, NULL);															// #  Tirage de k sur TAILLE_ALEA_AVEUGLEMENT bits
+	mpz_setbit(borne, TAILLE_ALEA_AVEUGLEMENT);											// #
+	alea_mpz(k, borne);																	// ##
+
+	if(contexte->tables_valides == 1)													// ##
+	{																					// #
+		exp_mod_base_fixe(contexte->r_e, &contexte->base_e, k);							// #
+		exp_mod_base_fixe(contexte->r_inv, &contexte->base_inv, k);						// #  Calcul de la paire par les tables, ou par exp_mod()
+	}																					// #  si elles n'ont pas passé la vérification
+	else																				// #
+	{																					// #
+		exp_mod(contexte->r_e, contexte->base_e.puissances[0], k, contexte->n);			// #
+		exp_mod(contexte->r_inv, contexte->base_inv.puissances[0], k, contexte->n);		// #
+	}																					// ##
+
+	mpz_set_ui(k, 0);
+	mpz_clears(k, borne, NULL);
+};
+
+
+// Cette fonction aveugle un chiffré avant l'exponentiation privée
+// Entrée : un contexte d'aveuglement et un mpz chiffre
+// Sortie : vide mais chiffre = chiffre * r^e [n]
+void aveugler(contexte_aveuglement* contexte, mpz_t chiffre)
+{
+	mpz_mul(chiffre, chiffre, contexte->r_e);
+	modulo(chiffre, chiffre, contexte->n);
+};
+
+
+// Cette fonction met à jour la paire d'aveuglement pour le bloc suivant
+// La mise à jour par élévation au carré donne la paire (r^2e, r^(-2)) pour deux multiplications au lieu d'une exponentiation et d'une inversion
+// Entrée : un contexte d'aveuglement
+// Sortie : vide mais le contexte contient (r_e^2, r_inv^2)
+void avancer_aveuglement(contexte_aveuglement* contexte)
+{
+	mpz_mul(contexte->r_e, contexte->r_e, contexte->r_e);								// ##
+	modulo(contexte->r_e, contexte->r_e, contexte->n);									// #  Mise à jour de la paire
+	mpz_mul(contexte->r_inv, contexte->r_inv, contexte->r_inv);							// #
+	modulo(contexte->r_inv, contexte->r_inv, contexte->n);								// ##
+};
+
+
+// Cette fonction retire l'aveuglement du résultat puis met à jour la paire pour le bloc suivant
+// Entrée : un contexte d'aveuglement et un mpz resultat
+// Sortie : vide mais resultat = resultat * r^(-1) [n] et le contexte contient (r_e^2, r_inv^2)
+void desaveugler(contexte_aveuglement* contexte, mpz_t resultat)
+{
+	mpz_mul(resultat, resultat, contexte->r_inv);										// #  Retrait de l'aveuglement
+	modulo(resultat, resultat, contexte->n);											// #
+
+	avancer_aveuglement(contexte);														// Mise à jour de la paire
+};
+
+
+// Cette fonction efface et libère un contexte d'aveuglement
+// Entrée : un contexte d'aveuglement
+// Sortie : vide
+void clear_aveuglement(contexte_aveuglement* contexte)
+{
+	mpz_set_ui(contexte->r_e, 0);
+	mpz_set_ui(contexte->r_inv, 0);
+	mpz_clears(contexte->r_e, contexte->r_inv, contexte->n, NULL);
+	clear_table_base_fixe(&contexte->base_e);
+	clear_table_base_fixe(&contexte->base_inv);
+};
+
+
+// Cette fonction vérifie si un nombre et premier par Miller-Rabin
+// Entrée : un mpz nombre, les bases sont tirées du générateur ChaCha20 du thread
+// Sortie : 0 si nombre est composé et 1 s'il est probablement premier
+int Miller_Rabin(mpz_t nombre)
+{
+	mpz_t r, a, y, j;
+	mpz_inits(r, a, y, j, NULL);											// ##
+	mpz_set(r, nombre);														// #  Initialisation des variables
+	mpz_sub_ui(r,r,1);														// #
+	int s = 0;																// ##
+	
+	while(modulo_ui(r,2) == 0)												// ##
+	{																		// #
+		s++;																// #  Calcul de r et s tel que nombre-1 = r x 2^s
+		mpz_divexact_ui(r,r,2);												// #
+	}																		// ##
+
+	unsigned int tours = nb_tours_miller_rabin(mpz_sizeinbase(nombre,2));	// Nombre de tours pour une erreur inférieure à 2^-80 ou celui du profil
+	for(unsigned int i = 0; i < tours; i++)									// Boucle avec le paramètre de sécurité
+	{
+		STATS_AJOUTER(STAT_TOURS_MILLER_RABIN,1);							// Comptage des tours de Miller-Rabin
+		mpz_sub_ui(nombre,nombre,3);										// ##
+		alea_mpz(a, nombre);												// #  Tirage aléatoire de a entre 2 et n-2
+		mpz_add_ui(nombre,nombre,3);										// #
+		mpz_add_ui(a, a, 2);												// ##
+
+		exp_mod(y,a,r,nombre);												// Calcul de y = a^r [nombre]
+		
+		mpz_sub_ui(nombre,nombre,1); 										
+		if((mpz_cmp_ui(y,1) != 0) && (mpz_cmp(y,nombre) != 0))				
+		{
+			mpz_set_ui(j,1);
+			while((mpz_cmp_ui(j,(s-1)) <= 0) && (mpz_cmp(y,nombre) != 0))	// ##
+			{																// #
+				mpz_add_ui(nombre,nombre,1);								// #
+				exp_mod_ui(y,y,2,nombre);									// #
+				mpz_sub_ui(nombre,nombre,1); 								// #
+				if(mpz_cmp_ui(y,1) == 0)									// #
+				{															// #
+					mpz_add_ui(nombre,nombre,1); 							// #
+					mpz_clears(r, a, y, j, NULL);							// #
+					return 0;												// #
+				}															// #  Test de Miller-Rabin
+				mpz_add_ui(j,j,1);											// #
+			}																// #									
+			if(mpz_cmp(y,nombre) != 0)										// #
+			{																// #
+				mpz_add_ui(nombre,nombre,1); 								// #
+				mpz_clears(r, a, y, j, NULL);								// #
+				return 0;													// #
+			}																// #
+		}																	// #
+		mpz_add_ui(nombre,nombre,1);										// ##
+	}
+
+	mpz_clears(r, a, y, j, NULL);
+	return 1;
+};
+
+
+// Cette fonction génère aléatoirement un nombre premier par la méthode du crible optimisé
+// Avec deux bits de poids fort à 1 le produit de deux tels premiers de b1 et b2 bits a toujours exactement b1+b2 bits
+// Entrée : un mpz nb_premier, un entier b et un entier bits_forts (1 ou 2) donnant le nombre de bits de poids fort mis à 1
+// Sortie : vide mais nb_premier est un nombre premier de taille b bits
+void optimized_crible_generation(mpz_t nb_premier, unsigned int b, unsigned int bits_forts)
+{
+	mpz_t sub;												// ##																			
+	mpz_t s_1;												// #  Initialisation des variables
+	mpz_t s_2;												// #
+	mpz_inits(sub,s_1,s_2,NULL);							// ##
+	STATS_DEBUT(STAT_GENERATION_PREMIERS);					// Début du chronométrage de la génération
+
+	pthread_once(&calcul_premiers_crible, calculer_premiers_crible);	// ##
+	unsigned int k = taille_crible(b);						// #
+	unsigned int res[k];									// #  Déclaration d'un tableau de résidus de taille k, celle du profil pour b bits
+	unsigned int r;											// #
+	unsigned int* premiers = premiers_crible;				// ##
+	
+	ui_expo_ui(s_1,2,b);									// ##
+	ui_expo_ui(s_2,2,b-1);									// #
+	if(bits_forts == 2)										// #
+	{														// #  Calcul de sub = 2^b - s_2 -1 avec s_2 = 2^(b-1)
+		ui_expo_ui(sub,2,b-2);								// #  ou s_2 = 2^(b-1) + 2^(b-2) pour deux bits de poids fort
+		mpz_add(s_2,s_2,sub);								// #
+	}														// #
+	mpz_sub(sub,s_1,s_2);									// #
+	mpz_sub_ui(sub,sub,1);									// ##
+	
+	do 														// ##
+	{														// #
+		alea_mpz(nb_premier,sub);							// #  Génération d'un nombre aléatoire impaire s'écrivant sur b bits
+		mpz_add(nb_premier,nb_premier,s_2);					// #
+		r = modulo_ui(nb_premier,2);						// #
+	}while(r == 0);											// ##
+	
+	for(unsigned int i=0;i<k;i++) 						// ## 
+	{														// #
+		r = modulo_ui(nb_premier,premiers[i]);				// #  Initialisation du tableau de résidus
+		res[i] = r;											// #
+	}														// ##
+
+	etiquette:
+		for(unsigned int j=0;j<k;j++)						// ##
+		{													// #
+			while(res[j] == 0)								// #
+			{												// #
+				for(unsigned int l=0;l<k;l++)				// #
+				{											// #  Modification de nb_premier jusqu'à trouver un candidat
+					res[l] = mod(res[l]+2, premiers[l]);	// #
+				}											// #
+				mpz_add_ui(nb_premier,nb_premier,2);		// #
+				STATS_AJOUTER(STAT_CANDIDATS_REJETES_CRIBLE,1);	// #
+			}												// #
+		}													// ##
+
+		STATS_AJOUTER(STAT_CANDIDATS_TESTES,1);				// Comptage des candidats soumis à Miller-Rabin
+		if(Miller_Rabin(nb_premier) == 0)				// ##
+		{													// #
+			for(unsigned int m=0;m<k;m++)				// #
+			{												// #
+				res[m] = mod(res[m]+2, premiers[m]);		// #  Appel de la fonction Miller_Rabin() pour tester notre candidat, on recommence au cas échéant
+			}												// #
+			mpz_add_ui(nb_premier,nb_premier,2);			// #
+			goto etiquette;									// #
+		}													// ##
+		goto etiquette2;
+
+	etiquette2:
+		mpz_clears(sub,s_1,s_2,NULL);
+		STATS_FIN(STAT_GENERATION_PREMIERS);
+};
+
+
+// Cette fonction génère un premier de b bits aux deux bits de poids fort à 1 tel que e soit inversible modulo premier-1
+// Seul ce premier est recommencé si e n'est pas inversible, l'autre facteur de la clef est gardé
+// Entrée : un mpz premier, un entier b et un mpz e
+// Sortie : vide mais premier contient le nombre premier
+void premier_pour_cle(mpz_t premier, unsigned int b, mpz_t e)
+{
+	mpz_t pgcd;
+	mpz_init(pgcd);
+	do
+	{
+		optimized_crible_generation(premier, b, 2);
+		mpz_sub_ui(pgcd, premier, 1);
+		mpz_gcd(pgcd, pgcd, e);
+	}while(mpz_cmp_ui(pgcd, 1) != 0);
+	mpz_clear(pgcd);
+};
+
+
+// Réserve de premiers sur disque, un fichier reserve_premiers_<bits>.bin par taille de premier
+// Le fichier est projeté en mémoire : un en-tête puis des entrées de taille fixe (le premier en big-endian), ajoutées à la fin seulement
+// Les entrées sont tirées dans l'ordre, chaque entrée tirée est effacée et comptée dans l'en-tête. Un verrou flock() protège le fichier entre processus
+#define MAGIQUE_RESERVE "RSVP"
+
+typedef struct
+{
+	char magique[4];
+	uint32_t bits;
+	uint64_t nb_entrees;
+	uint64_t nb_consommees;
+} entete_reserve;
+
+// Réserve ouverte : descripteur verrouillé et projection du fichier
+typedef struct
+{
+	int fd;
+	entete_reserve* entete;
+	unsigned char* entrees;
+	size_t taille;
+	unsigned long octets;
+} reserve_premiers;
+
+
+// Cette fonction ouvre, verrouille et projette en mémoire la réserve des premiers de b bits
+// Entrée : une reserve_premiers, un entier b, un entier creer (1 pour créer la réserve si elle n'existe pas) et un entier nb_ajouts d'entrées à ajouter à la fin
+// Sortie : 0 si la réserve est ouverte et verrouillée jusqu'à fermer_reserve(), -1 si elle n'existe pas ou n'est pas valide
+int ouvrir_reserve(reserve_premiers* reserve, unsigned int b, int creer, unsigned long nb_ajouts)
+{
+	char nom[64];																			// ##
+	snprintf(nom, sizeof(nom), "reserve_premiers_%u.bin", b);								// #
+	reserve->fd = open(nom, O_RDWR | (creer ? O_CREAT : 0), 0600);							// #  Ouverture et verrouillage du fichier
+	if(reserve->fd < 0)																		// #
+	{																						// #
+		return -1;																			// #
+	}																						// #
+	flock(reserve->fd, LOCK_EX);															// ##
+
+	struct stat informations;																// ##
+	fstat(reserve->fd, &informations);														// #
+	entete_reserve entete = {MAGIQUE_RESERVE, b, 0, 0};										// #
+	if((unsigned long) informations.st_size < sizeof(entete_reserve))						// #
+	{																						// #
+		if(creer == 0)																		// #  En-tête d'une réserve nouvelle ou lu dans le fichier
+		{																					// #
+			close(reserve->fd);																// #
+			return -1;																		// #
+		}																					// #
+	}																						// #
+	else if(pread(reserve->fd, &entete, sizeof(entete), 0) != sizeof(entete))				// #
+	{																						// #
+		close(reserve->fd);																	// #
+		return -1;																			// #
+	}																						// ##
+	if((memcmp(entete.magique, MAGIQUE_RESERVE, 4) != 0) || (entete.bits != b))
+	{
+		close(reserve->fd);
+		return -1;
+	}
+
+	if((nb_ajouts > 0) && (entete.nb_consommees == entete.nb_entrees))						// ##
+	{																						// #  Une réserve épuisée repart de zéro avant un ajout
+		entete.nb_entrees = 0;																// #
+		entete.nb_consommees = 0;															// #
+	}																						// ##
+
+	reserve->octets = (b + 7) / 8;																		// ##
+	reserve->taille = sizeof(entete_reserve) + (entete.nb_entrees + nb_ajouts) * reserve->octets;		// #
+	if(((unsigned long) informations.st_size != reserve->taille) && (ftruncate(reserve->fd, reserve->taille) != 0))	// #
+	{																									// #
+		close(reserve->fd);																				// #
+		return -1;																						// #  Projection du fichier, agrandi pour les ajouts
+	}																									// #
+	reserve->entete = mmap(NULL, reserve->taille, PROT_READ | PROT_WRITE, MAP_SHARED, reserve->fd, 0);	// #
+	if(reserve->entete == MAP_FAILED)																	// #
+	{																									// #
+		close(reserve->fd);																				// #
+		return -1;																						// #
+	}																									// #
+	*reserve->entete = entete;																			// #
+	reserve->entrees = (unsigned char*) (reserve->entete + 1);											// ##
+	return 0;
+};
+
+
+// Cette fonction écrit la réserve sur le disque, la libère et lève le verrou
+// Entrée : une reserve_premiers ouverte
+// Sortie : vide
+void fermer_reserve(reserve_premiers* reserve)
+{
+	msync(reserve->entete, reserve->taille, MS_SYNC);
+	munmap(reserve->entete, reserve->taille);
+	flock(reserve->fd, LOCK_UN);
+	close(reserve->fd);
+};
+
+
+// Cette fonction tire le prochain premier de b bits de la réserve et efface son entrée
+// L'entrée tirée repasse le test de Miller-Rabin : une réserve abîmée ou modifiée ne peut pas donner un facteur composé
+// Entrée : un mpz premier et un entier b
+// Sortie : 1 si un premier a été tiré, 0 si la réserve est vide, absente ou si l'entrée n'est pas un premier de b bits
+int tirer_premier_reserve(mpz_t premier, unsigned int b)
+{
+	reserve_premiers reserve;
+	if(ouvrir_reserve(&reserve, b, 0, 0) != 0)
+	{
+		return 0;
+	}
+
+	int tire = 0;
+	if(reserve.entete->nb_consommees < reserve.entete->nb_entrees)								// ##
+	{																							// #
+		unsigned char* entree = reserve.entrees + reserve.entete->nb_consommees * reserve.octets;	// #
+		mpz_import(premier, reserve.octets, 1, 1, 1, 0, entree);								// #  Lecture puis effacement de la première entrée non consommée
+		memset(entree, 0, reserve.octets);														// #
+		reserve.entete->nb_consommees++;														// #
+		tire = (mpz_sizeinbase(premier, 2) == b) && mpz_odd_p(premier) && (Miller_Rabin(premier) == 1);	// #
+		if(tire == 0)																			// #
+		{																						// #
+			printf("\nAttention, une entrée de la réserve reserve_premiers_%u.bin n'est pas un premier de %u bits, elle est ignorée.\n", b, b);	// #
+		}																						// #
+	}																							// ##
+	fermer_reserve(&reserve);
+	if(tire == 1)
+	{
+		STATS_AJOUTER(STAT_PREMIERS_RESERVE,1);													// Comptage des premiers pris dans la réserve
+	}
+	return tire;
+};
+
+
+// Cette fonction ajoute des premiers de b bits à la fin de la réserve
+// Entrée : un tableau de nb mpz premiers et deux entiers nb et b
+// Sortie : 0 si les premiers ont été ajoutés, -1 sinon
+int ajouter_premiers_reserve(mpz_t* premiers, unsigned long nb, unsigned int b)
+{
+	reserve_premiers reserve;
+	if(ouvrir_reserve(&reserve, b, 1, nb) != 0)
+	{
+		return -1;
+	}
+
+	for(unsigned long i = 0; i < nb; i++)														// ##
+	{																							// #
+		unsigned char* entree = reserve.entrees + (reserve.entete->nb_entrees + i) * reserve.octets;	// #  Ecriture des entrées en big-endian sur une taille fixe
+		memset(entree, 0, reserve.octets);														// #
+		mpz_export(entree + reserve.octets - (mpz_sizeinbase(premiers[i], 2) + 7) / 8, NULL, 1, 1, 1, 0, premiers[i]);	// #
+	}																							// ##
+	reserve.entete->nb_entrees += nb;
+	fermer_reserve(&reserve);
+	return 0;
+};
+
+
+// Cette fonction compte les premiers de b bits encore disponibles dans la réserve du répertoire courant
+// Entrée : un entier b
+// Sortie : le nombre d'entrées non consommées, 0 si la réserve est absente
+unsigned long premiers_disponibles_reserve(unsigned int b)
+{
+	reserve_premiers reserve;
+	if(ouvrir_reserve(&reserve, b, 0, 0) != 0)
+	{
+		return 0;
+	}
+	unsigned long disponibles = reserve.entete->nb_entrees - reserve.entete->nb_consommees;
+	fermer_reserve(&reserve);
+	return disponibles;
+};
+
+
+// Cette fonction demande à l'utilisateur s'il veut prendre les premiers d'une clef de nombre_bit bits dans la réserve, si elle en contient
+// Entrée : un entier nombre_bit
+// Sortie : 1 si la réserve doit être utilisée, 0 sinon
+int choisir_reserve(unsigned int nombre_bit)
+{
+	char choix;
+	unsigned long disponibles = premiers_disponibles_reserve(nombre_bit/2);
+	if(nombre_bit - nombre_bit/2 != nombre_bit/2)
+	{
+		disponibles += premiers_disponibles_reserve(nombre_bit - nombre_bit/2);
+	}
+	if(disponibles == 0)
+	{
+		return 0;
+	}
+
+	printf("\nLa réserve du répertoire courant contient %lu premiers pour cette taille de clé, voulez-vous les utiliser?[Y/N]\n\n", disponibles);
+	scanf(" %c",&choix);
+	while((choix != 'Y') & (choix != 'N'))
+	{
+		printf("Le choix que vous avez fait n'a pas été compris, voulez-vous utiliser la réserve (attendu Y ou N)?\n\n");
+		scanf(" %c",&choix);
+	}
+	return choix == 'Y';
+};
+
+
+// Cette fonction donne un premier pour une clef : pris dans la réserve si on l'a choisi et qu'il y en a, cherché par le crible sinon
+// Entrée : un mpz premier, un entier b, un mpz e et un entier reserve (1 pour utiliser la réserve)
+// Sortie : vide mais premier est un premier de b bits aux deux bits de poids fort à 1 avec e inversible modulo premier-1
+void obtenir_premier(mpz_t premier, unsigned int b, mpz_t e, unsigned int reserve)
+{
+	if((reserve == 1) && (tirer_premier_reserve(premier, b) == 1))
+	{
+		mpz_t pgcd;
+		mpz_init(pgcd);
+		mpz_sub_ui(pgcd, premier, 1);
+		mpz_gcd(pgcd, pgcd, e);
+		int valide = (mpz_cmp_ui(pgcd, 1) == 0) && mpz_tstbit(premier, b-2);
+		mpz_clear(pgcd);
+		if(valide == 1)
+		{
+			return;
+		}
+	}
+	premier_pour_cle(premier, b, e);
+};
+
+
+// Cette fonction génère l'ensemble des clefs publique et secrète nécessaire pour RSA
+// Entrée : un entier nombre_bit
+// Sortie : vide mais création d'un fichier contenant une clef publique et un autre la clef secrète associée
+void generation_cle(unsigned int nombre_bit)
+{
+
+	mpz_t phi, e, cle_publique, cle_prive, p, q, Ip;								// ##
+	mpz_inits(phi,e, cle_publique, cle_prive, p, q, Ip, NULL);						// #  Initialisation des variables
+	mpz_set_ui(e,65537);															// #
+	char choix;																		// ##
+
+	char nom_fichier_cle_publique[100];																									// ##
+	etiquette:																															// #
+		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker la clé publique?\n\n");									// #
+		scanf(" %99s", nom_fichier_cle_publique);																							// #
+		if(access( nom_fichier_cle_publique, F_OK ) == 0)																				// #
+		{																																// #
+			printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
+			scanf(" %c",&choix);																										// #
+			while((choix != 'Y') & (choix != 'N'))																						// #
+			{																															// #  Création et ouverture du fichier qui contiendra la clef publique
+				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
+				scanf(" %c",&choix);																									// #
+			}																															// #
+			if(choix == 'N')																											// #
+			{																															// #
+				goto etiquette;																											// #
+			}																															// #
+		}																																// #
+	FILE* publique = fopen(nom_fichier_cle_publique,"wb+");																				// ##
+
+
+	char nom_fichier_cle_secrete[100];																									// ##
+	etiquette2:																															// #
+    	printf("\nQuel est le nom du fichier dans lequel vous désirez stocker la clé privée?\n\n");										// #
+   		scanf(" %99s", nom_fichier_cle_secrete);																							// #
+   		if(access( nom_fichier_cle_secrete, F_OK ) == 0)																				// #
+		{																																// #
+			printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
+			scanf(" %c",&choix);																										// #
+			while((choix != 'Y') & (choix != 'N'))																						// #
+			{																															// #  Création et ouverture du fichier qui contiendra la clef secrète
+				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
+				scanf(" %c",&choix);																									// #
+			}																															// #
+			if(choix == 'N')																											// #
+			{																															// #
+				goto etiquette2;																										// #
+			}																															// #
+		}																																// #
+	FILE* secret = fopen(nom_fichier_cle_secrete,"wb+");																				// ##
+
+	unsigned int reserve = choisir_reserve(nombre_bit);								// #  La réserve n'est utilisée que si on le demande
+
+	STATS_REINITIALISER();															// ##
+	STATS_DEBUT(STAT_TOTAL);														// ##  Début de l'instrumentation de la génération
+
+	obtenir_premier(p, nombre_bit/2, e, reserve);						// ##
+	do 																				// #
+	{																				// #  Premiers pris dans la réserve ou cherchés par optimized_crible_generation()
+		obtenir_premier(q, nombre_bit - nombre_bit/2, e, reserve);		// #  Leurs deux bits de poids fort à 1 donnent une clef publique d'exactement nombre_bit bits
+	}																				// #
+	while(mpz_cmp(p,q) == 0);														// #
+	mpz_mul(cle_publique, p, q);													// ##
+
+	mpz_sub_ui(p,p,1);																// ## 
+	mpz_sub_ui(q,q,1);																// #
+	mpz_mul(phi,p,q);																// #  Calcul de phi
+	mpz_add_ui(p,p,1);																// #
+	mpz_add_ui(q,q,1);																// ##
+
+	modular_inv(cle_prive, e, phi);													// #  Calcul de la clef secrète
+	modular_inv(Ip,p,q);															// #
+
+	mpz_out_raw(publique,cle_publique);												// #  Ecriture des clefs dans leur fichier respectifs
+	mpz_out_raw(secret,cle_prive);													// #
+	mpz_out_raw(secret,p);
+	mpz_out_raw(secret,q);
+	mpz_out_raw(secret,Ip);
+	
+	mpz_clears(phi, e, cle_publique, cle_prive, p, q, Ip, NULL);
+	fclose(publique);
+	fclose(secret);
+
+	STATS_FIN(STAT_TOTAL);															// ##
+	STATS_EXPORTER("generation_cle");												// ##  Export des statistiques de la génération
+};
+
+
+// Paramètres d'une génération de clefs en lot, partagés par les workers
+typedef struct
+{
+	unsigned int nombre_bit;
+	unsigned long nb_cles;
+	unsigned long prochaine;
+	unsigned int reserve;
+	int erreur;
+	char dossier[100];
+} lot_cles;
+
+
+// Cette fonction est exécutée par chaque worker de la génération en lot : elle prend le numéro de la prochaine clef et l'écrit dans le dossier
+// Les premiers ont leurs deux bits de poids fort à 1, n a donc toujours exactement nombre_bit bits sans tirage à recommencer
+// Les clefs privées sont créées en mode 0600. Une clef qui ne peut pas être écrite est supprimée, signalée et arrête tout le lot
+// Entrée : un pointeur vers le lot_cles
+// Sortie : NULL
+void* generer_lot_cles(void* argument)
+{
+	lot_cles* lot = argument;
+
+	mpz_t e, n, phi, d, p, q, Ip;																// ##
+	mpz_inits(e, n, phi, d, p, q, Ip, NULL);													// #  Initialisation des variables, l'aléa vient du générateur ChaCha20 du worker
+	mpz_set_ui(e, 65537);																		// ##
+	char nom_publique[160];
+	char nom_privee[160];
+
+	unsigned long numero;
+	while((numero = __atomic_fetch_add(&lot->prochaine, 1, __ATOMIC_RELAXED)) < lot->nb_cles)
+	{
+		obtenir_premier(p, lot->nombre_bit/2, e, lot->reserve);					// ##
+		do																						// #
+		{																						// #  Génération de p et q, q plus grand d'un bit si nombre_bit est impair
+			obtenir_premier(q, lot->nombre_bit - lot->nombre_bit/2, e, lot->reserve);	// #
+		}while(mpz_cmp(p, q) == 0);																// ##
+
+		mpz_mul(n, p, q);																		// ##
+		mpz_sub_ui(p, p, 1);																	// #
+		mpz_sub_ui(q, q, 1);																	// #
+		mpz_mul(phi, p, q);																		// #
+		mpz_add_ui(p, p, 1);																	// #  Calcul de n, de la clef secrète et de Ip
+		mpz_add_ui(q, q, 1);																	// #
+		mpz_invert(d, e, phi);																	// #
+		mpz_invert(Ip, p, q);																	// ##
+
+		snprintf(nom_publique, sizeof(nom_publique), "%s/cle_%06lu.publique", lot->dossier, numero);	// ##
+		snprintf(nom_privee, sizeof(nom_privee), "%s/cle_%06lu.privee", lot->dossier, numero);		// #
+		FILE* publique = fopen(nom_publique, "wb");												// #
+		int fd = open(nom_privee, O_CREAT | O_WRONLY | O_TRUNC, 0600);							// #
+		FILE* secret = ((fd >= 0) && (fchmod(fd, 0600) == 0)) ? fdopen(fd, "wb") : NULL;		// #  Ouverture des fichiers, la clef privée n'est lisible
+		if((secret == NULL) && (fd >= 0))														// #  que par son propriétaire
+		{																						// #
+			close(fd);																			// #
+		}																						// ##
+
+		int publique_ouverte = (publique != NULL);												// ##
+		int secret_ouvert = (fd >= 0);															// #
+		int erreur = (publique == NULL) || (secret == NULL);									// #
+		if(erreur == 0)																			// #
+		{																						// #
+			erreur = (mpz_out_raw(publique, n) == 0) | (mpz_out_raw(secret, d) == 0) | (mpz_out_raw(secret, p) == 0)	// #
+				| (mpz_out_raw(secret, q) == 0) | (mpz_out_raw(secret, Ip) == 0);				// #  Ecriture des clefs au format de generation_cle()
+		}																						// #
+		if((publique != NULL) && (fclose(publique) != 0))										// #
+		{																						// #
+			erreur = 1;																			// #
+		}																						// #
+		if((secret != NULL) && (fclose(secret) != 0))											// #
+		{																						// #
+			erreur = 1;																			// #
+		}																						// ##
+
+		if(erreur != 0)																			// ##
+		{																						// #
+			printf("\nLa clé n°%lu ne peut pas être écrite dans %s, le lot est interrompu.\n", numero, lot->dossier);	// #
+			if(publique_ouverte)																// #
+			{																					// #
+				remove(nom_publique);															// #  Echec d'écriture : suppression des fichiers ouverts
+			}																					// #  pour cette clef et arrêt des autres workers
+			if(secret_ouvert)																	// #
+			{																					// #
+				remove(nom_privee);																// #
+			}																					// #
+			lot->erreur = 1;																	// #
+			__atomic_store_n(&lot->prochaine, lot->nb_cles, __ATOMIC_RELAXED);					// #
+			break;																				// #
+		}																						// ##
+	}
+
+	mpz_set_ui(d, 0);																			// ##
+	mpz_set_ui(p, 0);																			// #
+	mpz_set_ui(q, 0);																			// #  Effacement des secrets et libération
+	mpz_set_ui(phi, 0);																			// #
+	mpz_clears(e, n, phi, d, p, q, Ip, NULL);													// ##
+	return NULL;
+};
+
+
+// Cette fonction génère un lot de paires de clefs RSA dans un dossier, sur tous les cœurs
+// Entrée : vide
+// Sortie : vide mais le dossier contient les fichiers cle_XXXXXX.publique et cle_XXXXXX.privee, le débit est affiché
+void generation_lot_cles()
+{
+	lot_cles lot;
+	char choix;
+
+	printf("\nQuelle est la longeur des clés publiques souhaitées (en bit) ?\n\n");
+	scanf(" %u", &lot.nombre_bit);
+	printf("\nCombien de paires de clés souhaitez-vous générer?\n\n");
+	scanf(" %lu", &lot.nb_cles);
+
+	etiquette:																															// ##
+		printf("\nQuel est le nom du dossier dans lequel vous désirez stocker les clés?\n\n");											// #
+		scanf(" %99s", lot.dossier);																									// #
+		if(access( lot.dossier, F_OK ) == 0)																							// #
+		{																																// #
+			printf("\nAttention, le dossier saisi existe déjà, êtes-vous sûr de vouloir écraser les clés qu'il contient?[Y/N]\n\n");	// #
+			scanf(" %c",&choix);																										// #
+			while((choix != 'Y') & (choix != 'N'))																						// #  Création du dossier qui contiendra les clefs
+			{																															// #
+				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir les écraser (attendu Y ou N)?\n\n");	// #
+				scanf(" %c",&choix);																									// #
+			}																															// #
+			if(choix == 'N')																											// #
+			{																															// #
+				goto etiquette;																											// #
+			}																															// #
+		}																																// #
+		else if(mkdir(lot.dossier, 0700) != 0)																							// #
+		{																																// #
+			printf("\nLe dossier n'a pas pu être créé.\n");																				// #
+			goto etiquette;																												// #
+		}																																// ##
+	lot.reserve = choisir_reserve(lot.nombre_bit);												// #  La réserve n'est utilisée que si on le demande
+
+	STATS_REINITIALISER();																		// ##
+	STATS_DEBUT(STAT_TOTAL);																	// ##  Début de l'instrumentation de la génération
+	double debut = chrono();
+
+	lot.prochaine = 0;																			// ##
+	lot.erreur = 0;																				// #
+	unsigned long nb_workers = sysconf(_SC_NPROCESSORS_ONLN);									// #
+	if(nb_workers > lot.nb_cles)																// #
+	{																							// #
+		nb_workers = (lot.nb_cles > 0) ? lot.nb_cles : 1;										// #
+	}																							// #
+	pthread_t* workers = malloc(nb_workers * sizeof(pthread_t));								// #
+	for(unsigned long i = 0; i < nb_workers; i++)												// #  Génération en parallèle, une clef à la fois par worker
+	{																							// #
+		pthread_create(&workers[i], NULL, generer_lot_cles, &lot);								// #
+	}																							// #
+	for(unsigned long i = 0; i < nb_workers; i++)												// #
+	{																							// #
+		pthread_join(workers[i], NULL);															// #
+	}																							// #
+	free(workers);																				// ##
+
+	double duree = chrono() - debut;
+	if(lot.erreur != 0)
+	{
+		printf("\nLa génération du lot a échoué, les clés déjà écrites dans %s sont complètes.\n", lot.dossier);
+	}
+	else
+	{
+		printf("\n%lu paires de clés de %u bits générées dans %s en %.3f s, soit %.2f clés/s avec %lu workers.\n", lot.nb_cles, lot.nombre_bit, lot.dossier, duree, lot.nb_cles / duree, nb_workers);
+	}
+
+	STATS_FIN(STAT_TOTAL);																		// ##
+	STATS_EXPORTER("generation_lot_cles");														// ##  Export des statistiques de la génération
+};
+
+
+// Paramètres d'un remplissage de la réserve de premiers, partagés par les workers
+typedef struct
+{
+	unsigned int bits[2];
+	unsigned long nb_premiers;
+	unsigned long prochain;
+} remplissage_reserve;
+
+
+// Cette fonction est exécutée par chaque worker du remplissage : elle cherche des premiers et les ajoute un par un à la réserve
+// Les premiers de numéro pair ont la taille de p, ceux de numéro impair celle de q
+// Entrée : un pointeur vers le remplissage_reserve
+// Sortie : NULL
+void* remplir_reserve(void* argument)
+{
+	remplissage_reserve* remplissage = argument;
+
+	mpz_t e, premier;																			// ##
+	mpz_inits(e, premier, NULL);																// #  Initialisation des variables, l'aléa vient du générateur ChaCha20 du worker
+	mpz_set_ui(e, 65537);																		// ##
+
+	unsigned long numero;
+	while((numero = __atomic_fetch_add(&remplissage->prochain, 1, __ATOMIC_RELAXED)) < remplissage->nb_premiers)
+	{
+		premier_pour_cle(premier, remplissage->bits[numero % 2], e);
+		ajouter_premiers_reserve(&premier, 1, remplissage->bits[numero % 2]);
+	}
+
+	mpz_set_ui(premier, 0);
+	mpz_clears(e, premier, NULL);
+	return NULL;
+};
+
+
+// Cette fonction remplit hors ligne la réserve avec les premiers de nb_paires clefs, sur tous les cœurs
+// Entrée : vide
+// Sortie : vide mais les premiers sont ajoutés aux fichiers reserve_premiers_<bits>.bin
+void remplissage_reserve_premiers()
+{
+	unsigned int nombre_bit;
+	unsigned long nb_paires;
+	printf("\nPour quelle longueur de clé publique faut-il préparer des premiers (en bit) ?\n\n");
+	scanf(" %u", &nombre_bit);
+	printf("\nPour combien de paires de clés?\n\n");
+	scanf(" %lu", &nb_paires);
+
+	remplissage_reserve remplissage;															// ##
+	remplissage.bits[0] = nombre_bit/2;															// #  Tailles de p et de q comme dans generation_cle()
+	remplissage.bits[1] = nombre_bit - nombre_bit/2;											// #
+	remplissage.nb_premiers = 2*nb_paires;														// #
+	remplissage.prochain = 0;																	// ##
+
+	double debut = chrono();
+	unsigned long nb_workers = sysconf(_SC_NPROCESSORS_ONLN);									// ##
+	pthread_t* workers = malloc(nb_workers * sizeof(pthread_t));								// #
+	for(unsigned long i = 0; i < nb_workers; i++)												// #
+	{																							// #
+		pthread_create(&workers[i], NULL, remplir_reserve, &remplissage);						// #  Recherche des premiers en parallèle
+	}																							// #
+	for(unsigned long i = 0; i < nb_workers; i++)												// #
+	{																							// #
+		pthread_join(workers[i], NULL);															// #
+	}																							// #
+	free(workers);																				// ##
+	double duree = chrono() - debut;
+
+	printf("\n%lu premiers ajoutés en %.3f s, soit %.2f premiers/s.\n", remplissage.nb_premiers, duree, remplissage.nb_premiers / duree);
+	for(int i = 0; i < 2; i++)																	// ##
+	{																							// #
+		reserve_premiers reserve;																// #
+		if(((i == 0) || (remplissage.bits[1] != remplissage.bits[0])) && (ouvrir_reserve(&reserve, remplissage.bits[i], 0, 0) == 0))	// #
+		{																						// #  Etat des réserves
+			printf("Réserve des premiers de %u bits : %lu disponibles.\n", remplissage.bits[i], (unsigned long) (reserve.entete->nb_entrees - reserve.entete->nb_consommees));	// #
+			fermer_reserve(&reserve);															// #
+		}																						// #
+	}																							// ##
+};
+
+
+// Cette fonction mesure sur l'hôte la génération de premiers pour plusieurs tailles de crible et garde la plus rapide dans le profil
+// Chaque taille de crible est essayée à partir des mêmes points de départ, donc sur les mêmes candidats
+// Entrée : un entier nombre_bit, la plus grande taille de clef pour laquelle on génère des premiers
+// Sortie : vide mais profil_hote contient un réglage crible par taille de premier
+void optimisation_crible(unsigned int nombre_bit)
+{
+	unsigned int tailles[7] = {256, 384, 512, 768, 1024, 1536, 2048};							// Tailles de premiers mesurées
+	unsigned int candidats[8] = {50, 100, 200, 400, 800, 1600, 3200, 6400};						// Tailles de crible essayées
+	mpz_t premier;
+	mpz_init(premier);
+
+	for(int t = 0; (t < 7) && ((t == 0) || (tailles[t] <= nombre_bit/2)); t++)
+	{
+		unsigned int b = tailles[t];
+		unsigned int nb_premiers = (8192/b > 4) ? 8192/b : 4;									// Plus de premiers pour les petites tailles, plus rapides
+		unsigned int tours = tours_miller_rabin(b);
+		unsigned int meilleur_k = K;
+		double meilleure_duree = 0;
+		printf("\nPremiers de %u bits (%u tours de Miller-Rabin) :\n", b, tours);
+		for(int c = 0; c < 8; c++)
+		{
+			regler_crible(b, candidats[c], tours);												// ##
+			double debut = chrono();															// #
+			for(unsigned int i = 0; i < nb_premiers; i++)										// #
+			{																					// #  Mesure de la génération de nb_premiers premiers
+				fixer_alea_thread(i);															// #  Le même point de départ pour chaque K donne le même premier
+				optimized_crible_generation(premier, b, 2);										// #
+			}																					// #
+			double duree = (chrono() - debut) / nb_premiers;									// ##
+			printf("  K = %4u : %8.3f ms par premier\n", candidats[c], 1000*duree);
+			if((c == 0) || (duree < meilleure_duree))
+			{
+				meilleure_duree = duree;
+				meilleur_k = candidats[c];
+			}
+		}
+		regler_crible(b, meilleur_k, tours);
+		printf("  => K = %u retenu\n", meilleur_k);
+	}
+
+	mpz_clear(premier);
+	resemer_alea_thread();																		// #  Fin des tirages reproductibles
+};
+
+
+// Cette fonction donne la taille d'un nombre en base 256
+// Entrée : un mpz n
+// Sortie : un entier compteur donnant en combien d'octet s'écrit n
+unsigned int taille_256(mpz_t n)
+{
+	mpz_t a;						// ##
+	mpz_init_set_ui(a,256);			// #  Initialisation des variables
+	unsigned int compteur = 1;		// ##
+
+	while(mpz_cmp(n,a) > 0)			// ##
+	{								// #
+		mpz_mul_ui(a,a,256);		// #  Boucle comparant n avec les puissances de 256 jusqu'à ce que n < 256^a
+		compteur = compteur+1;		// #
+	}								// ##
+
+	mpz_clear(a);
+	return(compteur);
+};
+
+
+// Noms des fichiers de travail des commandes du menu, propres à chaque thread (le démon, lui, travaille en mémoire)
+typedef struct
+{
+	char oaep[64];
+	char hasher[64];
+	char signature[64];
+} fichiers_travail;
+
+_Thread_local fichiers_travail travail = {"OAEP", "HASHER", "signature_a_verifier"};
+
+
+// Etat d'un calcul SHA-256 incrémental
+typedef struct
+{
+	uint32_t h[8];
+	uint64_t longueur;
+	unsigned char bloc[64];
+	unsigned int remplissage;
+} contexte_sha256;
+
+const uint32_t constantes_sha256[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define ROTATION_DROITE(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+
+// Cette fonction initialise un calcul SHA-256
+// Entrée : un contexte
+// Sortie : vide
+void sha256_init(contexte_sha256* contexte)
+{
+	const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+	memcpy(contexte->h, initial, sizeof(initial));
+	contexte->longueur = 0;
+	contexte->remplissage = 0;
+};
+
+
+// Cette fonction applique la fonction de compression de SHA-256 à un bloc de 64 octets
+// Entrée : un tableau h de 8 mots et un bloc de 64 octets
+// Sortie : vide mais h est mis à jour
+void sha256_compression(uint32_t* h, const unsigned char* bloc)
+{
+	uint32_t w[64];
+	for(int i = 0; i < 16; i++)																																// ##
+	{																																						// #
+		w[i] = ((uint32_t) bloc[4*i] << 24) | ((uint32_t) bloc[4*i+1] << 16) | ((uint32_t) bloc[4*i+2] << 8) | bloc[4*i+3];									// #
+	}																																						// #
+	for(int i = 16; i < 64; i++)																															// #  Préparation des 64 mots du bloc
+	{																																						// #
+		uint32_t s0 = ROTATION_DROITE(w[i-15], 7) ^ ROTATION_DROITE(w[i-15], 18) ^ (w[i-15] >> 3);															// #
+		uint32_t s1 = ROTATION_DROITE(w[i-2], 17) ^ ROTATION_DROITE(w[i-2], 19) ^ (w[i-2] >> 10);															// #
+		w[i] = w[i-16] + s0 + w[i-7] + s1;																													// #
+	}																																						// ##
+
+	uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+	for(int i = 0; i < 64; i++)																																// ##
+	{																																						// #
+		uint32_t t1 = k + (ROTATION_DROITE(e, 6) ^ ROTATION_DROITE(e, 11) ^ ROTATION_DROITE(e, 25)) + ((e & f) ^ (~e & g)) + constantes_sha256[i] + w[i];	// #
+		uint32_t t2 = (ROTATION_DROITE(a, 2) ^ ROTATION_DROITE(a, 13) ^ ROTATION_DROITE(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));							// #
+		k = g;																																				// #
+		g = f;																																				// #  64 tours
+		f = e;																																				// #
+		e = d + t1;																																			// #
+		d = c;																																				// #
+		c = b;																																				// #
+		b = a;																																				// #
+		a = t1 + t2;																																		// #
+	}																																						// ##
+
+	h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+	h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+};
+
+
+// Cette fonction ajoute des octets à un calcul SHA-256
+// Entrée : un contexte, un tableau donnees et sa taille
+// Sortie : vide
+void sha256_maj(contexte_sha256* contexte, const unsigned char* donnees, size_t taille)
+{
+	contexte->longueur += taille;
+	if(contexte->remplissage > 0)											// ##
+	{																		// #
+		size_t morceau = 64 - contexte->remplissage;						// #
+		if(morceau > taille)												// #
+		{																	// #
+			morceau = taille;												// #
+		}																	// #
+		memcpy(contexte->bloc + contexte->remplissage, donnees, morceau);	// #  Complétion du bloc en attente
+		contexte->remplissage += morceau;									// #
+		donnees += morceau;													// #
+		taille -= morceau;													// #
+		if(contexte->remplissage == 64)										// #
+		{																	// #
+			sha256_compression(contexte->h, contexte->bloc);				// #
+			contexte->remplissage = 0;										// #
+		}																	// #
+	}																		// ##
+	while(taille >= 64)														// ##
+	{																		// #
+		sha256_compression(contexte->h, donnees);							// #  Blocs complets traités directement depuis donnees
+		donnees += 64;														// #
+		taille -= 64;														// #
+	}																		// ##
+	if(taille > 0)															// ##
+	{																		// #
+		memcpy(contexte->bloc, donnees, taille);							// #  Mise en attente de la fin
+		contexte->remplissage = taille;										// #
+	}																		// ##
+};
+
+
+// Cette fonction termine un calcul SHA-256
+// Entrée : un contexte et un tableau empreinte de 32 octets
+// Sortie : vide mais empreinte contient le hash
+void sha256_final(contexte_sha256* contexte, unsigned char* empreinte)
+{
+	uint64_t bits = contexte->longueur * 8;																			// ##
+	unsigned char fin[72] = {0x80};																					// #
+	size_t taille_fin = (contexte->remplissage < 56) ? 56 - contexte->remplissage : 120 - contexte->remplissage;	// #
+	for(int i = 0; i < 8; i++)																						// #  Padding : 0x80, des zéros et la longueur en bits
+	{																												// #
+		fin[taille_fin + i] = bits >> (56 - 8*i);																	// #
+	}																												// #
+	sha256_maj(contexte, fin, taille_fin + 8);																		// ##
+
+	for(int i = 0; i < 8; i++)																						// ##
+	{																												// #
+		empreinte[4*i] = contexte->h[i] >> 24;																		// #
+		empreinte[4*i+1] = contexte->h[i] >> 16;																	// #  Ecriture de l'empreinte en big-endian
+		empreinte[4*i+2] = contexte->h[i] >> 8;																		// #
+		empreinte[4*i+3] = contexte->h[i];																			// #
+	}																												// ##
+};
+
+
+#define TAILLE_TAMPON_HACHAGE 4194304	// La taille de chacun des deux tampons de lecture du hachage (4 Mo, alignés sur une page)
+#define TAILLE_MORCEAU_ARBRE 4194304	// La taille des morceaux hashés séparément en mode arbre de Merkle (4 Mo)
+
+
+// Lecture d'un fichier dans deux tampons alternés : un thread remplit l'un pendant que l'appelant hashe l'autre
+typedef struct
+{
+	int fd;
+	unsigned char* tampons[2];
+	ssize_t tailles[2];
+	sem_t libres[2];
+	sem_t pleins[2];
+} lecture_alternee;
+
+
+// Cette fonction remplit un tampon avec la suite d'un fichier, en enchaînant les read() jusqu'à le remplir
+// Entrée : un descripteur fd, un tampon, sa taille et une position (-1 pour lire à la position courante)
+// Sortie : le nombre d'octets lus, inférieur à taille seulement à la fin du fichier, ou -1 si une lecture échoue
+ssize_t remplir_tampon(int fd, unsigned char* tampon, size_t taille, off_t position)
+{
+	size_t total = 0;
+	ssize_t lu = 1;
+	while((total < taille) && (lu > 0))
+	{
+		lu = (position < 0) ? read(fd, tampon + total, taille - total) : pread(fd, tampon + total, taille - total, position + total);
+		if((lu < 0) && (errno == EINTR))
+		{
+			lu = 1;
+			continue;
+		}
+		if(lu < 0)
+		{
+			return -1;
+		}
+		total += lu;
+	}
+	return total;
+};
+
+
+// Cette fonction est exécutée par le thread de lecture du hachage : elle remplit les deux tampons à tour de rôle
+// Entrée : un pointeur vers la lecture alternée
+// Sortie : NULL
+void* remplir_tampons(void* argument)
+{
+	lecture_alternee* lecture = argument;
+	for(int k = 0; ; k = 1-k)
+	{
+		sem_wait(&lecture->libres[k]);																		// ##
+		STATS_DEBUT(STAT_ENTREES_SORTIES);																	// #
+		lecture->tailles[k] = remplir_tampon(lecture->fd, lecture->tampons[k], TAILLE_TAMPON_HACHAGE, -1);	// #  Lecture dans le tampon libre
+		STATS_FIN(STAT_ENTREES_SORTIES);																	// #
+		sem_post(&lecture->pleins[k]);																		// ##
+		if(lecture->tailles[k] < TAILLE_TAMPON_HACHAGE)
+		{
+			return NULL;
+		}
+	}
+};
+
+
+// Cette fonction calcule le SHA-256 d'un fichier
+// Les gros fichiers sont lus dans deux tampons alignés par un thread dédié, la lecture du tampon suivant recouvre le hachage du précédent
+// Entrée : une chaîne de caractère contenant le nom du fichier et un tableau empreinte de 32 octets
+// Sortie : 0 si empreinte contient le hash du fichier, -1 si le fichier ne peut pas être ouvert ou lu jusqu'au bout
+int sha256_fichier(char* nom_fichier, unsigned char* empreinte)
+{
+	contexte_sha256 contexte;
+	struct stat informations;
+	int erreur = 0;
+	int fd = open(nom_fichier, O_RDONLY);													// ##
+	if((fd < 0) || (fstat(fd, &informations) != 0))										// #
+	{																						// #
+		if(fd >= 0)																			// #  Ouverture du fichier et taille
+		{																					// #
+			close(fd);																		// #
+		}																					// #
+		return -1;																			// #
+	}																						// ##
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	sha256_init(&contexte);
+
+	if(informations.st_size <= TAILLE_TAMPON_HACHAGE)
+	{
+		unsigned char tampon[65536];														// ##
+		ssize_t lu;																			// #
+		while((lu = remplir_tampon(fd, tampon, sizeof(tampon), -1)) > 0)					// #  Petit fichier : lecture directe sans thread
+		{																					// #
+			sha256_maj(&contexte, tampon, lu);												// #
+		}																					// #
+		erreur = (lu < 0) ? -1 : 0;															// ##
+	}
+	else
+	{
+		lecture_alternee lecture;															// ##
+		lecture.fd = fd;																	// #
+		void* tampons[2] = {NULL, NULL};													// #
+		if((posix_memalign(&tampons[0], 4096, TAILLE_TAMPON_HACHAGE) != 0) || (posix_memalign(&tampons[1], 4096, TAILLE_TAMPON_HACHAGE) != 0))	// #
+		{																					// #
+			free(tampons[0]);																// #
+			close(fd);																		// #
+			return -1;																		// #
+		}																					// #
+		for(int k = 0; k < 2; k++)															// #  Tampons alignés et lancement du thread de lecture
+		{																					// #
+			lecture.tampons[k] = tampons[k];												// #
+			sem_init(&lecture.libres[k], 0, 1);												// #
+			sem_init(&lecture.pleins[k], 0, 0);												// #
+		}																					// #
+		pthread_t lecteur;																	// #
+		pthread_create(&lecteur, NULL, remplir_tampons, &lecture);							// ##
+
+		for(int k = 0; ; k = 1-k)
+		{
+			sem_wait(&lecture.pleins[k]);													// ##
+			if(lecture.tailles[k] < 0)														// #
+			{																				// #
+				erreur = -1;																// #
+			}																				// #
+			else																			// #
+			{																				// #  Hachage d'un tampon pendant que l'autre se remplit, le thread de lecture
+				sha256_maj(&contexte, lecture.tampons[k], lecture.tailles[k]);				// #  s'arrête sur une erreur comme à la fin du fichier
+			}																				// #
+			int fin = (lecture.tailles[k] < TAILLE_TAMPON_HACHAGE);							// #
+			sem_post(&lecture.libres[k]);													// #
+			if(fin)																			// #
+			{																				// #
+				break;																		// #
+			}																				// #
+		}																					// ##
+
+		pthread_join(lecteur, NULL);														// ##
+		for(int k = 0; k < 2; k++)															// #
+		{																					// #
+			free(lecture.tampons[k]);														// #  Libération des tampons
+			sem_destroy(&lecture.libres[k]);												// #
+			sem_destroy(&lecture.pleins[k]);												// #
+		}																					// ##
+	}
+
+	sha256_final(&contexte, empreinte);
+	close(fd);
+	return erreur;
+};
+
+
+// Cette fonction hashe un fichier à partir de son nom
+// Entrée : une chaine de caractere contenant le nom du fichier à hasher
+// Sortie : 0 si on a créé un fichier de 256 bits contenant le hasher du fichier d'entrée sous le nom HASHER, -1 si le fichier ne peut pas être lu
+int SHA256(char* nom_du_fichier_a_hasher)
+{
+	mpz_t h;											// ##
+	unsigned char empreinte[32];						// #	Initialisation des variables
+	int erreur;											// ##
+
+	STATS_DEBUT(STAT_HACHAGE);							// ##
+	erreur = sha256_fichier(nom_du_fichier_a_hasher,empreinte);	// #	Calcul du hash sans passer par la commande openssl
+	STATS_FIN(STAT_HACHAGE);							// #
+	STATS_AJOUTER(STAT_HACHAGES,1);						// ##
+	if(erreur != 0)										// ##
+	{													// #	Pas de fichier HASHER si la lecture a échoué
+		return -1;										// #
+	}													// ##
+
+	mpz_init(h);										// ##
+	mpz_import(h,32,1,1,1,0,empreinte);					// #
+	FILE* fichier_hash = fopen(travail.hasher,"wb+");	// #
+	if(fichier_hash != NULL)							// #	stockage du résultat dans le fichier HASHER
+	{													// #
+		mpz_out_raw(fichier_hash,h);					// #
+		fclose(fichier_hash);							// #
+	}													// ##
+
+	mpz_clear(h);										// ##	Libération de l'espace
+	return (fichier_hash != NULL) ? 0 : -1;
+};
+
+
+// Hachage en parallèle des feuilles d'un arbre de Merkle : chaque worker prend le morceau suivant du fichier
+typedef struct
+{
+	int fd;
+	unsigned long taille_fichier;
+	unsigned long nb_feuilles;
+	unsigned long suivante;
+	unsigned char (*feuilles)[32];
+	int erreur;
+} hachage_arbre;
+
+
+// Cette fonction hashe un morceau de fichier comme feuille d'un arbre de Merkle : SHA-256(0x00 || morceau)
+// Entrée : un tampon morceau, sa taille et un tableau feuille de 32 octets
+// Sortie : vide mais feuille contient le hash du morceau
+void hacher_feuille(unsigned char* morceau, size_t taille, unsigned char* feuille)
+{
+	contexte_sha256 contexte;
+	unsigned char prefixe = 0x00;
+	sha256_init(&contexte);
+	sha256_maj(&contexte, &prefixe, 1);
+	sha256_maj(&contexte, morceau, taille);
+	sha256_final(&contexte, feuille);
+};
+
+
+// Cette fonction est exécutée par chaque worker du hachage en arbre : elle lit avec pread() et hashe les morceaux qu'elle réserve
+// Entrée : un pointeur vers le hachage partagé
+// Sortie : NULL
+void* hacher_feuilles(void* argument)
+{
+	hachage_arbre* hachage = argument;
+	void* morceau = NULL;
+	if(posix_memalign(&morceau, 4096, TAILLE_MORCEAU_ARBRE) != 0)
+	{
+		hachage->erreur = 1;
+		return NULL;
+	}
+
+	while(1)
+	{
+		unsigned long i = __atomic_fetch_add(&hachage->suivante, 1, __ATOMIC_RELAXED);	// #  Réservation du morceau suivant
+		if(i >= hachage->nb_feuilles)
+		{
+			break;
+		}
+		ssize_t lu = remplir_tampon(hachage->fd, morceau, TAILLE_MORCEAU_ARBRE, (off_t) i * TAILLE_MORCEAU_ARBRE);	// ##
+		if(lu < 0)																					// #
+		{																							// #
+			hachage->erreur = 1;																	// #  Lecture et hachage du morceau, une erreur de lecture
+			break;																					// #  fait échouer toute la racine
+		}																							// #
+		hacher_feuille(morceau, lu, hachage->feuilles[i]);											// ##
+	}
+
+	free(morceau);
+	return NULL;
+};
+
+
+// Cette fonction réduit des feuilles en racine de Merkle : chaque noeud vaut SHA-256(0x01 || gauche || droite) et un noeud sans frère remonte tel quel
+// Entrée : un tableau de nb_feuilles hashs de 32 octets (écrasé) et un tableau racine de 32 octets
+// Sortie : vide mais racine contient la racine de l'arbre
+void reduire_arbre(unsigned char (*feuilles)[32], unsigned long nb_feuilles, unsigned char* racine)
+{
+	contexte_sha256 contexte;
+	unsigned char prefixe = 0x01;
+	while(nb_feuilles > 1)
+	{
+		for(unsigned long j = 0; j < nb_feuilles/2; j++)						// ##
+		{																		// #
+			sha256_init(&contexte);												// #
+			sha256_maj(&contexte, &prefixe, 1);									// #
+			sha256_maj(&contexte, feuilles[2*j], 32);							// #  Calcul d'un niveau de l'arbre
+			sha256_maj(&contexte, feuilles[2*j+1], 32);							// #
+			sha256_final(&contexte, feuilles[j]);								// #
+		}																		// #
+		if(nb_feuilles % 2 == 1)												// #
+		{																		// #
+			memcpy(feuilles[nb_feuilles/2], feuilles[nb_feuilles-1], 32);		// #
+		}																		// #
+		nb_feuilles = (nb_feuilles + 1) / 2;									// ##
+	}
+	memcpy(racine, feuilles[0], 32);
+};
+
+
+// Cette fonction reprend les feuilles d'un manifeste d'arbre pour ne rehasher que la fin d'un fichier auquel on a ajouté des données
+// Le manifeste commence par une ligne "ARBRE taille_morceau taille_fichier nb_feuilles dev inode mtime_s mtime_ns racine" suivie des feuilles brutes
+// Les feuilles ne sont reprises que pour le même fichier (même dev et inode) et une racine cohérente avec les feuilles : à taille égale la date
+// de modification doit aussi être la même, et un fichier qui a grandi ne reprend ses anciens morceaux complets que si l'appelant garantit
+// qu'il n'a été modifié que par ajout en fin de fichier, le dernier morceau repris étant de plus rehashé et comparé au manifeste
+// Entrée : une chaîne de caractère nom_manifeste, un descripteur fd et les informations stat() du fichier, un tableau de feuilles et un entier ajout_seul
+// Sortie : le nombre de feuilles reprises au début du tableau, 0 si le manifeste est absent ou ne correspond pas
+unsigned long reprendre_manifeste(char* nom_manifeste, int fd, struct stat* informations, unsigned char (*feuilles)[32], int ajout_seul)
+{
+	unsigned long taille_morceau, ancienne_taille, nb_anciennes, dev, inode;
+	long secondes, nanosecondes;
+	char racine_hexa[65];
+	unsigned long reprises = 0;
+	unsigned long taille_fichier = informations->st_size;
+	FILE* manifeste = fopen(nom_manifeste,"rb");
+	if(manifeste == NULL)
+	{
+		return 0;
+	}
+
+	if((fscanf(manifeste, "ARBRE %lu %lu %lu %lu %lu %ld %ld %64s", &taille_morceau, &ancienne_taille, &nb_anciennes, &dev, &inode, &secondes, &nanosecondes, racine_hexa) == 8)	// ##
+		&& (fgetc(manifeste) == '\n') && (taille_morceau == TAILLE_MORCEAU_ARBRE) && (nb_anciennes == (ancienne_taille + TAILLE_MORCEAU_ARBRE - 1) / TAILLE_MORCEAU_ARBRE + (ancienne_taille == 0))	// #
+		&& (dev == (unsigned long) informations->st_dev) && (inode == (unsigned long) informations->st_ino)							// #  Même fichier, ancienne version
+		&& (((ancienne_taille < taille_fichier) && (ajout_seul == 1)) || ((ancienne_taille == taille_fichier) && (secondes == informations->st_mtim.tv_sec) && (nanosecondes == informations->st_mtim.tv_nsec))))	// #  intacte ou complétée à la fin
+	{																																	// ##
+		unsigned char (*anciennes)[32] = malloc(nb_anciennes * 32);																		// ##
+		unsigned char racine[32];																										// #
+		char hexa[65];																													// #
+		if((anciennes != NULL) && (fread(anciennes, 32, nb_anciennes, manifeste) == nb_anciennes))										// #
+		{																																// #
+			reprises = (ancienne_taille == taille_fichier) ? nb_anciennes : ancienne_taille / TAILLE_MORCEAU_ARBRE;						// #
+			memcpy(feuilles, anciennes, reprises * 32);																					// #  Reprise des feuilles si elles redonnent la racine enregistrée
+			reduire_arbre(anciennes, nb_anciennes, racine);																				// #
+			for(int i = 0; i < 32; i++)																									// #
+			{																															// #
+				sprintf(hexa + 2*i, "%02x", racine[i]);																					// #
+			}																															// #
+			if(strcmp(hexa, racine_hexa) != 0)																							// #
+			{																															// #
+				reprises = 0;																											// #
+			}																															// #
+		}																																// #
+		free(anciennes);																												// ##
+
+		void* morceau = NULL;																											// ##
+		if((reprises > 0) && (ancienne_taille < taille_fichier))																		// #
+		{																																// #
+			unsigned char feuille[32];																									// #
+			ssize_t lu = (posix_memalign(&morceau, 4096, TAILLE_MORCEAU_ARBRE) == 0) ? remplir_tampon(fd, morceau, TAILLE_MORCEAU_ARBRE, (off_t) (reprises-1) * TAILLE_MORCEAU_ARBRE) : -1;	// #
+			if(lu == TAILLE_MORCEAU_ARBRE)																								// #  Le dernier morceau repris doit être inchangé
+			{																															// #
+				hacher_feuille(morceau, lu, feuille);																					// #
+			}																															// #
+			if((lu != TAILLE_MORCEAU_ARBRE) || (memcmp(feuille, feuilles[reprises-1], 32) != 0))										// #
+			{																															// #
+				reprises = 0;																											// #
+			}																															// #
+		}																																// #
+		free(morceau);																													// ##
+	}
+
+	fclose(manifeste);
+	return reprises;
+};
+
+
+// Cette fonction écrit le manifeste d'arbre d'un fichier
+// Entrée : une chaîne de caractère nom_manifeste, les informations stat() du fichier, un tableau de feuilles, leur nombre et la racine qu'elles donnent
+// Sortie : vide, un message est affiché si le manifeste ne peut pas être écrit (la signature n'en dépend pas)
+void ecrire_manifeste(char* nom_manifeste, struct stat* informations, unsigned char (*feuilles)[32], unsigned long nb_feuilles, unsigned char* racine)
+{
+	FILE* manifeste = fopen(nom_manifeste,"wb");
+	if(manifeste == NULL)
+	{
+		printf("\nImpossible d'écrire le manifeste %s, la prochaine signature hashera tout le fichier.\n", nom_manifeste);
+		return;
+	}
+	fprintf(manifeste, "ARBRE %lu %lu %lu %lu %lu %ld %ld ", (unsigned long) TAILLE_MORCEAU_ARBRE, (unsigned long) informations->st_size, nb_feuilles,
+		(unsigned long) informations->st_dev, (unsigned long) informations->st_ino, (long) informations->st_mtim.tv_sec, (long) informations->st_mtim.tv_nsec);
+	for(int i = 0; i < 32; i++)
+	{
+		fprintf(manifeste, "%02x", racine[i]);
+	}
+	fputc('\n', manifeste);
+	fwrite(feuilles, 32, nb_feuilles, manifeste);
+	fclose(manifeste);
+};
+
+
+// Cette fonction calcule la racine de l'arbre de Merkle d'un fichier découpé en morceaux de TAILLE_MORCEAU_ARBRE octets, hashés sur tous les coeurs
+// Avec un manifeste, les morceaux déjà hashés lors de la signature précédente sont repris et le manifeste est mis à jour
+// Entrée : une chaîne de caractère contenant le nom du fichier, un tableau racine de 32 octets, le nom du manifeste (NULL pour tout hasher sans manifeste)
+// et un entier ajout_seul valant 1 si le fichier n'a été modifié que par ajout en fin depuis le manifeste
+// Sortie : 0 si racine contient la racine de l'arbre, -1 si le fichier ne peut pas être ouvert ou lu jusqu'au bout
+int racine_merkle(char* nom_fichier, unsigned char* racine, char* nom_manifeste, int ajout_seul)
+{
+	struct stat informations;																	// ##
+	hachage_arbre hachage;																		// #
+	hachage.fd = open(nom_fichier, O_RDONLY);													// #
+	if((hachage.fd < 0) || (fstat(hachage.fd, &informations) != 0))								// #
+	{																							// #
+		if(hachage.fd >= 0)																		// #
+		{																						// #
+			close(hachage.fd);																	// #
+		}																						// #
+		return -1;																				// #
+	}																							// #  Découpage du fichier, un fichier vide a une feuille vide
+	hachage.erreur = 0;																			// #
+	hachage.taille_fichier = informations.st_size;												// #
+	hachage.nb_feuilles = (hachage.taille_fichier + TAILLE_MORCEAU_ARBRE - 1) / TAILLE_MORCEAU_ARBRE;	// #
+	if(hachage.nb_feuilles == 0)																// #
+	{																							// #
+		hachage.nb_feuilles = 1;																// #
+	}																							// #
+	hachage.suivante = 0;																		// #
+	hachage.feuilles = malloc(hachage.nb_feuilles * 32);										// ##
+
+	if(nom_manifeste != NULL)																	// ##
+	{																							// #
+		hachage.suivante = reprendre_manifeste(nom_manifeste, hachage.fd, &informations, hachage.feuilles, ajout_seul);	// #  Reprise des feuilles inchangées
+		printf("\n%lu morceaux sur %lu repris du manifeste %s.\n", hachage.suivante, hachage.nb_feuilles, nom_manifeste);	// #
+	}																							// ##
+
+	unsigned long nb_workers = sysconf(_SC_NPROCESSORS_ONLN);									// ##
+	if(nb_workers > hachage.nb_feuilles)														// #
+	{																							// #
+		nb_workers = hachage.nb_feuilles;														// #
+	}																							// #
+	pthread_t* workers = malloc(nb_workers * sizeof(pthread_t));								// #
+	for(unsigned long i = 0; i < nb_workers; i++)												// #  Hachage des feuilles restantes en parallèle
+	{																							// #
+		pthread_create(&workers[i], NULL, hacher_feuilles, &hachage);							// #
+	}																							// #
+	for(unsigned long i = 0; i < nb_workers; i++)												// #
+	{																							// #
+		pthread_join(workers[i], NULL);															// #
+	}																							// #
+	free(workers);																				// ##
+	STATS_AJOUTER(STAT_HACHAGES,hachage.nb_feuilles);
+
+	if(hachage.erreur != 0)																		// ##
+	{																							// #
+		free(hachage.feuilles);																	// #  Lecture incomplète : ni racine ni mise à jour du manifeste
+		close(hachage.fd);																		// #
+		return -1;																				// #
+	}																							// ##
+
+	unsigned char (*copie)[32] = NULL;															// ##
+	if(nom_manifeste != NULL)																	// #
+	{																							// #  Copie des feuilles pour le manifeste, la réduction les écrase
+		copie = malloc(hachage.nb_feuilles * 32);												// #
+		memcpy(copie, hachage.feuilles, hachage.nb_feuilles * 32);								// #
+	}																							// ##
+
+	reduire_arbre(hachage.feuilles, hachage.nb_feuilles, racine);								// #  Calcul de la racine
+
+	if(nom_manifeste != NULL)																	// ##
+	{																							// #
+		ecrire_manifeste(nom_manifeste, &informations, copie, hachage.nb_feuilles, racine);		// #  Mise à jour du manifeste avec la racine obtenue
+		free(copie);																			// #
+	}																							// ##
+
+	free(hachage.feuilles);
+	close(hachage.fd);
+	return 0;
+};
+
+
+// Cette fonction hashe un fichier en arbre de Merkle et stocke comme SHA256() stocke le hash la valeur SHA-256("ARBRE" || taille_morceau || racine)
+// L'étiquette et la taille des morceaux sur 4 octets big-endian distinguent une signature en arbre d'une signature du hash simple d'un autre fichier
+// Entrée : une chaine de caractere contenant le nom du fichier à hasher, le nom du manifeste d'arbre (NULL pour ne pas en utiliser) et un entier ajout_seul comme pour racine_merkle()
+// Sortie : 0 si on a stocké la valeur signée dans le fichier HASHER, -1 si le fichier ne peut pas être lu
+int SHA256_arbre(char* nom_du_fichier_a_hasher, char* nom_manifeste, int ajout_seul)
+{
+	mpz_t h;											// ##
+	unsigned char racine[32];							// #
+	unsigned char empreinte[32];						// #	Initialisation des variables
+	unsigned char etiquette[9] = {'A','R','B','R','E'};	// #
+	contexte_sha256 contexte;							// #
+	int erreur;											// ##
+
+	STATS_DEBUT(STAT_HACHAGE);							// ##
+	erreur = racine_merkle(nom_du_fichier_a_hasher,racine,nom_manifeste,ajout_seul);	// #	Calcul de la racine sur tous les coeurs
+	STATS_FIN(STAT_HACHAGE);							// ##
+	if(erreur != 0)										// ##
+	{													// #	Pas de fichier HASHER si la lecture a échoué
+		return -1;										// #
+	}													// ##
+
+	for(int i = 0; i < 4; i++)							// ##
+	{													// #
+		etiquette[5+i] = (TAILLE_MORCEAU_ARBRE >> (8*(3-i))) & 0xff;	// #
+	}													// #	Liaison du mode arbre et de la taille des morceaux à la racine
+	sha256_init(&contexte);								// #
+	sha256_maj(&contexte, etiquette, 9);				// #
+	sha256_maj(&contexte, racine, 32);					// #
+	sha256_final(&contexte, empreinte);					// ##
+
+	mpz_init(h);										// ##
+	mpz_import(h,32,1,1,1,0,empreinte);					// #
+	FILE* fichier_hash = fopen(travail.hasher,"wb+");	// #
+	if(fichier_hash != NULL)							// #	stockage du résultat dans le fichier HASHER
+	{													// #
+		mpz_out_raw(fichier_hash,h);					// #
+		fclose(fichier_hash);							// #
+	}													// ##
+
+	mpz_clear(h);										// ##	Libération de l'espace
+	return (fichier_hash != NULL) ? 0 : -1;
+};
+
+
+// Masque produit par MGF1 en hexadécimal, gardé en mémoire par chaque thread à la place de l'ancien fichier MGF1
+typedef struct
+{
+	char* hexa;
+	size_t taille;
+	size_t capacite;
+} masque_mgf1;
+
+_Thread_local masque_mgf1 masque = {NULL, 0, 0};
+
+
+// Cette fonction ouvre le masque MGF1 du thread en lecture, comme l'était le fichier MGF1
+// Entrée : vide
+// Sortie : un flux sur le masque
+FILE* ouvrir_masque()
+{
+	return fmemopen(masque.hexa, masque.taille, "r");
+};
+
+
+// Cette fonction efface le masque MGF1 du thread, comme la suppression du fichier MGF1
+// Entrée : vide
+// Sortie : vide
+void vider_masque()
+{
+	free(masque.hexa);
+	masque.hexa = NULL;
+	masque.taille = 0;
+	masque.capacite = 0;
+};
+
+
+// Cette fonction permet de hasher une chaîne de caractère et la stocke dans le masque MGF1
+// Entrée : une chaîne de caractère à hasher
+// Sortie : vide mais ajoute le hasher de la chaine de caractère à la fin du masque MGF1
+void sha256sum(char* txt)
+{
+	mpz_t h;												// ##
+	mpz_init(h);											// #  Initialisation des variables
+	unsigned char empreinte[32];							// #
+	contexte_sha256 contexte;								// ##
+
+	STATS_DEBUT(STAT_HACHAGE);								// ##
+	sha256_init(&contexte);									// #
+	sha256_maj(&contexte,(unsigned char*) txt,strlen(txt));	// #  Calcul du hash de txt sans lancer echo -n "txt" | sha256sum
+	sha256_final(&contexte,empreinte);						// #
+	STATS_FIN(STAT_HACHAGE);								// #
+	STATS_AJOUTER(STAT_HACHAGES,1);							// ##
+
+	if(masque.taille + 65 > masque.capacite)				// ##
+	{														// #
+		masque.capacite = 2*masque.capacite + 65;			// #  Agrandissement du masque
+		masque.hexa = realloc(masque.hexa,masque.capacite);	// #
+	}														// ##
+
+	mpz_import(h,32,1,1,1,0,empreinte);						// ##
+	masque.taille += gmp_snprintf(masque.hexa + masque.taille, 65, "%Zx",h );	// #  Stockage du résultat à la fin du masque MGF1
+	mpz_clear(h);											// ##
+}
+
+
+// Cette fonction convertit un caractère en hexadécimal en un entier en décimal. 
+// Entrée : un caractère c écrit en hexadécimal
+// Sortie : un entier correspondant à la valeur en décimal de c
+int hex_to_int(char c)
+{
+	if(c >= '0' && c <= '9')						// ##	
+	{												// #
+		return(c - '0');							// #
+	}												// #  Conversion de c en décimal 
+	if(c >= 'a' && c <= 'f')						// #
+	{												// #
+		return(c - 'a' + 10);						// #
+	}												// ##
+}
+
+
+// Cette fonction convertit un entier en décimal en un caractère en hexadécimal. 
+// Entrée : un entier a compris entre 0 et 15
+// Sortie : un caractère correspondant à la valeur en hexadécimal de a
+char int_to_hex(int a)
+{
+	if(a < 10)										// ##
+	{												// #
+		return(a + '0');							// #
+	}												// #  Conversion de a en hexadécimal
+	else											// #
+	{												// #
+		return(a + 'a' - 10);						// #
+	}												// ##
+}
+
+
+// Cette fonction correspond à la fonction utiliser dans MGF1
+// Entrée : un mpz_t counter qui correspond à une seed et un pointeur sur un caractère pour récupérer le résultat
+// Sortie : vide mais le résultat est stocké dans la chaine resultat
+void I2OSP(mpz_t counter,char *resultat)
+{
+	mpz_t div;											// ##
+	mpz_t puissance;									// #
+	mpz_t save;											// #
+	mpz_inits(div,puissance,save,NULL);					// #  Initialisation des variables
+	ui_expo_ui(puissance,16,7);							// #
+	mpz_set(save,counter);								// #
+	int i = 0;											// #
+	int j;												// ##
+
+	while(mpz_cmp_ui(puissance,0) != 0)					// ##
+	{													// #
+		mpz_fdiv_q(div,save,puissance);					// #
+		j = mpz_get_ui(div);							// #
+		*(resultat+i) = int_to_hex(j);					// #
+														// #
+		if(mpz_cmp_ui(div,0) != 0)						// #
+		{												// #  Algorithme I2OSP
+			mpz_mul(puissance,puissance,div);			// #
+			mpz_sub(save,save,puissance);				// #
+			mpz_divexact(puissance,puissance,div);		// #
+		}												// #
+		mpz_divexact_ui(puissance,puissance,16);		// #
+		i = i+1;										// #
+	}													// ##
+
+	mpz_clears(div,puissance,save,NULL);
+}
+
+
+// Cette fonction correspond à la fonction MGF1 utilisée pour OAEP
+// Entrée : un mpz_t correspondant à la taille de la sortie souhaitée
+// Sortie : vide mais la sortie de l'algorithme est stockée dans le masque MGF1 du thread
+void MGF1(mpz_t seed, mpz_t l)
+{
+	mpz_t a;											// ##
+	mpz_init(a);										// #  Initialisation des variables
+	ui_expo_ui(a,2,37);									// ##
+
+	if(mpz_cmp(l,a) > 0)								// ##
+	{													// #  Vérification de la taille l
+		printf("\nMasque trop long\n");					// #
+	}													// ##
+	else
+	{
+		mpz_t counter_max;								// ##
+		mpz_t i;										// #
+		mpz_inits(counter_max,i,NULL);					// #
+		mpz_fdiv_q_ui(counter_max,l,32);				// #
+		mpz_add_ui(counter_max,counter_max,1);			// #
+														// #
+		char chaine[25] = { 0 };						// #
+		char * pointeur;								// #
+		mpz_get_str(chaine,16,seed);					// #
+		pointeur = &chaine[16];							// #
+														// #  Algorithme MGF1
+		mpz_set_ui(i,0);								// #
+		while(mpz_cmp_ui(counter_max,0) > 0)			// #
+		{												// #
+			I2OSP(i,pointeur);							// #
+			sha256sum(chaine);							// #
+			mpz_sub_ui(counter_max,counter_max,1);		// #
+			mpz_add_ui(i,i,1);							// #
+		}												// ##
+		mpz_clears(counter_max,NULL);
+	}
+	mpz_clear(a);
+}
+
+
+// Cette fonction permet d'effectuer le XOR entre 2 valeurs hexadécimales et renvoie le résultat en hexadécimal.
+// Entrée : deux caractères en hexadécimal a et b a xorer entre eux
+// Sortie : un caractère en hexadécimal c = XOR(a,b)
+char XOR(char a,char b)
+{
+	char c;													// ##
+	int int_a = 0;											// #
+	int int_b = 0;											// #
+	int int_c = 0;											// #  Déclaration et initialisation des variables
+	int div_a;												// #
+	int div_b;												// #
+	int puissance = 8;										// ##
+
+	int_a = hex_to_int(a);									// #  Conversion de a et b en décimal
+	int_b = hex_to_int(b);									// #
+
+	while(puissance != 0)									// ##
+	{														// #
+		div_a = int_a / puissance;							// #
+		div_b = int_b / puissance;							// #
+		int_c = int_c + (div_a^div_b) * puissance;			// #
+															// #
+		if(div_a != 0)										// #
+		{													// #
+			puissance = puissance * div_a;					// #
+			int_a = int_a - puissance;						// #
+			puissance = puissance / div_a;					// #  Calcul du XOR entre a et b
+		}													// #
+															// #
+		if(div_b != 0)										// #
+		{													// #
+			puissance = puissance * div_b;					// #
+			int_b = int_b - puissance;						// #
+			puissance = puissance / div_b;					// #
+		}													// #
+															// #
+		puissance = puissance / 2;							// #
+	}														// ##
+
+	c = int_to_hex(int_c);									// #  Conversion de c en hexadécimal
+
+	return(c);
+}
+
+
+// Cette fonction applique la padding OAEP à un sous-message et l'écrit dans un flux
+// Entrée : un entier length_n correspondant à la taille du sous-message sans le padding, un entier dernier nous indiquant si nous sommes au dernier bloc, un flux correspondant au fichier à chiffrer et un flux OAE destination
+// Sortie : vide mais un sous-message paddé est écrit en hexadécimal dans OAE
+void OAEP(int length_n,int dernier, FILE* fichier, FILE* OAE)
+{
+	mpz_t l;															// ##
+	mpz_t n;															// #
+	mpz_t m;															// #
+	mpz_t puissance;													// #
+	mpz_t div;															// #
+	mpz_init_set_ui(l,length_n);										// #
+	mpz_init_set_ui(n,0);												// #
+	mpz_init_set_ui(m,0);												// #
+	mpz_init_set_ui(puissance,0);										// #  Déclaration des variables
+	mpz_init_set_ui(div,0);												// #
+	char c1;															// #
+	char c2;															// #
+	char c3;															// #
+	char chaine[17] = { 0 };											// #
+	int A;																// #
+	int h1;																// #
+	int h2;																// ##
+
+	if (dernier==0)														// ##
+	{																	// #
+		unsigned char graine[8];										// #
+		do																// #
+		{																// #  Test si nous sommes au dernier bloc à chiffrer :
+			alea_octets(graine,8);										// #
+		}while(graine[0] < 16);											// #  	- si non on tire 8 octets aléatoires dans m (16 chiffres hexadécimaux)
+		mpz_import(m,8,1,1,1,0,graine);									// #
+	}																	// #	- si oui on affecte la taille du dernier bloc dans m
+	else																// #
+	{																	// #
+		mpz_set_ui(m,dernier);											// #
+	}																	// ##
+
+	MGF1(m,l);															// #  Passage de m dans MGF1 avec l pour taille de sortie
+
+	FILE* MGF = ouvrir_masque();										// #  Ouverture du masque MGF1
+
+	for(int a=0;a<length_n;a++)											// #  Boucle pour créer X (sachant que le bloc créé à la fin est de la forme X||Y)
+	{
+		if(!feof(fichier))												// ##
+		{																// #
+			A = fgetc(fichier);											// #
+		}																// #
+		else															// #  Lecture d'un octet A du fichier à chiffrer et initialisation de h1 et h2 tel que A = h1*16 + h2
+		{																// #
+			A = 0;														// #
+		}																// #
+		h1 = A/16;														// #
+		h2 = A - (h1*16);												// ##
+
+		c1 = fgetc(MGF);												// #  Lecture d'une valeur hexa du masque MGF1
+
+		c2 = int_to_hex(h1);											// #  XOR entre le message et MGF1 qui donne les octets de X
+		c3 = XOR(c1,c2);												// #
+
+		if(a<8)															// ##
+		{																// #
+			mpz_mul_ui(n,n,16);											// #  Stockage des 8 premiers octets de X (1)
+			A = hex_to_int(c3);											// #
+    		mpz_add_ui(n,n,A);											// #
+		}																// ##
+
+		fprintf(OAE,"%c",c3);											// #  Ecriture dans le fichier OAEP
+
+		c1 = fgetc(MGF);												// #  Lecture d'une valeur hexa du masque MGF1
+		
+		c2 = int_to_hex(h2);											// #  XOR entre le message et MGF1 qui donne les octets de X
+		c3 = XOR(c1,c2);												// #
+
+		if (a<8)														// ##
+		{																// #
+			mpz_mul_ui(n,n,16);											// #  Stockage des 8 premiers octets de X (2)
+    		A = hex_to_int(c3);											// #
+    		mpz_add_ui(n,n,A);											// #
+		}																// ##
+
+		fprintf(OAE,"%c",c3);											// #  Ecriture dans le fichier OAEP
+	}
+
+	fclose(MGF);														// #  Fermeture et effacement du masque MGF1
+	vider_masque();														// #
+
+	mpz_set_ui(l,8);													// ##
+	MGF1(n,l);															// #  Passage de X dans MGF1 avec 8 pour taille de sortie et ouverture de MGF1
+	MGF = ouvrir_masque();												// ##
+
+	if(dernier == 0)													// ##
+	{																	// #
+		mpz_get_str(chaine,16,m);										// #
+	}																	// #
+	else																// #
+	{																	// #
+		for (int j=15;j>=0;j--)											// #
+		{																// #
+			ui_expo_ui(puissance,16,j);									// #  Initialisation de chaine qui va contenir le padding
+			mpz_fdiv_q(div,m,puissance);								// #
+																		// #
+			A = mpz_get_ui(div);										// #
+			chaine[15-j] = int_to_hex(A);								// #
+																		// #
+			mpz_mul(puissance,puissance,div);							// #
+			mpz_sub(m,m,puissance);										// #
+		}																// #
+	}																	// ##
+
+ 	for(int b=0;b<16;b++)												// ##
+	{																	// #
+		c1 = chaine[b];													// #
+		c2 = fgetc(MGF);												// #  Calcul et écriture de Y = XOR(MGF1(X),padding) dans le flux OAE à la suite de X
+		c3 = XOR(c1,c2);												// #
+		fprintf(OAE,"%c",c3);											// #
+	}																	// ##
+
+	fclose(MGF);														// #  Fermeture et effacement du masque MGF1
+	vider_masque();												// #
+	
+	mpz_clears(l,n,m,puissance,div,NULL);
+}
+
+
+// Cette fonction supprime le padding d'un bloc et écrit le résultat à la suite du fichier clair
+// Entrée : un entier length_n correspondant à la taille d'un bloc, un entier dernier nous indiquant si nous sommes au dernier bloc, un mpz correspondant à un bloc et un flux correspondant au fichier destination
+// Sortie : vide mais le sous-message est écrit à la fin du fichier clair
+void inv_OAEP(int length_n, int dernier, mpz_t chiffre,FILE* clair)
+{
+	mpz_t puissance;									// ##
+	mpz_t z_X;											// #
+	mpz_t div;											// #
+	mpz_t temp;											// #
+	mpz_t r;											// #
+	mpz_t l;											// #
+	mpz_inits(puissance,z_X,div,temp,r,l,NULL);			// #
+	mpz_set_ui(r,0);									// #
+	mpz_set_ui(div,0);									// #
+	mpz_set_ui(temp,0);									// #
+	mpz_set_ui(l,8);									// #  Déclaration des variables
+	char MGF1_X;										// #
+	char Y;												// #
+	char c1;											// #
+	char c2;											// #
+	char c3;											// #
+	unsigned int lettre = 0;							// #
+	int A;												// #
+	int B;												// #
+	int int_r;											// #
+	int rtemp;											// ##
+	
+	ui_expo_ui(puissance,256,(length_n-8));				// #  Récupération des 8 premiers octets de X
+	mpz_fdiv_q(z_X,chiffre,puissance);					// #
+	
+	MGF1(z_X,l);										// #  Passage des 8 premiers octets de X dans MGF1 avec 8 pour taille de sortie et ouverture de MGF1
+	FILE* MGF = ouvrir_masque();						// #
+
+	ui_expo_ui(puissance,256,8);						// ##
+	mpz_fdiv_q(div,chiffre,puissance);					// #  Récupération de X 
+	mpz_set(z_X,div);									// ##
+
+	mpz_mul(puissance,puissance,div);					// #  Récupération de Y
+	mpz_sub(temp,chiffre,puissance);					// #
+
+	for(int i=15;i>=0;i--)								// #  Boucle pour calculer XOR(MGF1(X),Y)
+	{
+		MGF1_X = fgetc(MGF);							// #  Lecture d'une valeur hexadécimale de MGF1(X)
+
+		ui_expo_ui(puissance,16,i);						// ##
+		mpz_fdiv_q(div,temp,puissance);					// #  Récupération d'une valeur hexadécimale de Y
+		int_r = mpz_get_ui(div);						// #
+		Y = int_to_hex(int_r);							// ##
+		
+		c1 = XOR(MGF1_X,Y);								// #  XOR entre MGF1(X) et Y
+
+		A = hex_to_int(c1);								// ##
+		mpz_mul_ui(r,r,16);								// #  stockage du résultat dans r
+		mpz_add_ui(r,r,A);								// ##
+
+		mpz_mul(puissance,puissance,div);				// #  Décrémentation de Y
+		mpz_sub(temp,temp,puissance);					// #
+	}
+
+	fclose(MGF);										// #  Fermeture et effacement du masque MGF1
+	vider_masque();										// #
+
+	mpz_set_ui(l,(length_n - 8));						// ##
+	MGF1(r,l);											// #  Passage du padding (r) dans MGF1 avec la taille d'un bloc moins la taille du padding pour taille de sortie et ouverture de MGF1
+	MGF = ouvrir_masque();								// ##
+
+	if(dernier != 0)									// ##
+	{													// #  Si on est au dernier bloc on récupère la taille du dernier sous-message
+		rtemp = mpz_get_ui(r);							// #
+	}													// ##
+
+	ui_expo_ui(puissance,16,((2*(length_n-8))-1));		// #  Initialisation de puissance
+
+	for(int j=0;j<(length_n - 8);j++)					// #  Boucle pour le dernier XOR entre X et MGF1(r)
+	{
+		mpz_fdiv_q(div,z_X,puissance);					// ##
+		A = mpz_get_ui(div);							// #  Récupération d'une valeur hexadécimale de X
+		c2 = int_to_hex(A);								// ##
+
+		c1 = fgetc(MGF);								// #  Récupération d'une valeur hexadécimale de MGF1(r)
+
+		c3 = XOR(c1,c2);								// #  XOR entre X et MGF1(r)
+
+		if(mpz_cmp_ui(div,0)!=0)						// ##
+		{												// #
+			mpz_mul(puissance,puissance,div);			// #
+			mpz_sub(z_X,z_X,puissance);					// #  Décrémentation de puissance et de X
+			mpz_divexact(puissance,puissance,div);		// #
+		}												// #
+		mpz_divexact_ui(puissance,puissance,16);		// ##
+		
+		B = hex_to_int(c3);								// #  Stockage du résultat dans lettre
+		lettre = B * 16;								// #
+		
+		mpz_fdiv_q(div,z_X,puissance);					// ##
+		A = mpz_get_ui(div);							// #  Récupération d'une valeur hexadécimale de X
+		c2 = int_to_hex(A);								// ##
+		
+		c1 = fgetc(MGF);								// #  Récupération d'une valeur hexadécimale de MGF1(r)
+
+		c3 = XOR(c1,c2);								// #  XOR entre X et MGF1(r)
+
+		if(mpz_cmp_ui(div,0)!=0)						// ##
+		{												// #
+			mpz_mul(puissance,puissance,div);			// #
+			mpz_sub(z_X,z_X,puissance);					// #  Décrémentation de puissance et de X
+			mpz_divexact(puissance,puissance,div);		// #
+		}												// #
+		mpz_divexact_ui(puissance,puissance,16);		// ##
+
+		B = hex_to_int(c3);								// #  Stockage du résultat dans lettre
+		lettre = lettre + B;							// #
+
+		if (dernier==0)									// ##
+		{												// #
+			fputc(lettre,clair);						// #
+		}												// #
+		else											// #
+		{												// #  Ecriture d'un octet du résultat dans le fichier clair
+			if (j < rtemp)								// #
+			{											// #
+				fputc(lettre,clair);					// #
+			}											// #
+		}												// #
+		lettre = 0;										// ##
+	}
+
+	mpz_clears(puissance,z_X,div,temp,r,l,NULL);		// ##
+	fclose(MGF);										// #  Fermeture et effacement du masque MGF1
+	vider_masque();										// ##
+}
+
+
+// Cette fonction applique le padding OAEP à tout un fichier, bloc par bloc
+// Entrée : un flux clair correspondant au fichier à chiffrer, un entier taille_n correspondant à la taille d'un bloc et un entier taille_fichier
+// Sortie : vide mais les blocs paddés sont ajoutés à la suite du fichier OAEP
+void padding_fichier(FILE* clair, int taille_n, unsigned long taille_fichier)
+{
+    int dernier = 0;																	// ##
+    int taille_padding = 8;																// #
+    int length_n = taille_n - taille_padding;											// #  On initialise les variables pour le padding
+    unsigned long i = 0;																// ##
+    FILE* OAE = fopen(travail.oaep,"a");												// #  Ouverture du fichier OAEP
+    
+    while(i < taille_fichier)															// #  Boucle pour lire tout le fichier
+    {
+    	if (taille_fichier-i<taille_n)													// ##
+   		{																				// #  Modification pour le dernier bloc
+    		dernier = taille_fichier - i;												// #
+    	}																				// ##
+    	
+    	OAEP(length_n,dernier,clair,OAE);												// #  Padding
+    	i = i + length_n;
+    }
+    fclose(OAE);
+};
+
+
+// Cette fonction lit un bloc paddé écrit en hexadécimal dans le fichier OAEP
+// Entrée : un flux OAE correspondant au fichier OAEP, un mpz m et un entier taille_n correspondant à la taille d'un bloc
+// Sortie : vide mais m contient la valeur du bloc lu
+void lire_bloc_oaep(FILE* OAE, mpz_t m, int taille_n)
+{
+	char c;
+	mpz_set_ui(m,0);																	// ##
+	for (int j = 0; j < 2*taille_n; j++)												// #
+	{																					// #
+		c = fgetc(OAE);																	// #
+		mpz_mul_ui(m,m,16);																// #
+		if(c >= '0' && c <= '9')														// #
+		{																				// #  Lecture d'un bloc
+			mpz_add_ui(m,m,c - '0');													// #
+		}																				// #
+		if(c >= 'a' && c <= 'f')														// #
+		{																				// #
+			mpz_add_ui(m,m, c - 'a' + 10);												// #
+		}																				// #
+	}																					// ##
+};
+
+
+// Clef RSA chargée en mémoire : module n, exposant d et, pour une clef privée, les valeurs utilisées en mode crt
+typedef struct
+{
+	mpz_t n;
+	mpz_t d;
+	mpz_t p;
+	mpz_t q;
+	mpz_t Ip;
+	mpz_t dp;
+	mpz_t dq;
+} cle_rsa;
+
+
+// Cette fonction initialise une clef RSA vide
+// Entrée : une clef
+// Sortie : vide
+void init_cle_rsa(cle_rsa* cle)
+{
+	mpz_inits(cle->n, cle->d, cle->p, cle->q, cle->Ip, cle->dp, cle->dq, NULL);
+};
+
+
+// Cette fonction calcule les exposants réduits utilisés en mode crt
+// Entrée : une clef dont d, p et q sont renseignés
+// Sortie : vide mais dp = d [p-1] et dq = d [q-1]
+void calcul_crt(cle_rsa* cle)
+{
+	mpz_sub_ui(cle->p,cle->p,1);														// ##
+	modulo(cle->dp,cle->d,cle->p);														// #
+	mpz_add_ui(cle->p,cle->p,1);														// #
+																						// #  Calcul de dp et dq
+	mpz_sub_ui(cle->q,cle->q,1);														// #
+	modulo(cle->dq,cle->d,cle->q);														// #
+	mpz_add_ui(cle->q,cle->q,1);														// ##
+};
+
+
+// Cette fonction efface et libère une clef RSA
+// Entrée : une clef
+// Sortie : vide
+void clear_cle_rsa(cle_rsa* cle)
+{
+	mpz_set_ui(cle->d,0);																// ##
+	mpz_set_ui(cle->p,0);																// #
+	mpz_set_ui(cle->q,0);																// #  Effacement des valeurs secrètes
+	mpz_set_ui(cle->dp,0);																// #
+	mpz_set_ui(cle->dq,0);																// ##
+	mpz_clears(cle->n, cle->d, cle->p, cle->q, cle->Ip, cle->dp, cle->dq, NULL);
+};
+
+
+// Thread d'aide du mode CRT parallèle : chaque thread qui déchiffre en a un, créé au premier bloc et gardé ensuite
+// La moitié q lui est confiée pendant que le thread appelant calcule la moitié p, un bloc seul est ainsi déchiffré en une demi-exponentiation
+typedef struct
+{
+	pthread_t thread;
+	sem_t travail;
+	sem_t fini;
+	int arret;
+	mpz_ptr resultat;
+	mpz_ptr base;
+	mpz_ptr exposant;
+	mpz_ptr module;
+	unsigned int temps_constant;
+} aide_crt;
+
+_Thread_local aide_crt* aide_crt_thread = NULL;				// Le thread d'aide du thread courant
+pthread_key_t cle_aide_crt;									// Arrête le thread d'aide quand le thread qui l'a créé se termine
+pthread_once_t creation_cle_aide_crt = PTHREAD_ONCE_INIT;
+
+
+// Cette fonction est la boucle du thread d'aide : elle calcule les exponentiations qu'on lui confie jusqu'à son arrêt
+// Entrée : un pointeur vers le aide_crt
+// Sortie : NULL
+void* travailler_aide_crt(void* argument)
+{
+	aide_crt* aide = argument;
+	while(1)
+	{
+		sem_wait(&aide->travail);																	// ##
+		if(aide->arret == 1)																		// #
+		{																							// #
+			break;																					// #
+		}																							// #
+		if(aide->temps_constant == 0)																// #  Attente d'une moitié à calculer
+		{																							// #
+			exp_mod(aide->resultat, aide->base, aide->exposant, aide->module);						// #
+		}																							// #
+		else																						// #
+		{																							// #
+			exp_mod_sec(aide->resultat, aide->base, aide->exposant, aide->module);					// #
+		}																							// #
+		sem_post(&aide->fini);																		// ##
+	}
+	return NULL;
+};
+
+
+// Cette fonction arrête un thread d'aide et libère ses ressources, elle est appelée à la fin du thread qui l'a créé
+// Entrée : un pointeur vers le aide_crt
+// Sortie : vide
+void arreter_aide_crt(void* argument)
+{
+	aide_crt* aide = argument;
+	aide->arret = 1;
+	sem_post(&aide->travail);
+	pthread_join(aide->thread, NULL);
+	sem_destroy(&aide->travail);
+	sem_destroy(&aide->fini);
+	free(aide);
+};
+
+
+// Cette fonction crée la clef qui arrête les threads d'aide
+void creer_cle_aide_crt()
+{
+	pthread_key_create(&cle_aide_crt, arreter_aide_crt);
+};
+
+
+// Cette fonction donne le thread d'aide du thread courant et le crée s'il n'existe pas encore
+// Entrée : vide
+// Sortie : un pointeur vers le aide_crt du thread courant
+aide_crt* obtenir_aide_crt()
+{
+	if(aide_crt_thread == NULL)
+	{
+		pthread_once(&creation_cle_aide_crt, creer_cle_aide_crt);									// ##
+		aide_crt* aide = calloc(1, sizeof(aide_crt));												// #
+		sem_init(&aide->travail, 0, 0);																// #  Création du thread d'aide, arrêté automatiquement avec le thread courant
+		sem_init(&aide->fini, 0, 0);																// #
+		pthread_create(&aide->thread, NULL, travailler_aide_crt, aide);								// #
+		pthread_setspecific(cle_aide_crt, aide);													// #
+		aide_crt_thread = aide;																		// ##
+	}
+	return aide_crt_thread;
+};
+
+
+// Cette fonction calcule les deux moitiés CRT en même temps, q sur le thread d'aide et p sur le thread courant
+// Entrée : deux mpz mp et mq, un mpz chiffre, une clef et un entier temps_constant comme pour decrypt()
+// Sortie : vide mais mp = chiffre^dp [p] et mq = chiffre^dq [q]
+void moities_crt_paralleles(mpz_t mp, mpz_t mq, mpz_t chiffre, cle_rsa* cle, unsigned int temps_constant)
+{
+	aide_crt* aide = obtenir_aide_crt();
+
+	aide->resultat = mq;																			// ##
+	aide->base = chiffre;																			// #
+	aide->exposant = cle->dq;																		// #  Moitié q confiée au thread d'aide
+	aide->module = cle->q;																			// #
+	aide->temps_constant = temps_constant;															// #
+	sem_post(&aide->travail);																		// ##
+
+	if(temps_constant == 0)																			// ##
+	{																								// #
+		exp_mod(mp,chiffre,cle->dp,cle->p);															// #
+	}																								// #  Moitié p sur le thread courant
+	else																							// #
+	{																								// #
+		exp_mod_sec(mp,chiffre,cle->dp,cle->p);														// #
+	}																								// ##
+
+	sem_wait(&aide->fini);																			// Attente de la moitié q
+};
+
+
+// Cette fonction déchiffre un bloc en mode standard ou en mode crt, séquentiel ou parallèle
+// Entrée : un mpz chiffre, une clef, deux entiers crt et temps_constant comme pour decrypt() et un contexte d'aveuglement (NULL pour ne pas aveugler)
+// Sortie : vide mais chiffre = chiffre^d [n]
+void dechiffrer_bloc(mpz_t chiffre, cle_rsa* cle, unsigned int crt, unsigned int temps_constant, contexte_aveuglement* aveuglement)
+{
+	if(aveuglement != NULL)																// ##
+	{																					// #  Aveuglement du chiffré
+		aveugler(aveuglement,chiffre);													// #
+	}																					// ##
+
+	if((crt == 0) && (temps_constant == 0))												// ##
+	{																					// #  Déchiffrement en mode standard
+		exp_mod(chiffre,chiffre,cle->d,cle->n);											// #
+	}																					// ##
+
+	if((crt == 0) && (temps_constant == 1))												// ##
+	{																					// #  Déchiffrement en mode standard à temps constant
+		exp_mod_sec(chiffre,chiffre,cle->d,cle->n);										// #
+	}																					// ##
+
+	if(crt >= 1)
+	{
+		mpz_t mp, mq;
+		mpz_inits(mp, mq, NULL);
+
+		if(crt == 2)																	// ##
+		{																				// #  Moitiés calculées en parallèle
+			moities_crt_paralleles(mp,mq,chiffre,cle,temps_constant);					// #
+		}																				// ##
+		else if(temps_constant == 0)													// ##
+		{																				// #
+			exp_mod(mp,chiffre,cle->dp,cle->p);											// #
+			exp_mod(mq,chiffre,cle->dq,cle->q);											// #
+		}																				// #  Moitiés calculées l'une après l'autre
+		else																			// #
+		{																				// #
+			exp_mod_sec(mp,chiffre,cle->dp,cle->p);										// #
+			exp_mod_sec(mq,chiffre,cle->dq,cle->q);										// #
+		}																				// ##
+
+		if(temps_constant == 0)															// ##
+		{																				// #
+			mpz_set(chiffre,mq);														// #
+			mpz_sub(chiffre,chiffre,mp);												// #
+			mpz_mul(chiffre,chiffre,cle->Ip);											// #  Recombinaison du mode crt
+			modulo(chiffre,chiffre,cle->q);												// #
+			mpz_mul(chiffre,chiffre,cle->p);											// #
+			mpz_add(chiffre,chiffre,mp);												// #
+		}																				// #
+		else																			// #
+		{																				// #  Recombinaison à temps constant
+			crt_sec(chiffre,mp,mq,cle->p,cle->q,cle->Ip);								// #
+		}																				// ##
+
+		mpz_set_ui(mp,0);
+		mpz_set_ui(mq,0);
+		mpz_clears(mp, mq, NULL);
+	}
+
+	if(aveuglement != NULL)																// ##
+	{																					// #  Retrait de l'aveuglement et mise à jour de la paire
+		desaveugler(aveuglement,chiffre);												// #
+	}																					// ##
+};
+
+
+#define TAILLE_MAGASIN_CLES 16		// Le nombre de fichiers de clef gardés en mémoire
+
+// Clef chargée depuis un fichier, gardée en mémoire tant que le fichier n'est pas modifié
+typedef struct
+{
+	char chemin[100];
+	struct timespec modification;
+	off_t taille;
+	unsigned int privee;
+	unsigned long derniere_utilisation;
+	cle_rsa cle;
+	contexte_aveuglement aveuglement;
+} cle_en_magasin;
+
+_Thread_local cle_en_magasin magasin_cles[TAILLE_MAGASIN_CLES];			// Chaque thread (worker du démon) a son propre magasin
+_Thread_local unsigned int nb_cles_en_magasin = 0;
+_Thread_local unsigned long horloge_magasin = 0;
+
+
+// Cette fonction renvoie une clef en la lisant dans le magasin si le fichier (chemin et date de modification) n'a pas changé, ou en la chargeant sinon
+// Pour une clef publique on renseigne n et d = 65537. Pour une clef privée on renseigne d, p, q, Ip, puis n = p*q, dp, dq et un contexte d'aveuglement
+// Entrée : une chaîne de caractère chemin et un entier privee valant 1 pour un fichier de clef privée
+// Sortie : un pointeur vers la clef en magasin, valable tant que TAILLE_MAGASIN_CLES-1 autres clefs n'ont pas été chargées, ou NULL si le fichier ne peut pas être lu ou ne contient pas une clef valable
+cle_en_magasin* charger_cle(char* chemin, unsigned int privee)
+{
+	struct stat informations;																	// ##
+	if(stat(chemin, &informations) != 0)														// #
+	{																							// #  Date de modification et taille du fichier
+		return NULL;																			// #
+	}																							// #
+	horloge_magasin++;																			// ##
+
+	cle_en_magasin* entree = NULL;																// ##
+	for(unsigned int i = 0; i < nb_cles_en_magasin; i++)										// #
+	{																							// #
+		if((strcmp(magasin_cles[i].chemin, chemin) == 0) && (magasin_cles[i].privee == privee))	// #
+		{																						// #
+			entree = &magasin_cles[i];															// #  Recherche de la clef dans le magasin, renvoyée directement si le fichier n'a pas changé
+		}																						// #
+	}																							// #
+	if((entree != NULL) && (entree->modification.tv_sec == informations.st_mtim.tv_sec) && (entree->modification.tv_nsec == informations.st_mtim.tv_nsec) && (entree->taille == informations.st_size))	// #
+	{																							// #
+		entree->derniere_utilisation = horloge_magasin;											// #
+		return entree;																			// #
+	}																							// ##
+
+	FILE* fichier = fopen(chemin,"rb");															// ##
+	if(fichier == NULL)																			// #
+	{																							// #  Ouverture du fichier avant de toucher au magasin
+		return NULL;																			// #
+	}																							// ##
+
+	if((entree == NULL) && (nb_cles_en_magasin < TAILLE_MAGASIN_CLES))							// ##
+	{																							// #
+		entree = &magasin_cles[nb_cles_en_magasin];												// #
+		nb_cles_en_magasin++;																	// #  Choix de l'emplacement : l'ancienne version du fichier, un emplacement libre
+	}																							// #  ou la clef utilisée le moins récemment
+	else																						// #
+	{																							// #
+		if(entree == NULL)																		// #
+		{																						// #
+			entree = &magasin_cles[0];															// #
+			for(unsigned int i = 1; i < nb_cles_en_magasin; i++)								// #
+			{																					// #
+				if(magasin_cles[i].derniere_utilisation < entree->derniere_utilisation)			// #
+				{																				// #
+					entree = &magasin_cles[i];													// #
+				}																				// #
+			}																					// #
+		}																						// #
+		clear_cle_rsa(&entree->cle);															// #
+		if(entree->privee == 1)																	// #
+		{																						// #
+			clear_aveuglement(&entree->aveuglement);											// #
+		}																						// #
+	}																							// ##
+
+	strcpy(entree->chemin, chemin);																// ##
+	entree->modification = informations.st_mtim;												// #
+	entree->taille = informations.st_size;														// #  Description de l'entrée
+	entree->privee = privee;																	// #
+	entree->derniere_utilisation = horloge_magasin;												// ##
+
+	init_cle_rsa(&entree->cle);																	// ##
+	unsigned int valide;																		// #
+	if(privee == 0)																				// #
+	{																							// #
+		valide = (mpz_inp_raw(entree->cle.n,fichier) != 0) && (mpz_cmp_ui(entree->cle.n,1) > 0);	// #
+		mpz_set_ui(entree->cle.d,65537);														// #
+	}																							// #
+	else																						// #
+	{																							// #
+		valide = (mpz_inp_raw(entree->cle.d,fichier) != 0) && (mpz_inp_raw(entree->cle.p,fichier) != 0) && (mpz_inp_raw(entree->cle.q,fichier) != 0) && (mpz_inp_raw(entree->cle.Ip,fichier) != 0);	// #
+		valide = valide && (mpz_sgn(entree->cle.d) > 0) && (mpz_cmp_ui(entree->cle.p,1) > 0) && (mpz_cmp_ui(entree->cle.q,1) > 0);	// #
+	}																							// #  Lecture du fichier, une clef tronquée ou nulle vide l'entrée du magasin
+	fclose(fichier);																			// #
+	if(valide == 0)																				// #
+	{																							// #
+		clear_cle_rsa(&entree->cle);															// #
+		init_cle_rsa(&entree->cle);																// #
+		entree->chemin[0] = '\0';																// #
+		entree->privee = 0;																		// #
+		return NULL;																			// #
+	}																							// ##
+
+	if(privee == 1)																				// ##
+	{																							// #
+		mpz_mul(entree->cle.n,entree->cle.p,entree->cle.q);										// #  Précalculs de la clef privée
+		calcul_crt(&entree->cle);																// #
+		mpz_t e;																				// #
+		mpz_init_set_ui(e,65537);																// #
+		init_aveuglement(&entree->aveuglement,e,entree->cle.n);						// #
+		mpz_clear(e);																			// #
+	}																							// ##
+
+	return entree;
+};
+
+
+// Cette fonction efface et libère toutes les clefs du magasin
+// Entrée : vide
+// Sortie : vide
+void vider_magasin_cles()
+{
+	for(unsigned int i = 0; i < nb_cles_en_magasin; i++)
+	{
+		clear_cle_rsa(&magasin_cles[i].cle);
+		if(magasin_cles[i].privee == 1)
+		{
+			clear_aveuglement(&magasin_cles[i].aveuglement);
+		}
+	}
+	nb_cles_en_magasin = 0;
+};
+
+
+// Compression LZ77 au format de séquences de LZ4, sans bibliothèque externe
+// Le flux compressé est une suite de trames indépendantes : taille brute (4 octets), taille stockée (4 octets) puis les données
+// Une trame dont la taille stockée vaut la taille brute est gardée telle quelle, les autres sont des séquences :
+// jeton (littéraux sur 4 bits, longueur de copie - 4 sur 4 bits), extensions de 255, littéraux, décalage sur 2 octets, extensions de la copie
+// La dernière séquence d'une trame n'a que des littéraux
+#define TAILLE_TRAME_LZ77 65536			// La taille maximale des données brutes d'une trame (les décalages tiennent sur 2 octets)
+#define BITS_HACHAGE_LZ77 14			// Le logarithme du nombre d'entrées de la table de hachage du compresseur
+#define COPIE_MIN_LZ77 4				// La longueur minimale d'une copie
+#define BORNE_TRAME_LZ77 (8 + TAILLE_TRAME_LZ77 + TAILLE_TRAME_LZ77/255 + 16)	// La taille maximale d'une trame compressée avec son en-tête
+
+
+// Cette fonction écrit une longueur au-delà de 15 sous forme d'octets 255 suivis du reste
+// Entrée : un tableau destination, une position et la longueur restante
+// Sortie : la position après l'extension
+size_t ecrire_extension_lz77(unsigned char* destination, size_t position, size_t longueur)
+{
+	while(longueur >= 255)
+	{
+		destination[position++] = 255;
+		longueur -= 255;
+	}
+	destination[position++] = longueur;
+	return position;
+};
+
+
+// Cette fonction écrit une séquence : des littéraux puis une copie de longueur octets à distance decalage (aucune copie si longueur vaut 0)
+// Entrée : un tableau destination, une position, les littéraux et leur nombre, un entier decalage et un entier longueur
+// Sortie : la position après la séquence
+size_t ecrire_sequence_lz77(unsigned char* destination, size_t position, const unsigned char* litteraux, size_t nb_litteraux, size_t decalage, size_t longueur)
+{
+	size_t jeton = position++;																	// ##
+	size_t copie = (longueur != 0) ? longueur - COPIE_MIN_LZ77 : 0;								// #  Jeton
+	destination[jeton] = ((nb_litteraux < 15) ? nb_litteraux : 15) << 4 | ((copie < 15) ? copie : 15);	// ##
+
+	if(nb_litteraux >= 15)																		// ##
+	{																							// #
+		position = ecrire_extension_lz77(destination, position, nb_litteraux - 15);				// #  Littéraux
+	}																							// #
+	memcpy(destination + position, litteraux, nb_litteraux);									// #
+	position += nb_litteraux;																	// ##
+
+	if(longueur != 0)																			// ##
+	{																							// #
+		destination[position++] = decalage & 0xff;												// #
+		destination[position++] = decalage >> 8;												// #  Copie
+		if(copie >= 15)																			// #
+		{																						// #
+			position = ecrire_extension_lz77(destination, position, copie - 15);				// #
+		}																						// #
+	}																							// ##
+	return position;
+};
+
+
+// Cette fonction compresse une trame par recherche gloutonne de la dernière occurrence des 4 octets courants
+// Entrée : un tableau source de taille octets (au plus TAILLE_TRAME_LZ77) et un tableau destination d'au moins BORNE_TRAME_LZ77 octets
+// Sortie : la taille de la trame écrite dans destination, en-tête compris
+size_t compresser_trame_lz77(const unsigned char* source, size_t taille, unsigned char* destination)
+{
+	uint32_t* table = calloc(1 << BITS_HACHAGE_LZ77, sizeof(uint32_t));						// Positions + 1 des dernières occurrences, 0 si aucune
+	size_t position = 8;
+	size_t ancre = 0;
+	size_t i = 0;
+
+	while(i + COPIE_MIN_LZ77 <= taille)
+	{
+		uint32_t quatre;																		// ##
+		memcpy(&quatre, source + i, 4);															// #  Recherche des 4 octets courants dans la table
+		uint32_t h = (quatre * 2654435761u) >> (32 - BITS_HACHAGE_LZ77);						// #
+		size_t candidat = table[h];																// #
+		table[h] = i + 1;																		// ##
+		if((candidat != 0) && (memcmp(source + candidat - 1, source + i, 4) == 0))
+		{
+			candidat--;																			// ##
+			size_t longueur = COPIE_MIN_LZ77;													// #
+			while((i + longueur < taille) && (source[candidat + longueur] == source[i + longueur]))	// #  Copie la plus longue depuis l'occurrence trouvée
+			{																					// #
+				longueur++;																		// #
+			}																					// #
+			position = ecrire_sequence_lz77(destination, position, source + ancre, i - ancre, i - candidat, longueur);	// ##
+			i += longueur;
+			ancre = i;
+		}
+		else
+		{
+			i++;
+		}
+	}
+	position = ecrire_sequence_lz77(destination, position, source + ancre, taille - ancre, 0, 0);	// #  Derniers littéraux
+	free(table);
+
+	if(position - 8 >= taille)																	// ##
+	{																							// #  Trame incompressible gardée telle quelle
+		memcpy(destination + 8, source, taille);												// #
+		position = 8 + taille;																	// #
+	}																							// ##
+	for(int o = 0; o < 4; o++)																	// ##
+	{																							// #
+		destination[o] = taille >> (24 - 8*o);													// #  En-tête de la trame
+		destination[4 + o] = (position - 8) >> (24 - 8*o);										// #
+	}																							// ##
+	return position;
+};
+
+
+// Cette fonction lit une longueur étendue par des octets 255
+// Entrée : un tableau source, un pointeur vers la position, la fin de la source et la valeur du jeton
+// Sortie : la longueur, ou (size_t) -1 si la source est trop courte
+size_t lire_extension_lz77(const unsigned char* source, size_t* position, size_t fin, size_t longueur)
+{
+	if(longueur != 15)
+	{
+		return longueur;
+	}
+	unsigned char octet;
+	do
+	{
+		if(*position >= fin)
+		{
+			return (size_t) -1;
+		}
+		octet = source[(*position)++];
+		longueur += octet;
+	}while(octet == 255);
+	return longueur;
+};
+
+
+// Cette fonction décompresse les données d'une trame en vérifiant chaque longueur et chaque décalage
+// Entrée : un tableau source de taille octets, un tableau destination et sa taille attendue
+// Sortie : 0 si la trame est valide et produit exactement attendu octets, -1 sinon
+int decompresser_trame_lz77(const unsigned char* source, size_t taille, unsigned char* destination, size_t attendu)
+{
+	if(taille == attendu)																		// ##
+	{																							// #  Trame gardée telle quelle
+		memcpy(destination, source, taille);													// #
+		return 0;																				// #
+	}																							// ##
+
+	size_t position = 0;
+	size_t sortie = 0;
+	while(position < taille)
+	{
+		unsigned char jeton = source[position++];
+		size_t nb_litteraux = lire_extension_lz77(source, &position, taille, jeton >> 4);		// ##
+		if((nb_litteraux == (size_t) -1) || (nb_litteraux > taille - position) || (nb_litteraux > attendu - sortie))	// #
+		{																						// #  Littéraux
+			return -1;																			// #
+		}																						// #
+		memcpy(destination + sortie, source + position, nb_litteraux);							// #
+		position += nb_litteraux;																// #
+		sortie += nb_litteraux;																	// ##
+		if(position == taille)																	// #  Dernière séquence, sans copie
+		{
+			break;
+		}
+
+		if(taille - position < 2)																// ##
+		{																						// #
+			return -1;																			// #
+		}																						// #
+		size_t decalage = source[position] | (source[position+1] << 8);							// #
+		position += 2;																			// #
+		size_t longueur = lire_extension_lz77(source, &position, taille, jeton & 15);			// #
+		if((longueur == (size_t) -1) || (decalage == 0) || (decalage > sortie) || (longueur + COPIE_MIN_LZ77 > attendu - sortie))	// #  Copie octet par octet, la source et la destination peuvent se recouvrir
+		{																						// #
+			return -1;																			// #
+		}																						// #
+		longueur += COPIE_MIN_LZ77;																// #
+		for(size_t k = 0; k < longueur; k++)													// #
+		{																						// #
+			destination[sortie + k] = destination[sortie - decalage + k];						// #
+		}																						// #
+		sortie += longueur;																		// ##
+	}
+	return (sortie == attendu) ? 0 : -1;
+};
+
+
+// Décompresseur d'un flux de trames reçu par morceaux quelconques
+typedef struct
+{
+	unsigned char entete[8];
+	unsigned int recu_entete;
+	unsigned char* trame;
+	size_t taille_brute;
+	size_t taille_stockee;
+	size_t recu;
+	unsigned char* sortie;
+	int erreur;
+} decompresseur_lz77;
+
+
+// Cette fonction initialise un décompresseur
+// Entrée : un décompresseur
+// Sortie : vide
+void init_decompresseur_lz77(decompresseur_lz77* decompresseur)
+{
+	decompresseur->recu_entete = 0;
+	decompresseur->trame = malloc(BORNE_TRAME_LZ77);
+	decompresseur->sortie = malloc(TAILLE_TRAME_LZ77);
+	decompresseur->erreur = 0;
+};
+
+
+// Cette fonction libère un décompresseur
+// Entrée : un décompresseur
+// Sortie : 0 si le flux s'est terminé sur une fin de trame sans erreur, -1 sinon
+int clear_decompresseur_lz77(decompresseur_lz77* decompresseur)
+{
+	int resultat = ((decompresseur->erreur == 0) && (decompresseur->recu_entete == 0)) ? 0 : -1;
+	free(decompresseur->trame);
+	free(decompresseur->sortie);
+	return resultat;
+};
+
+
+// Cette fonction ajoute des octets compressés au décompresseur et écrit chaque trame complète décompressée
+// Entrée : un décompresseur, un tableau donnees de taille octets et un flux sortie
+// Sortie : vide mais les trames complètes sont écrites dans sortie, l'écriture s'arrête à la première trame invalide
+void decompresser_lz77(decompresseur_lz77* decompresseur, const unsigned char* donnees, size_t taille, FILE* sortie)
+{
+	while((taille > 0) && (decompresseur->erreur == 0))
+	{
+		if(decompresseur->recu_entete < 8)														// ##
+		{																						// #
+			decompresseur->entete[decompresseur->recu_entete++] = *donnees++;					// #
+			taille--;																			// #
+			if(decompresseur->recu_entete == 8)													// #
+			{																					// #
+				decompresseur->taille_brute = 0;												// #
+				decompresseur->taille_stockee = 0;												// #
+				for(int o = 0; o < 4; o++)														// #
+				{																				// #  Lecture de l'en-tête de la trame
+					decompresseur->taille_brute = (decompresseur->taille_brute << 8) | decompresseur->entete[o];	// #
+					decompresseur->taille_stockee = (decompresseur->taille_stockee << 8) | decompresseur->entete[4 + o];	// #
+				}																				// #
+				decompresseur->recu = 0;														// #
+				decompresseur->erreur = (decompresseur->taille_brute > TAILLE_TRAME_LZ77) || (decompresseur->taille_stockee > BORNE_TRAME_LZ77 - 8);	// #
+			}																					// #
+			continue;																			// #
+		}																						// ##
+
+		size_t manque = decompresseur->taille_stockee - decompresseur->recu;					// ##
+		size_t copie = (taille < manque) ? taille : manque;										// #
+		memcpy(decompresseur->trame + decompresseur->recu, donnees, copie);						// #  Accumulation des données de la trame
+		decompresseur->recu += copie;															// #
+		donnees += copie;																		// #
+		taille -= copie;																		// ##
+
+		if(decompresseur->recu == decompresseur->taille_stockee)
+		{
+			if(decompresser_trame_lz77(decompresseur->trame, decompresseur->taille_stockee, decompresseur->sortie, decompresseur->taille_brute) != 0)	// ##
+			{																					// #
+				decompresseur->erreur = 1;														// #
+				break;																			// #  Trame complète : décompression et écriture
+			}																					// #
+			fwrite(decompresseur->sortie, 1, decompresseur->taille_brute, sortie);				// #
+			decompresseur->recu_entete = 0;														// ##
+		}
+	}
+};
+
+
+#define TAILLE_FILE_LOTS 4				// Le nombre de lots en attente entre deux étapes du pipeline
+										// Au plus 3*TAILLE_FILE_LOTS+4 lots existent à la fois : la mémoire utilisée ne dépend pas de la taille du fichier
+
+#define FORMAT_PREFIXE 0				// Chiffré dont chaque bloc est écrit par mpz_out_raw(), précédé de sa taille sur 4 octets
+#define FORMAT_COMPACT 1				// Chiffré commençant par un entete_compact, suivi de blocs de taille_256(n) octets sans préfixe
+#define FORMAT_COMPRESSE 2				// Chiffré au format compact dont le clair est compressé par LZ77 avant le padding
+#define MAGIQUE_COMPACT "RSAP"			// Les quatre premiers octets d'un chiffré au format compact
+#define DRAPEAU_LZ77 1					// Drapeau de l'en-tête compact : le clair des blocs est un flux de trames LZ77
+#define DRAPEAUX_CONNUS DRAPEAU_LZ77	// Les drapeaux de l'en-tête compact compris par cette version
+
+
+// En-tête d'un chiffré au format compact, écrit tel quel en tête du fichier : les drapeaux sont un entier big-endian de 4 octets quel que soit l'hôte
+// Un chiffré au format préfixé ne peut pas commencer par MAGIQUE_COMPACT : son premier bloc ferait plus d'un Go
+typedef struct
+{
+	char magique[4];
+	unsigned char drapeaux[4];
+} entete_compact;
+
+
+// Cette fonction lit un entier big-endian de taille octets dans un tableau
+// Entrée : un tableau octets et un entier taille
+// Sortie : la valeur lue
+unsigned long lire_entier(unsigned char* octets, int taille)
+{
+	unsigned long valeur = 0;
+	for(int i = 0; i < taille; i++)
+	{
+		valeur = (valeur << 8) | octets[i];
+	}
+	return valeur;
+};
+
+
+// Cette fonction écrit un entier big-endian sur taille octets dans un tableau
+// Entrée : un tableau octets, un entier taille et une valeur
+// Sortie : vide
+void ecrire_entier(unsigned char* octets, int taille, unsigned long valeur)
+{
+	for(int i = taille-1; i >= 0; i--)
+	{
+		octets[i] = valeur;
+		valeur >>= 8;
+	}
+};
+
+
+// Lot de blocs circulant dans le pipeline : leurs valeurs en mpz et leurs octets en clair
+// inverses garde pour chaque bloc l'inverse d'aveuglement utilisé, le retrait a lieu après l'exponentiation parallèle
+typedef struct
+{
+	mpz_t* valeurs;
+	mpz_t* inverses;
+	unsigned char* octets;
+	size_t* tailles;
+	int* derniers;
+	unsigned int nb;
+	unsigned int capacite;
+} lot_pipeline;
+
+
+// File bornée de lots entre deux étapes du pipeline
+typedef struct
+{
+	lot_pipeline* lots[TAILLE_FILE_LOTS];
+	unsigned int debut;
+	unsigned int nb;
+	int fin;
+	pthread_mutex_t verrou;
+	pthread_cond_t non_vide;
+	pthread_cond_t non_pleine;
+} file_lots;
+
+
+// Pipeline de chiffrement ou de déchiffrement d'un fichier : lecture, padding ou exponentiation, exponentiation ou retrait du padding, écriture
+// Chaque étape tourne dans son propre thread et les étapes sont reliées par des files bornées, le disque et le processeur travaillent en même temps
+typedef struct
+{
+	FILE* entree;
+	FILE* sortie;
+	int taille_n;
+	unsigned long taille_fichier;
+	mpz_ptr n;
+	mpz_t e;
+	cle_en_magasin* privee;
+	cle_rsa* cle;
+	unsigned int crt;
+	unsigned int temps_constant;
+	contexte_aveuglement* aveuglement;
+	unsigned int blocs_par_lot;
+	unsigned int nb_workers;
+	unsigned int format;
+	uint32_t drapeaux;
+	unsigned int compresser;
+	unsigned int nb_destinataires;
+	decompresseur_lz77 decompresseur;
+	file_lots files[3];
+} pipeline_rsa;
+
+
+// Paramètres d'une étape du pipeline : sa file d'entrée et sa file de sortie
+typedef struct
+{
+	pipeline_rsa* pipeline;
+	file_lots* entree;
+	file_lots* sortie;
+	pthread_t thread;
+} etape_pipeline;
+
+
+// Cette fonction initialise une file de lots vide
+// Entrée : une file
+// Sortie : vide
+void init_file_lots(file_lots* file)
+{
+	file->debut = 0;
+	file->nb = 0;
+	file->fin = 0;
+	pthread_mutex_init(&file->verrou, NULL);
+	pthread_cond_init(&file->non_vide, NULL);
+	pthread_cond_init(&file->non_pleine, NULL);
+};
+
+
+// Cette fonction détruit une file de lots
+// Entrée : une file
+// Sortie : vide
+void clear_file_lots(file_lots* file)
+{
+	pthread_mutex_destroy(&file->verrou);
+	pthread_cond_destroy(&file->non_vide);
+	pthread_cond_destroy(&file->non_pleine);
+};
+
+
+// Cette fonction ajoute un lot à la fin d'une file en attendant qu'elle ne soit plus pleine
+// Entrée : une file et un lot
+// Sortie : vide
+void deposer_lot(file_lots* file, lot_pipeline* lot)
+{
+	pthread_mutex_lock(&file->verrou);
+	while(file->nb == TAILLE_FILE_LOTS)
+	{
+		pthread_cond_wait(&file->non_pleine, &file->verrou);
+	}
+	file->lots[(file->debut + file->nb) % TAILLE_FILE_LOTS] = lot;
+	file->nb++;
+	pthread_cond_signal(&file->non_vide);
+	pthread_mutex_unlock(&file->verrou);
+};
+
+
+// Cette fonction retire le premier lot d'une file en attendant qu'elle ne soit plus vide
+// Entrée : une file
+// Sortie : le lot retiré, NULL si la file est vide et fermée
+lot_pipeline* retirer_lot(file_lots* file)
+{
+	lot_pipeline* lot = NULL;
+	pthread_mutex_lock(&file->verrou);
+	while((file->nb == 0) && (file->fin == 0))
+	{
+		pthread_cond_wait(&file->non_vide, &file->verrou);
+	}
+	if(file->nb > 0)
+	{
+		lot = file->lots[file->debut];
+		file->debut = (file->debut + 1) % TAILLE_FILE_LOTS;
+		file->nb--;
+		pthread_cond_signal(&file->non_pleine);
+	}
+	pthread_mutex_unlock(&file->verrou);
+	return lot;
+};
+
+
+// Cette fonction ferme une file : l'étape suivante s'arrête quand elle l'a vidée
+// Entrée : une file
+// Sortie : vide
+void fermer_file_lots(file_lots* file)
+{
+	pthread_mutex_lock(&file->verrou);
+	file->fin = 1;
+	pthread_cond_broadcast(&file->non_vide);
+	pthread_mutex_unlock(&file->verrou);
+};
+
+
+// Cette fonction alloue un lot vide pour un pipeline
+// Entrée : un pipeline dont la taille et le nombre de blocs par lot sont renseignés
+// Sortie : le lot alloué
+lot_pipeline* nouveau_lot(pipeline_rsa* pipeline)
+{
+	unsigned int capacite = pipeline->blocs_par_lot;
+	lot_pipeline* lot = malloc(sizeof(lot_pipeline));
+	lot->valeurs = malloc(capacite * sizeof(mpz_t));
+	lot->inverses = malloc(capacite * sizeof(mpz_t));
+	for(unsigned int b = 0; b < capacite; b++)
+	{
+		mpz_init(lot->valeurs[b]);
+		mpz_init(lot->inverses[b]);
+	}
+	lot->octets = malloc(capacite * (pipeline->taille_n + 1));
+	lot->tailles = malloc(capacite * sizeof(size_t));
+	lot->derniers = malloc(capacite * sizeof(int));
+	lot->nb = 0;
+	lot->capacite = capacite;
+	return lot;
+};
+
+
+// Cette fonction libère un lot
+// Entrée : un lot
+// Sortie : vide
+void liberer_lot(lot_pipeline* lot)
+{
+	for(unsigned int b = 0; b < lot->capacite; b++)
+	{
+		mpz_clear(lot->valeurs[b]);
+		mpz_clear(lot->inverses[b]);
+	}
+	free(lot->valeurs);
+	free(lot->inverses);
+	free(lot->octets);
+	free(lot->tailles);
+	free(lot->derniers);
+	free(lot);
+};
+
+
+// Etape de lecture du chiffrement : découpe le fichier clair en sous-messages comme padding_fichier()
+// Entrée : une étape du pipeline
+// Sortie : NULL
+void* lecture_clair(void* argument)
+{
+	etape_pipeline* etape = argument;
+	pipeline_rsa* pipeline = etape->pipeline;
+	int taille_n = pipeline->taille_n;
+	int length_n = taille_n - 8;
+	int dernier = 0;
+	unsigned long i = 0;
+	lot_pipeline* lot = nouveau_lot(pipeline);
+
+	while(i < pipeline->taille_fichier)												// #  Boucle pour lire tout le fichier
+	{
+		if(pipeline->taille_fichier - i < (unsigned long) taille_n)								// ##
+		{																				// #  Modification pour le dernier bloc
+			dernier = pipeline->taille_fichier - i;										// #
+		}																				// ##
+
+		STATS_DEBUT(STAT_ENTREES_SORTIES);												// ##
+		size_t lu = fread(lot->octets + lot->nb*(taille_n+1), 1, length_n, pipeline->entree);	// #
+		STATS_FIN(STAT_ENTREES_SORTIES);												// #
+		if(lu == 0)																		// #  Lecture d'un sous-message dans le lot, arrêt si le fichier a raccourci
+		{																				// #
+			break;																		// #
+		}																				// #
+		lot->tailles[lot->nb] = lu;														// #
+		lot->derniers[lot->nb] = dernier;												// #
+		lot->nb++;																		// ##
+
+		if(lot->nb == lot->capacite)													// ##
+		{																				// #
+			deposer_lot(etape->sortie, lot);											// #  Envoi du lot plein à l'étape suivante
+			lot = nouveau_lot(pipeline);												// #
+		}																				// ##
+		i = i + length_n;
+	}
+
+	deposer_lot(etape->sortie, lot);													// #  Envoi du dernier lot, éventuellement vide
+	fermer_file_lots(etape->sortie);
+	return NULL;
+};
+
+
+// Etape de lecture du chiffrement d'un flux dont la taille n'est pas connue d'avance : découpe en sous-messages les trames LZ77 du clair
+// si pipeline->compresser vaut 1, l'entrée telle quelle sinon (tube d'un chiffrement pour plusieurs destinataires)
+// Un bloc n'est envoyé que lorsque l'on sait s'il est le dernier, le flux est donc complété d'une trame dès qu'il reste au plus un bloc
+// Entrée : une étape du pipeline
+// Sortie : NULL
+void* lecture_flux(void* argument)
+{
+	etape_pipeline* etape = argument;
+	pipeline_rsa* pipeline = etape->pipeline;
+	int taille_n = pipeline->taille_n;
+	size_t length_n = taille_n - 8;
+	unsigned char* brut = malloc(TAILLE_TRAME_LZ77);											// ##
+	unsigned char* flux = malloc(length_n + BORNE_TRAME_LZ77);									// #  Trames compressées pas encore découpées, de debut à fin
+	size_t debut = 0;																			// #
+	size_t fin = 0;																				// ##
+	int lu_en_entier = 0;
+	lot_pipeline* lot = nouveau_lot(pipeline);
+
+	while((lu_en_entier == 0) || (fin > debut))
+	{
+		if((lu_en_entier == 0) && (fin - debut <= length_n))
+		{
+			memmove(flux, flux + debut, fin - debut);											// ##
+			fin -= debut;																		// #
+			debut = 0;																			// #
+			unsigned char* lecture = (pipeline->compresser == 1) ? brut : flux + fin;			// #
+			STATS_DEBUT(STAT_ENTREES_SORTIES);													// #
+			size_t lu = fread(lecture, 1, TAILLE_TRAME_LZ77, pipeline->entree);					// #
+			STATS_FIN(STAT_ENTREES_SORTIES);													// #
+			if(lu == 0)																			// #
+			{																					// #  Compression d'une trame de plus à la fin du flux,
+				lu_en_entier = 1;																// #  ou lecture directe si l'entrée est déjà prête
+				continue;																		// #
+			}																					// #
+			if(pipeline->compresser == 0)														// #
+			{																					// #
+				fin += lu;																		// #
+				continue;																		// #
+			}																					// #
+			STATS_DEBUT(STAT_COMPRESSION);														// #
+			fin += compresser_trame_lz77(brut, lu, flux + fin);									// #
+			STATS_FIN(STAT_COMPRESSION);														// #
+			continue;																			// ##
+		}
+
+		size_t taille = (fin - debut < length_n) ? fin - debut : length_n;						// ##
+		memcpy(lot->octets + lot->nb*(taille_n+1), flux + debut, taille);						// #
+		debut += taille;																		// #  Découpe d'un sous-message, le dernier porte sa taille
+		lot->tailles[lot->nb] = taille;															// #
+		lot->derniers[lot->nb] = ((lu_en_entier == 1) && (fin == debut)) ? taille : 0;			// #
+		lot->nb++;																				// ##
+
+		if(lot->nb == lot->capacite)															// ##
+		{																						// #
+			deposer_lot(etape->sortie, lot);													// #  Envoi du lot plein à l'étape suivante
+			lot = nouveau_lot(pipeline);														// #
+		}																						// ##
+	}
+
+	deposer_lot(etape->sortie, lot);															// #  Envoi du dernier lot, éventuellement vide
+	fermer_file_lots(etape->sortie);
+	free(brut);
+	free(flux);
+	return NULL;
+};
+
+
+// Etape de padding du chiffrement : applique OAEP() à chaque sous-message en mémoire
+// Entrée : une étape du pipeline
+// Sortie : NULL
+void* padding_pipeline(void* argument)
+{
+	etape_pipeline* etape = argument;
+	pipeline_rsa* pipeline = etape->pipeline;
+	int taille_n = pipeline->taille_n;
+	char* hexa = malloc(2*taille_n + 1);
+	lot_pipeline* lot;
+
+	while((lot = retirer_lot(etape->entree)) != NULL)
+	{
+		STATS_DEBUT(STAT_PADDING);														// ##
+		for(unsigned int b = 0; b < lot->nb; b++)										// #
+		{																				// #
+			FILE* clair = fmemopen(lot->octets + b*(taille_n+1), lot->tailles[b], "r");	// #
+			FILE* OAE = fmemopen(hexa, 2*taille_n + 1, "w");							// #
+			OAEP(taille_n - 8, lot->derniers[b], clair, OAE);							// #
+			fclose(clair);																// #  Padding de chaque sous-message du lot puis lecture du bloc paddé
+			fclose(OAE);																// #
+			OAE = fmemopen(hexa, 2*taille_n, "r");										// #
+			lire_bloc_oaep(OAE, lot->valeurs[b], taille_n);								// #
+			fclose(OAE);																// #
+		}																				// #
+		STATS_FIN(STAT_PADDING);														// ##
+		deposer_lot(etape->sortie, lot);
+	}
+
+	free(hexa);
+	fermer_file_lots(etape->sortie);
+	return NULL;
+};
+
+
+// Partage d'un lot entre les workers de l'étape d'exponentiation : chacun prend le bloc suivant jusqu'à la fin du lot
+typedef struct
+{
+	pipeline_rsa* pipeline;
+	lot_pipeline* lot;
+	unsigned int prochain;
+	sem_t travail;
+	sem_t fini;
+} partage_exponentiation;
+
+
+// Cette fonction chiffre, signe ou déchiffre les blocs du lot partagé qui ne sont pas encore pris, sans aveuglement
+// Entrée : un partage dont le lot est renseigné
+// Sortie : vide
+void exponentier_blocs(partage_exponentiation* partage)
+{
+	pipeline_rsa* pipeline = partage->pipeline;
+	lot_pipeline* lot = partage->lot;
+	unsigned int b;
+
+	while((b = __atomic_fetch_add(&partage->prochain, 1, __ATOMIC_RELAXED)) < lot->nb)
+	{
+		if(pipeline->cle != NULL)														// ##
+		{																				// #
+			dechiffrer_bloc(lot->valeurs[b], pipeline->cle, pipeline->crt, pipeline->temps_constant, NULL);	// #
+		}																				// #
+		else if(pipeline->privee == NULL)												// #  Déchiffrement, chiffrement ou signature en temps constant avec la clef privée
+		{																				// #
+			exp_mod(lot->valeurs[b], lot->valeurs[b], pipeline->e, pipeline->n);		// #
+		}																				// #
+		else																			// #
+		{																				// #
+			exp_mod_sec(lot->valeurs[b], lot->valeurs[b], pipeline->e, pipeline->n);	// #
+		}																				// ##
+	}
+};
+
+
+// Cette fonction est exécutée par chaque worker supplémentaire de l'étape d'exponentiation
+// Entrée : un pointeur vers le partage_exponentiation
+// Sortie : NULL
+void* worker_exponentiation(void* argument)
+{
+	partage_exponentiation* partage = argument;
+	while(1)
+	{
+		sem_wait(&partage->travail);
+		if(partage->lot == NULL)														// #  Plus de lot : fin du pipeline
+		{
+			break;
+		}
+		exponentier_blocs(partage);
+		sem_post(&partage->fini);
+	}
+	return NULL;
+};
+
+
+// Etape d'exponentiation : chiffre ou signe les blocs paddés d'un lot, ou les déchiffre si le pipeline a une clef
+// Les blocs d'un lot sont répartis entre nb_workers threads, l'aveuglement est appliqué et retiré dans l'ordre des blocs par ce thread
+// Entrée : une étape du pipeline
+// Sortie : NULL
+void* exponentiation_pipeline(void* argument)
+{
+	etape_pipeline* etape = argument;
+	pipeline_rsa* pipeline = etape->pipeline;
+	contexte_aveuglement* aveuglement = (pipeline->cle != NULL) ? pipeline->aveuglement : ((pipeline->privee != NULL) ? &pipeline->privee->aveuglement : NULL);
+	lot_pipeline* lot;
+	if(aveuglement != NULL)
+	{
+		renouveler_aveuglement(aveuglement);											// Nouvelle paire d'aveuglement pour chaque fichier
+	}
+
+	partage_exponentiation partage;														// ##
+	partage.pipeline = pipeline;														// #
+	sem_init(&partage.travail, 0, 0);													// #
+	sem_init(&partage.fini, 0, 0);														// #
+	unsigned int nb_aides = pipeline->nb_workers - 1;									// #  Lancement des workers supplémentaires
+	pthread_t* aides = malloc(nb_aides * sizeof(pthread_t));							// #
+	for(unsigned int i = 0; i < nb_aides; i++)											// #
+	{																					// #
+		pthread_create(&aides[i], NULL, worker_exponentiation, &partage);				// #
+	}																					// ##
+
+	while((lot = retirer_lot(etape->entree)) != NULL)
+	{
+		STATS_DEBUT(STAT_EXPONENTIATION);												// ##
+		if(aveuglement != NULL)															// #
+		{																				// #
+			for(unsigned int b = 0; b < lot->nb; b++)									// #
+			{																			// #  Aveuglement de chaque bloc avec la paire courante, gardée pour le retrait
+				aveugler(aveuglement, lot->valeurs[b]);									// #
+				mpz_set(lot->inverses[b], aveuglement->r_inv);							// #
+				avancer_aveuglement(aveuglement);										// #
+			}																			// #
+		}																				// ##
+
+		partage.lot = lot;																// ##
+		partage.prochain = 0;															// #
+		for(unsigned int i = 0; i < nb_aides; i++)										// #
+		{																				// #
+			sem_post(&partage.travail);													// #
+		}																				// #  Exponentiation des blocs du lot par tous les workers
+		exponentier_blocs(&partage);													// #
+		for(unsigned int i = 0; i < nb_aides; i++)										// #
+		{																				// #
+			sem_wait(&partage.fini);													// #
+		}																				// ##
+
+		if(aveuglement != NULL)															// ##
+		{																				// #
+			for(unsigned int b = 0; b < lot->nb; b++)									// #
+			{																			// #  Retrait de l'aveuglement
+				mpz_mul(lot->valeurs[b], lot->valeurs[b], lot->inverses[b]);			// #
+				modulo(lot->valeurs[b], lot->valeurs[b], aveuglement->n);				// #
+				mpz_set_ui(lot->inverses[b], 0);										// #
+			}																			// #
+		}																				// #
+		STATS_FIN(STAT_EXPONENTIATION);													// #
+		STATS_AJOUTER(STAT_BLOCS,lot->nb);												// ##
+		deposer_lot(etape->sortie, lot);
+	}
+
+	partage.lot = NULL;																	// ##
+	for(unsigned int i = 0; i < nb_aides; i++)											// #
+	{																					// #
+		sem_post(&partage.travail);														// #
+	}																					// #
+	for(unsigned int i = 0; i < nb_aides; i++)											// #  Arrêt des workers supplémentaires
+	{																					// #
+		pthread_join(aides[i], NULL);													// #
+	}																					// #
+	free(aides);																		// #
+	sem_destroy(&partage.travail);														// #
+	sem_destroy(&partage.fini);															// ##
+
+	fermer_file_lots(etape->sortie);
+	return NULL;
+};
+
+
+// Etape de lecture du déchiffrement : lit les mpz_t chiffrés et repère le dernier
+// Entrée : une étape du pipeline
+// Sortie : NULL
+void* lecture_chiffre(void* argument)
+{
+	etape_pipeline* etape = argument;
+	pipeline_rsa* pipeline = etape->pipeline;
+	size_t taille_bloc = pipeline->taille_n + 1;
+	unsigned long compteur = (pipeline->format == FORMAT_COMPACT) ? sizeof(entete_compact) : 0;	// #  L'en-tête compact est déjà lu
+	lot_pipeline* lot = nouveau_lot(pipeline);
+
+	while(compteur < pipeline->taille_fichier)											// #  Boucle pour lire tout le fichier
+	{
+		STATS_DEBUT(STAT_ENTREES_SORTIES);												// ##
+		size_t lu;																		// #
+		if(pipeline->format == FORMAT_COMPACT)											// #
+		{																				// #
+			unsigned char* bloc = lot->octets + lot->nb*taille_bloc;					// #
+			lu = fread(bloc, 1, taille_bloc, pipeline->entree);							// #
+			lu = (lu == taille_bloc) ? lu : 0;											// #  Lecture d'un bloc de taille fixe ou d'un mpz_t préfixé par sa taille
+			mpz_import(lot->valeurs[lot->nb], lu, 1, 1, 1, 0, bloc);					// #
+		}																				// #
+		else																			// #
+		{																				// #
+			lu = mpz_inp_raw(lot->valeurs[lot->nb], pipeline->entree);					// #
+		}																				// #
+		STATS_FIN(STAT_ENTREES_SORTIES);												// #
+		if(lu == 0)																		// #
+		{																				// #  Lecture du mpz_t chiffré dans le lot, arrêt sur un fichier tronqué
+			break;																		// #
+		}																				// #
+		compteur = compteur + lu;														// #
+		lot->derniers[lot->nb] = (compteur == pipeline->taille_fichier);				// #
+		lot->nb++;																		// ##
+
+		if(lot->nb == lot->capacite)													// ##
+		{																				// #
+			deposer_lot(etape->sortie, lot);											// #  Envoi du lot plein à l'étape suivante
+			lot = nouveau_lot(pipeline);												// #
+		}																				// ##
+	}
+
+	deposer_lot(etape->sortie, lot);													// #  Envoi du dernier lot, éventuellement vide
+	fermer_file_lots(etape->sortie);
+	return NULL;
+};
+
+
+// Etape de retrait du padding du déchiffrement : applique inv_OAEP() à chaque bloc en mémoire
+// Entrée : une étape du pipeline
+// Sortie : NULL
+void* retrait_padding_pipeline(void* argument)
+{
+	etape_pipeline* etape = argument;
+	pipeline_rsa* pipeline = etape->pipeline;
+	int taille_n = pipeline->taille_n;
+	lot_pipeline* lot;
+
+	while((lot = retirer_lot(etape->entree)) != NULL)
+	{
+		STATS_DEBUT(STAT_PADDING);														// ##
+		for(unsigned int b = 0; b < lot->nb; b++)										// #
+		{																				// #
+			FILE* clair = fmemopen(lot->octets + b*(taille_n+1), taille_n + 1, "w");	// #
+			inv_OAEP(taille_n, lot->derniers[b], lot->valeurs[b], clair);				// #  Retrait du padding dans les octets de chaque bloc du lot
+			fflush(clair);																// #
+			lot->tailles[b] = ftell(clair);												// #
+			fclose(clair);																// #
+		}																				// #
+		STATS_FIN(STAT_PADDING);														// ##
+		deposer_lot(etape->sortie, lot);
+	}
+
+	fermer_file_lots(etape->sortie);
+	return NULL;
+};
+
+
+// Cette fonction exécute un pipeline : trois étapes dans leurs threads, l'écriture dans le thread appelant
+// Entrée : un pipeline dont les flux, la taille et les clefs sont renseignés et trois étapes dans l'ordre
+// Sortie : vide mais le résultat est écrit dans le flux de sortie du pipeline
+void executer_pipeline(pipeline_rsa* pipeline, void* (*premiere)(void*), void* (*deuxieme)(void*), void* (*troisieme)(void*))
+{
+	void* (*fonctions[3])(void*) = {premiere, deuxieme, troisieme};
+	etape_pipeline etapes[3];
+	int taille_n = pipeline->taille_n;
+	pipeline->blocs_par_lot = blocs_par_lot(8*(taille_n+1));							// #  Réglages du profil de l'hôte pour cette taille de clef
+	pipeline->nb_workers = workers_exponentiation(8*(taille_n+1));						// #
+	pipeline->nb_workers = (pipeline->nb_workers + pipeline->nb_destinataires - 1) / pipeline->nb_destinataires;	// #  partagés entre les pipelines d'un chiffrement pour plusieurs destinataires
+
+	for(int i = 0; i < 3; i++)															// ##
+	{																					// #
+		init_file_lots(&pipeline->files[i]);											// #
+	}																					// #
+	for(int i = 0; i < 3; i++)															// #  Lancement des étapes reliées par les files
+	{																					// #
+		etapes[i].pipeline = pipeline;													// #
+		etapes[i].entree = (i == 0) ? NULL : &pipeline->files[i-1];						// #
+		etapes[i].sortie = &pipeline->files[i];											// #
+		pthread_create(&etapes[i].thread, NULL, fonctions[i], &etapes[i]);				// #
+	}																					// ##
+
+	lot_pipeline* lot;
+	while((lot = retirer_lot(&pipeline->files[2])) != NULL)
+	{
+		STATS_DEBUT(STAT_ENTREES_SORTIES);												// ##
+		for(unsigned int b = 0; b < lot->nb; b++)										// #
+		{																				// #
+			unsigned char* bloc = lot->octets + b*(taille_n+1);							// #
+			if((pipeline->cle != NULL) && (pipeline->drapeaux & DRAPEAU_LZ77))			// #
+			{																			// #
+				STATS_DEBUT(STAT_COMPRESSION);											// #
+				decompresser_lz77(&pipeline->decompresseur, bloc, lot->tailles[b], pipeline->sortie);	// #
+				STATS_FIN(STAT_COMPRESSION);											// #
+			}																			// #
+			else if(pipeline->cle != NULL)												// #  Ecriture du clair, décompressé s'il le faut, du chiffré en blocs
+			{																			// #  de taille fixe complétés à gauche par des zéros ou du chiffré préfixé par sa taille
+				fwrite(bloc, 1, lot->tailles[b], pipeline->sortie);						// #
+			}																			// #
+			else if(pipeline->format == FORMAT_COMPACT)									// #
+			{																			// #
+				size_t taille = (mpz_sizeinbase(lot->valeurs[b], 2) + 7) / 8;			// #
+				memset(bloc, 0, taille_n+1);											// #
+				mpz_export(bloc + (taille_n+1) - taille, NULL, 1, 1, 1, 0, lot->valeurs[b]);	// #
+				fwrite(bloc, 1, taille_n+1, pipeline->sortie);							// #
+			}																			// #
+			else																		// #
+			{																			// #
+				mpz_out_raw(pipeline->sortie, lot->valeurs[b]);							// #
+			}																			// #
+		}																				// #
+		STATS_FIN(STAT_ENTREES_SORTIES);												// ##
+		liberer_lot(lot);
+	}
+
+	for(int i = 0; i < 3; i++)															// ##
+	{																					// #
+		pthread_join(etapes[i].thread, NULL);											// #  Attente des étapes
+		clear_file_lots(&pipeline->files[i]);											// #
+	}																					// ##
+};
+
+
+// Cette fonction prépare le pipeline de chiffrement ou de signature d'un flux et écrit l'en-tête du chiffré
+// Entrée : un pipeline, deux flux clair et cypher, un mpz n, une clef privée en magasin privee et un entier format comme pour chiffrer_fichier()
+// Sortie : vide mais le pipeline est prêt pour executer_pipeline(), son mpz e est à libérer après
+void preparer_chiffrement(pipeline_rsa* pipeline, FILE* clair, FILE* cypher, mpz_t n, cle_en_magasin* privee, unsigned int format)
+{
+	pipeline->entree = clair;															// ##
+	pipeline->sortie = cypher;															// #
+	pipeline->taille_n = taille_256(n)-1;												// #
+	pipeline->n = n;																	// #
+	pipeline->privee = privee;															// #
+	pipeline->cle = NULL;																// #
+	pipeline->format = (format == FORMAT_PREFIXE) ? FORMAT_PREFIXE : FORMAT_COMPACT;	// #
+	pipeline->drapeaux = (format == FORMAT_COMPRESSE) ? DRAPEAU_LZ77 : 0;				// #
+	pipeline->compresser = (format == FORMAT_COMPRESSE) ? 1 : 0;						// #
+	pipeline->nb_destinataires = 1;														// #
+	mpz_init(pipeline->e);																// #
+	if(privee == NULL)																	// #  Choix entre chiffrement et signature :
+	{																					// #  	- chiffrement : on initialise e à 65537
+		mpz_set_ui(pipeline->e,65537);													// #  	- signature : on initialise e à la valeur de la clef privée
+	}																					// #
+	else																				// #
+	{																					// #
+		mpz_set(pipeline->e,privee->cle.d);												// #
+	}																					// ##
+
+	if(pipeline->format == FORMAT_COMPACT)												// ##
+	{																					// #
+		entete_compact entete;															// #
+		memcpy(entete.magique, MAGIQUE_COMPACT, 4);										// #  En-tête du format compact
+		ecrire_entier(entete.drapeaux, 4, pipeline->drapeaux);							// #
+		fwrite(&entete, sizeof(entete), 1, cypher);										// #
+	}																					// ##
+};
+
+
+// Cette fonction applique le padding OAEP à un fichier puis chiffre ou signe chaque bloc, sans rien demander à l'utilisateur
+// Lecture, padding, exponentiation et écriture se recouvrent dans un pipeline
+// Entrée : deux flux clair et cypher, un mpz n correspondant à la clef publique, une clef privée en magasin privee (NULL pour chiffrer avec 65537, sinon on signe en temps constant avec l'aveuglement de la clef) et un entier format (FORMAT_PREFIXE, FORMAT_COMPACT ou FORMAT_COMPRESSE)
+// Sortie : vide mais les blocs chiffrés ou signés sont écrits dans cypher
+void chiffrer_fichier(FILE* clair, FILE* cypher, mpz_t n, cle_en_magasin* privee, unsigned int format)
+{
+	pipeline_rsa pipeline;
+	preparer_chiffrement(&pipeline, clair, cypher, n, privee, format);
+
+	fseek(clair,0,SEEK_END);															// ##
+    pipeline.taille_fichier = ftell(clair);												// #  On récupère la taille du fichier à chiffrer ou signer
+    rewind(clair);																		// ##
+    STATS_AJOUTER(STAT_OCTETS_LUS,pipeline.taille_fichier);								// Comptage des octets lus
+
+    executer_pipeline(&pipeline, (pipeline.drapeaux & DRAPEAU_LZ77) ? lecture_flux : lecture_clair, padding_pipeline, exponentiation_pipeline);	// #  Lecture, padding, chiffrement et écriture en parallèle
+
+    STATS_AJOUTER(STAT_OCTETS_ECRITS,ftell(cypher));									// Comptage des octets produits
+    mpz_clear(pipeline.e);
+};
+
+
+#define MAX_DESTINATAIRES 32			// Le nombre maximal de destinataires d'un même chiffrement
+
+
+// Destinataire d'un chiffrement pour plusieurs destinataires : son module, son chiffré et le tube par lequel il reçoit le clair
+typedef struct
+{
+	mpz_t n;
+	FILE* tube;
+	FILE* lecture;
+	FILE* cypher;
+	unsigned int format;
+	unsigned int nb_destinataires;
+	pthread_t thread;
+} destinataire;
+
+
+// Cette fonction est exécutée par le thread de chaque destinataire : elle fait tourner son pipeline sur le clair reçu par le tube
+// Le padding est fait pour chaque destinataire comme pour un chiffrement seul : les graines aléatoires des blocs ne sont pas partagées
+// Entrée : un pointeur vers le destinataire
+// Sortie : NULL
+void* chiffrer_destinataire(void* argument)
+{
+	destinataire* dest = argument;
+	pipeline_rsa pipeline;
+	preparer_chiffrement(&pipeline, dest->lecture, dest->cypher, dest->n, NULL, dest->format);
+	pipeline.compresser = 0;															// ##  Le clair est déjà compressé une fois pour tous par le lecteur
+	pipeline.nb_destinataires = dest->nb_destinataires;									// ##  Les workers d'exponentiation sont partagés entre destinataires
+
+	executer_pipeline(&pipeline, lecture_flux, padding_pipeline, exponentiation_pipeline);	// #  Découpe, padding, chiffrement et écriture pour ce destinataire
+
+	STATS_AJOUTER(STAT_OCTETS_ECRITS,ftell(dest->cypher));								// Comptage des octets produits
+	mpz_clear(pipeline.e);
+	return NULL;
+};
+
+
+// Cette fonction chiffre un fichier pour plusieurs clefs publiques en ne le lisant (et en ne le compressant) qu'une fois, sans rien demander à l'utilisateur
+// Le clair est diffusé par un tube à chaque destinataire, dont le pipeline découpe, padde et chiffre ses propres blocs
+// Entrée : un flux clair, un tableau de nb destinataires dont n et cypher sont renseignés et un entier format comme pour chiffrer_fichier()
+// Sortie : 0 si chaque chiffré est écrit dans le cypher de son destinataire, sinon le numéro (à partir de 1) du destinataire dont le tube n'a pas pu être créé, rien n'est alors chiffré
+unsigned int chiffrer_fichier_destinataires(FILE* clair, destinataire* destinataires, unsigned int nb, unsigned int format)
+{
+	for(unsigned int i = 0; i < nb; i++)												// ##
+	{																					// #
+		int extremites[2];																// #
+		destinataires[i].lecture = NULL;												// #
+		destinataires[i].tube = NULL;													// #
+		if(pipe(extremites) == 0)														// #
+		{																				// #
+			destinataires[i].lecture = fdopen(extremites[0], "rb");						// #
+			destinataires[i].tube = fdopen(extremites[1], "wb");						// #
+			if(destinataires[i].lecture == NULL)										// #
+			{																			// #
+				close(extremites[0]);													// #
+			}																			// #
+			if(destinataires[i].tube == NULL)											// #
+			{																			// #
+				close(extremites[1]);													// #
+			}																			// #
+		}																				// #
+		if((destinataires[i].lecture == NULL) || (destinataires[i].tube == NULL))		// #
+		{																				// #  Un tube et un pipeline par destinataire. Si un tube ne peut pas être créé,
+			if(destinataires[i].lecture != NULL)										// #  les pipelines déjà lancés reçoivent un clair vide et s'arrêtent
+			{																			// #
+				fclose(destinataires[i].lecture);										// #
+			}																			// #
+			if(destinataires[i].tube != NULL)											// #
+			{																			// #
+				fclose(destinataires[i].tube);											// #
+			}																			// #
+			for(unsigned int j = 0; j < i; j++)											// #
+			{																			// #
+				fclose(destinataires[j].tube);											// #
+				pthread_join(destinataires[j].thread, NULL);							// #
+				fclose(destinataires[j].lecture);										// #
+			}																			// #
+			return i+1;																	// #
+		}																				// #
+		destinataires[i].format = format;												// #
+		destinataires[i].nb_destinataires = nb;											// #
+		pthread_create(&destinataires[i].thread, NULL, chiffrer_destinataire, &destinataires[i]);	// #
+	}																					// ##
+
+	unsigned char* brut = malloc(TAILLE_TRAME_LZ77);
+	unsigned char* trame = malloc(BORNE_TRAME_LZ77);
+	size_t lu;
+	while(1)
+	{
+		STATS_DEBUT(STAT_ENTREES_SORTIES);												// ##
+		lu = fread(brut, 1, TAILLE_TRAME_LZ77, clair);									// #
+		STATS_FIN(STAT_ENTREES_SORTIES);												// #  Lecture d'une trame du clair
+		if(lu == 0)																		// #
+		{																				// #
+			break;																		// #
+		}																				// #
+		STATS_AJOUTER(STAT_OCTETS_LUS,lu);												// ##
+
+		unsigned char* donnees = brut;													// ##
+		size_t taille = lu;																// #
+		if(format == FORMAT_COMPRESSE)													// #
+		{																				// #
+			STATS_DEBUT(STAT_COMPRESSION);												// #  Compression de la trame, une seule fois pour tous les destinataires
+			taille = compresser_trame_lz77(brut, lu, trame);							// #
+			STATS_FIN(STAT_COMPRESSION);												// #
+			donnees = trame;															// #
+		}																				// ##
+
+		for(unsigned int i = 0; i < nb; i++)											// ##
+		{																				// #  Diffusion à chaque destinataire, un destinataire en retard ralentit
+			fwrite(donnees, 1, taille, destinataires[i].tube);							// #  la lecture quand son tube est plein
+		}																				// ##
+	}
+
+	for(unsigned int i = 0; i < nb; i++)												// ##
+	{																					// #
+		fclose(destinataires[i].tube);													// #
+		pthread_join(destinataires[i].thread, NULL);									// #  Fin du clair, attente des pipelines
+		fclose(destinataires[i].lecture);												// #
+	}																					// ##
+	free(brut);
+	free(trame);
+	return 0;
+};
+
+
+// Cette fonction sert soit à chiffrer un fichier, soit à signer un fichier 
+// Entrée : un entier signature, si signature vaut 0 on chiffre, si signature vaut 1 on signe, si signature vaut 2 on signe la racine de l'arbre de Merkle du fichier, et un entier format (FORMAT_PREFIXE, FORMAT_COMPACT ou FORMAT_COMPRESSE) pour le chiffré
+// Sortie : vide mais on crée soit un fichier contenant un chiffré ou un fichier contenant une signature
+void encrypt(unsigned int signature, unsigned int format) 
+{
+	char choix;
+	STATS_REINITIALISER();
+
+	char nom_fichier_cle_publique[100];													// ##
+																						// #
+	etiquette:																			// #
+   		printf("\nQuel est le nom du fichier contenant la clé publique?\n\n");			// #
+    	scanf(" %99s", nom_fichier_cle_publique);										// #
+		if(access( nom_fichier_cle_publique, F_OK ) != 0)								// #  Ouverture du fichier contenant la clé publique
+		{																				// #
+			printf("\nAttention, le nom de fichier saisi n'existe pas!");				// #
+			goto etiquette;																// #
+		}																				// #
+    cle_en_magasin* publique = charger_cle(nom_fichier_cle_publique,0);					// #
+    if(publique == NULL)																// #
+    {																					// #
+    	printf("\nAttention, le fichier saisi ne contient pas une clé publique valable!");	// #
+    	goto etiquette;																	// #
+    }																					// ##
+
+
+	char nom_fichier_a_chiffrer[100];													// ##
+																						// #
+	etiquette2:																			// #
+		if(signature == 0)																// #
+		{																				// #
+   			printf("\nQuel est le nom du fichier que vous désirez chiffrer?\n\n");		// #
+   		}																				// #
+   		else																			// #
+   		{																				// #  Ouverture du fichier contenant le fichier que l'on va signer ou chiffrer
+   			printf("\nQuel est le nom du fichier que vous désirez signer?\n\n");		// #
+   		}																				// #
+    	scanf(" %99s", nom_fichier_a_chiffrer);											// #
+    	if(access( nom_fichier_a_chiffrer, F_OK ) != 0)									// #
+		{																				// #
+			printf("\nAttention, le nom de fichier saisi n'existe pas!");				// #
+			goto etiquette2;															// #
+		}																				// #
+	FILE* clair = NULL;																	// #
+	if(signature == 0)																	// #
+	{																					// #
+   		clair = fopen(nom_fichier_a_chiffrer,"rb+");									// #
+   	}																					// #
+   	else if(signature == 1)																// #
+   	{																					// #  En arbre le hachage attend le nom de la signature, à côté de laquelle est rangé le manifeste
+   		if(SHA256(nom_fichier_a_chiffrer) != 0)											// #
+   		{																				// #
+   			printf("\nAttention, le fichier saisi ne peut pas être lu!");				// #
+   			goto etiquette2;															// #
+   		}																				// #
+   		clair = fopen(travail.hasher,"rb+");											// #
+   	}																					// #
+																						// ##
+
+
+    char nom_fichier_chiffrer[100];																										// ##
+    																																	// #
+    etiquette3:																															// #
+    	if (signature == 0)																												// #
+    	{																																// #
+    		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker le chiffré ?\n\n");									// #
+    	}																																// #
+    	else																															// #
+    	{																																// #
+    		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker la signature?\n\n");									// #
+    	}																																// #
+   		scanf(" %99s", nom_fichier_chiffrer);																							// #
+   		if(access( nom_fichier_chiffrer, F_OK ) == 0)																					// #
+		{																																// #  Création ou édition et ouverture du fichier de destination
+			printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
+			scanf(" %c",&choix);																										// #
+			while((choix != 'Y') & (choix != 'N'))																						// #
+			{																															// #
+				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
+				scanf(" %c",&choix);																									// #
+			}																															// #
+																																		// #
+			if(choix == 'N')																											// #
+			{																															// #
+				goto etiquette3;																										// #
+			}																															// #
+		}																																// #
+	FILE* cypher = fopen(nom_fichier_chiffrer,"wb+");																					// ##
+
+	if(signature == 2)																	// ##
+	{																					// #
+		char nom_manifeste[110];														// #
+		sprintf(nom_manifeste, "%s.arbre", nom_fichier_chiffrer);						// #
+		choix = 'N';																	// #
+		if(access(nom_manifeste, F_OK) == 0)											// #
+		{																				// #
+			printf("\nLe fichier n'a-t-il été modifié que par ajout à la fin depuis la signature précédente?[Y/N]\n\n");	// #
+			scanf(" %c",&choix);														// #
+			while((choix != 'Y') & (choix != 'N'))										// #  Hachage en arbre : pour un fichier modifié seulement par ajout,
+			{																			// #  seuls les morceaux ajoutés depuis la signature précédente sont hashés
+				printf("Le choix que vous avez fait n'a pas été compris, le fichier n'a-t-il été modifié que par ajout à la fin (attendu Y ou N)?\n\n");	// #
+				scanf(" %c",&choix);													// #
+			}																			// #
+		}																				// #
+		if(SHA256_arbre(nom_fichier_a_chiffrer, nom_manifeste, choix == 'Y') != 0)		// #
+		{																				// #
+			printf("\nLe fichier ne peut pas être lu, la signature n'est pas créée.\n\n");	// #
+			fclose(cypher);																// #
+			remove(nom_fichier_chiffrer);												// #
+			return;																		// #
+		}																				// #
+		clair = fopen(travail.hasher,"rb+");											// #
+	}																					// ##
+
+
+
+	STATS_DEBUT(STAT_TOTAL);															// Début du chronométrage de l'opération
+	cle_en_magasin* privee = NULL;														// #  Pas de clef privée pour chiffrer
+
+	if(signature != 0)																	// ##
+	{																					// #
+		char nom_fichier_cle_privee[100];												// #
+																						// #
+		etiquette4:																		// #
+			printf("\nQuel est le nom du fichier contenant la clé privée?\n\n");		// #
+			scanf(" %99s", nom_fichier_cle_privee);										// #  Pour une signature on charge la clef privée
+			if(access( nom_fichier_cle_privee, F_OK ) != 0)								// #
+			{																			// #
+				printf("\nAttention, le nom de fichier saisi n'existe pas!");			// #
+				goto etiquette4;														// #
+			}																			// #
+		privee = charger_cle(nom_fichier_cle_privee,1);									// #
+		if(privee == NULL)																// #
+		{																				// #
+			printf("\nAttention, le fichier saisi ne contient pas une clé privée valable!");	// #
+			goto etiquette4;															// #
+		}																				// #
+	}																					// ##
+
+	chiffrer_fichier(clair,cypher,publique->cle.n,privee,format);						// #  Padding puis chiffrement ou signature de tout le fichier
+
+    fclose(clair);																		// ##
+	fclose(cypher);																		// #
+	if(signature != 0)																	// #  Fermeture et suppression des fichiers
+	{																					// #
+		remove(travail.hasher);															// #
+	}																					// ##
+
+	STATS_FIN(STAT_TOTAL);																// ##
+	STATS_EXPORTER(signature == 0 ? "chiffrement" : (signature == 1 ? "signature" : "signature_arbre"));						// ##  Export des statistiques de l'opération
+};
+
+
+// Cette fonction sert à chiffrer un même fichier pour plusieurs destinataires, chacun recevant son propre chiffré
+// Entrée : un entier format (FORMAT_PREFIXE, FORMAT_COMPACT ou FORMAT_COMPRESSE) pour les chiffrés
+// Sortie : vide mais on crée un fichier chiffré par destinataire
+void encrypt_destinataires(unsigned int format)
+{
+	char choix;
+	int nb;
+	destinataire destinataires[MAX_DESTINATAIRES];
+	char noms_chiffres[MAX_DESTINATAIRES][100];
+	STATS_REINITIALISER();
+
+	printf("\nPour combien de destinataires souhaitez-vous chiffrer (entre 1 et %d)?\n\n", MAX_DESTINATAIRES);			// ##
+	scanf(" %d", &nb);																									// #
+	while((nb < 1) | (nb > MAX_DESTINATAIRES))																			// #  Choix du nombre de destinataires
+	{																													// #
+		printf("\nLe nombre que vous avez indiqué n'est pas valable, pour combien de destinataires (entre 1 et %d)?\n\n", MAX_DESTINATAIRES);	// #
+		scanf(" %d", &nb);																								// #
+	}																													// ##
+
+	for(int i = 0; i < nb; i++)
 	{
-		mpz_fdiv_q(div,z_X,puissance);					// ##
-		A = mpz_get_ui(div);							// #  Récupération d'une valeur hexadécimale de X
-		c2 = int_to_hex(A);								// ##
+		char nom_fichier_cle_publique[100];													// ##
+																							// #
+		etiquette:																			// #
+   			printf("\nQuel est le nom du fichier contenant la clé publique du destinataire %d?\n\n", i+1);	// #
+    		scanf(" %99s", nom_fichier_cle_publique);										// #
+			if(access( nom_fichier_cle_publique, F_OK ) != 0)								// #  Chargement de la clé publique, le module est copié car le magasin
+			{																				// #  peut réutiliser l'entrée pour les clefs suivantes
+				printf("\nAttention, le nom de fichier saisi n'existe pas!");				// #
+				goto etiquette;																// #
+			}																				// #
+		cle_en_magasin* publique = charger_cle(nom_fichier_cle_publique,0);					// #
+		if(publique == NULL)																// #
+		{																					// #
+			printf("\nAttention, le fichier saisi ne contient pas une clé publique valable!");	// #
+			goto etiquette;																	// #
+		}																					// #
+		mpz_init_set(destinataires[i].n, publique->cle.n);									// ##
 
-		c1 = fgetc(MGF);								// #  Récupération d'une valeur hexadécimale de MGF1(r)
+		char* nom_fichier_chiffrer = noms_chiffres[i];																						// ##
+																																			// #
+		etiquette2:																															// #
+			printf("\nQuel est le nom du fichier dans lequel vous désirez stocker le chiffré du destinataire %d?\n\n", i+1);				// #
+			scanf(" %99s", nom_fichier_chiffrer);																							// #
+			if(access( nom_fichier_chiffrer, F_OK ) == 0)																					// #
+			{																																// #
+				printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
+				scanf(" %c",&choix);																										// #  Création ou édition et ouverture du fichier de destination
+				while((choix != 'Y') & (choix != 'N'))																						// #
+				{																															// #
+					printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
+					scanf(" %c",&choix);																									// #
+				}																															// #
+																																			// #
+				if(choix == 'N')																											// #
+				{																															// #
+					goto etiquette2;																										// #
+				}																															// #
+			}																																// #
+		destinataires[i].cypher = fopen(nom_fichier_chiffrer,"wb+");																		// #
+		if(destinataires[i].cypher == NULL)																									// #
+		{																																	// #
+			printf("\nAttention, le fichier %s ne peut pas être créé pour le destinataire %d!", nom_fichier_chiffrer, i+1);				// #
+			goto etiquette2;																												// #
+		}																																	// ##
+	}
+
+	char nom_fichier_a_chiffrer[100];													// ##
+																						// #
+	etiquette3:																			// #
+   		printf("\nQuel est le nom du fichier que vous désirez chiffrer?\n\n");			// #
+    	scanf(" %99s", nom_fichier_a_chiffrer);											// #  Ouverture du fichier à chiffrer
+    	if(access( nom_fichier_a_chiffrer, F_OK ) != 0)									// #
+		{																				// #
+			printf("\nAttention, le nom de fichier saisi n'existe pas!");				// #
+			goto etiquette3;															// #
+		}																				// #
+	FILE* clair = fopen(nom_fichier_a_chiffrer,"rb");									// #
+	if(clair == NULL)																	// #
+	{																					// #
+		printf("\nAttention, le fichier saisi ne peut pas être lu!");					// #
+		goto etiquette3;																// #
+	}																					// ##
+
+	STATS_DEBUT(STAT_TOTAL);															// Début du chronométrage de l'opération
+	unsigned int echec = chiffrer_fichier_destinataires(clair, destinataires, nb, format);	// #  Une lecture du clair, un pipeline de chiffrement par destinataire
+	if(echec != 0)																		// ##
+	{																					// #
+		printf("\nLe tube du destinataire %u n'a pas pu être créé, aucun chiffré n'est écrit.\n\n", echec);	// #  Echec d'un destinataire : tous les chiffrés sont supprimés
+	}																					// ##
+
+	fclose(clair);																		// ##
+	for(int i = 0; i < nb; i++)															// #
+	{																					// #
+		fclose(destinataires[i].cypher);												// #
+		if(echec != 0)																	// #  Fermeture des fichiers
+		{																				// #
+			remove(noms_chiffres[i]);													// #
+		}																				// #
+		mpz_clear(destinataires[i].n);													// #
+	}																					// ##
+
+	STATS_FIN(STAT_TOTAL);																// ##
+	STATS_EXPORTER("chiffrement_destinataires");										// ##  Export des statistiques de l'opération
+};
+
+
+// Cette fonction déchiffre tous les blocs d'un fichier et retire leur padding OAEP, sans rien demander à l'utilisateur
+// Lecture, exponentiation, retrait du padding et écriture se recouvrent dans un pipeline
+// Entrée : deux flux cypher et clair, une clef, deux entiers crt et temps_constant comme pour decrypt() et un contexte d'aveuglement (NULL pour ne pas aveugler)
+// Sortie : vide mais le clair est écrit dans clair
+void dechiffrer_fichier(FILE* cypher, FILE* clair, cle_rsa* cle, unsigned int crt, unsigned int temps_constant, contexte_aveuglement* aveuglement)
+{
+	pipeline_rsa pipeline;															// ##
+	pipeline.entree = cypher;														// #
+	pipeline.sortie = clair;														// #
+	pipeline.taille_n = taille_256(cle->n)-1;										// #  Taille d'un bloc en base 256
+	pipeline.cle = cle;																// #
+	pipeline.crt = crt;																// #
+	pipeline.temps_constant = temps_constant;										// #
+	pipeline.aveuglement = aveuglement;												// #
+	pipeline.nb_destinataires = 1;													// ##
+
+	fseek(cypher,0,SEEK_END);														// ##
+    pipeline.taille_fichier = ftell(cypher);										// #  On récupère la taille du fichier à déchiffrer ou de la signature à déchiffrer
+    rewind(cypher);																	// ##
+    STATS_AJOUTER(STAT_OCTETS_LUS,pipeline.taille_fichier);							// Comptage des octets lus
+
+	entete_compact entete;															// ##
+	pipeline.format = FORMAT_PREFIXE;												// #
+	pipeline.drapeaux = 0;															// #
+	if((fread(&entete, sizeof(entete), 1, cypher) == 1) && (memcmp(entete.magique, MAGIQUE_COMPACT, 4) == 0))	// #
+	{																				// #
+		uint32_t drapeaux = lire_entier(entete.drapeaux, 4);						// #
+		if((drapeaux & ~DRAPEAUX_CONNUS) != 0)										// #
+		{																			// #  Reconnaissance du format compact par son en-tête
+			printf("\nLe chiffré utilise des options inconnues de cette version.\n");	// #
+			return;																	// #
+		}																			// #
+		pipeline.format = FORMAT_COMPACT;											// #
+		pipeline.drapeaux = drapeaux;												// #
+	}																				// #
+	else																			// #
+	{																				// #
+		rewind(cypher);																// #
+	}																				// ##
+
+	if(pipeline.drapeaux & DRAPEAU_LZ77)											// ##
+	{																				// #  Décompression au fil de l'écriture
+		init_decompresseur_lz77(&pipeline.decompresseur);							// #
+	}																				// ##
+
+	executer_pipeline(&pipeline, lecture_chiffre, exponentiation_pipeline, retrait_padding_pipeline);	// #  Lecture, déchiffrement, retrait du padding et écriture en parallèle
+
+	if((pipeline.drapeaux & DRAPEAU_LZ77) && (clear_decompresseur_lz77(&pipeline.decompresseur) != 0))	// ##
+	{																				// #  Un flux tronqué ou altéré s'arrête à la dernière trame valide
+		printf("\nLe clair compressé est invalide, seules les trames valides ont été écrites.\n");	// #
+	}																				// ##
+
+	STATS_AJOUTER(STAT_OCTETS_ECRITS,ftell(clair));									// Comptage des octets écrits
+};
+
+
+// Cette fonction traduit un mode de déchiffrement du menu en valeurs crt et temps_constant pour decrypt()
+// Entrée : un entier mode entre 1 et 6 et deux pointeurs crt et temps_constant
+// Sortie : vide mais crt et temps_constant sont remplis
+void mode_dechiffrement(unsigned int mode, unsigned int* crt, unsigned int* temps_constant)
+{
+	if(mode <= 4)								// ##
+	{											// #  Modes classique et CRT, à temps variable puis constant
+		*crt = (mode-1)%2;						// #
+		*temps_constant = (mode-1)/2;			// #
+	}											// ##
+	else										// ##
+	{											// #  Modes CRT parallèle
+		*crt = 2;								// #
+		*temps_constant = mode-5;				// #
+	}											// ##
+};
+
+
+// Cette fonction sert à déchiffrer un fichier en mode standard ou en mode crt ou à déchiffrer une signature
+// Entrée : trois entiers crt, signature et temps_constant, si signature vaut 0 on déchiffre, si signature vaut 1 on déchiffre une signature. Si crt vaut 0 on dechiffre en mode standard si crt vaut 1 on déchiffre en mode crt, si crt vaut 2 en mode crt avec les deux moitiés calculées en parallèle. Si temps_constant vaut 1 les exponentiations privées utilisent exp_mod_sec().
+// Sortie : vide mais on crée un fichier contenant le clair ou la signature déchiffrée
+void decrypt(unsigned int crt, unsigned int signature, unsigned int temps_constant)
+{														
+	char choix;																				// ##
+    cle_rsa* cle;																			// #  Initialisation des variables
+	if(signature == 0)																		// #
+	{																						// #  La vérification de signature gère elle-même ses statistiques
+		STATS_REINITIALISER();																// #
+	}																						// #
+	cle_en_magasin* privee;																	// ##
+
+	char nom_fichier_a_dechiffrer[100];														// ##
+	etiquette:																				// #
+		if(signature == 0)																	// #
+		{																					// #
+			printf("\nQuel est le nom du fichier que vous souhaitez déchiffrer? \n\n");		// #
+		}																					// #
+		else																				// #
+		{																					// #
+			printf("\nQuel est le nom du fichier contenant la signature? \n\n");			// #  Ouverture du fichier à déchiffrer ou de la signature à déchiffrer
+		}																					// #
+		scanf(" %99s", nom_fichier_a_dechiffrer);											// #
+		if(access( nom_fichier_a_dechiffrer, F_OK ) != 0)									// #
+		{																					// #
+			printf("\nAttention, le nom de fichier saisi n'existe pas!");					// #
+			goto etiquette;																	// #
+		}																					// #
+	FILE* cypher = fopen(nom_fichier_a_dechiffrer,"rb+");									// ##
+
+
+
+    char nom_fichier_cle_publique[100];														// ##
+    etiquette2:																				// #
+		printf("\nQuel est le nom du fichier contenant la clé publique?\n\n");				// #
+		scanf(" %99s", nom_fichier_cle_publique);											// #
+		if(access( nom_fichier_cle_publique, F_OK ) != 0)									// #  Ouverture du fichier contenant la clef publique
+		{																					// #
+			printf("\nAttention, le nom de fichier saisi n'existe pas!");					// #
+			goto etiquette2;																// #
+		}																					// #
+	cle_en_magasin* publique = charger_cle(nom_fichier_cle_publique,0);						// #
+	if(publique == NULL)																	// #
+	{																						// #
+		printf("\nAttention, le fichier saisi ne contient pas une clé publique valable!");	// #
+		goto etiquette2;																	// #
+	}																						// ##
+
+
+	if(signature == 0)																		// ##
+	{																						// #
+		char nom_fichier_cle_privee[100];													// #
+	    etiquette3:																			// #
+			printf("\nQuel est le nom du fichier contenant la clé privée?\n\n");			// #
+			scanf(" %99s", nom_fichier_cle_privee);											// #
+			if(access( nom_fichier_cle_privee, F_OK ) != 0)									// #
+			{																				// #
+				printf("\nAttention, le nom de fichier saisi n'existe pas!");				// #  Choix entre déchiffrement d'un fichier chiffré ou d'une signature :
+				goto etiquette3;															// #
+			}																				// #  	- fichier chiffré : on récupère les clefs privées stockées dans un fichier et on les initialise (d vaut la valeur de la clef privée)
+		privee = charger_cle(nom_fichier_cle_privee,1);										// #
+		if(privee == NULL)																	// #
+		{																					// #
+			printf("\nAttention, le fichier saisi ne contient pas une clé privée valable!");	// #
+			goto etiquette3;																// #
+		}																					// #
+		cle = &privee->cle;																	// #  	- signature chiffrée : on utilise la clef publique (d vaut l'exposant publique 65537)
+	}																						// #
+	else																					// #  Les clefs viennent du magasin, avec dp, dq et l'aveuglement déjà calculés
+	{																						// #
+		cle = &publique->cle;																// #
+	}																						// ##
+
+
+	FILE* clair;																															// ##
+	if(signature == 0)																														// #
+	{																																		// #
+		char nom_fichier_dechiffrer[100];																									// #
+		etiquette4:																															// #
+			printf("\nQuel est le nom du fichier dans lequel vous désirez stocké le clair? \n\n");											// #
+			scanf(" %99s", nom_fichier_dechiffrer);																							// #
+			if(access( nom_fichier_dechiffrer, F_OK ) == 0)																					// #
+			{																																// #
+				printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
+				scanf(" %c",&choix);																										// #
+				while((choix != 'Y') & (choix != 'N'))																						// #
+				{																															// #
+					printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #  Création et ouverture du fichier destination où l'on stocke le clair ou la signature à vérifier après déchiffrement
+					scanf(" %c",&choix);																									// #
+				}																															// #
+																																			// #
+				if(choix == 'N')																											// #
+				{																															// #
+					goto etiquette4;																										// #
+				}																															// #
+			}																																// #
+		clair = fopen(nom_fichier_dechiffrer,"wb");																						// #
+	}																																		// #
+	else																																	// #
+	{																																		// #
+		clair = fopen(travail.signature,"wb+");																								// #
+	}																																		// ##
+
+	STATS_DEBUT(STAT_TOTAL);														// Début du chronométrage de l'opération
+	if(signature == 0)																// ##
+	{																				// #
+		dechiffrer_fichier(cypher,clair,cle,crt,temps_constant,&privee->aveuglement);	// #  Déchiffrement aveuglé pour les opérations privées
+	}																				// #
+	else																			// #
+	{																				// #  Déchiffrement de la signature avec l'exposant public
+		dechiffrer_fichier(cypher,clair,cle,0,0,NULL);								// #
+	}																				// ##
+
+	fclose(cypher);																	// ##
+	fclose(clair);																	// ##  Fermeture des fichiers
+
+	STATS_FIN(STAT_TOTAL);															// ##
+	if(signature == 0)																// #  Export des statistiques du déchiffrement
+	{																				// #
+		STATS_EXPORTER("dechiffrement");											// #
+	}																				// ##
+};
+
+
+// Cette fonction compare le hash du fichier original (fichier HASHER) à la signature déchiffrée puis supprime ces deux fichiers intermédiaires
+// Entrée : vide
+// Sortie : 1 si la signature est valide, 0 sinon
+int comparer_empreintes()
+{
+	int caractere1, caractere2;
+	FILE* cypher = fopen(travail.hasher,"rb+");										// ##
+	FILE* signature = fopen(travail.signature,"rb+");								// ##  Ouverture du hash et de la signature déchiffrée
+
+	caractere1 = fgetc(cypher);														// ##
+	caractere2 = fgetc(signature);													// #
+	while((caractere1 != EOF) & (caractere2 != EOF) & (caractere1 == caractere2))	// #
+	{																				// #  Comparaison octet par octet des deux fichiers
+		caractere1 = fgetc(cypher);													// #
+		caractere2 = fgetc(signature);												// #
+	}																				// ##
+
+	fclose(cypher);																	// ##
+	fclose(signature);																// #  Fermeture des fichiers et suppression des fichiers intermédiaires
+	remove(travail.signature);														// #
+	remove(travail.hasher);															// ##
+
+	return caractere1 == caractere2;
+};
+
+
+// Cette fonction vérifie la signature d'un fichier sans rien demander à l'utilisateur
+// Entrée : deux chaînes de caractère contenant les noms du fichier de signature et du fichier original et une clef publique
+// Sortie : 1 si la signature est valide, 0 sinon
+int verifier_signature(char* nom_fichier_signature, char* nom_fichier_original, cle_rsa* publique)
+{
+	FILE* cypher = fopen(nom_fichier_signature,"rb");								// ##
+	FILE* clair = fopen(travail.signature,"wb+");									// #
+	dechiffrer_fichier(cypher,clair,publique,0,0,NULL);								// #  Déchiffrement de la signature avec l'exposant public
+	fclose(cypher);																	// #
+	fclose(clair);																	// ##
+
+	if(SHA256(nom_fichier_original) != 0)											// #
+	{																				// #
+		remove(travail.signature);													// #  Hash du fichier original et comparaison, un fichier illisible
+		return 0;																	// #  ne valide pas la signature
+	}																				// #
+	return comparer_empreintes();													// #
+};
+
+
+// Cette fonction sert à vérifier une signature
+// Entrée : un entier arbre, si arbre vaut 1 la signature porte sur la racine de l'arbre de Merkle du fichier
+// Sortie : vide mais affichage de la validité de la signature
+void verification_signature(unsigned int arbre)
+{
+	STATS_REINITIALISER();
+	decrypt(0,1,0);																// #  Déchiffrement de la signature
+
+	char nom_fichier_a_verifier[100];																				// ##
+	etiquette:																										// #
+		printf("\nQuel est le nom du fichier original dont vous voulez vérifier la signature associée? \n\n");		// #
+		scanf(" %99s", nom_fichier_a_verifier);																		// #
+		if(access( nom_fichier_a_verifier, F_OK ) != 0)																// #  Choix et hash du fichier original
+		{																											// #
+			printf("\nAttention, le nom de fichier saisi n'existe pas!");											// #
+			goto etiquette;																							// #
+		}																											// #
+	STATS_DEBUT(STAT_TOTAL);																						// #
+	int erreur;																										// #
+	if(arbre == 1)																									// #
+	{																												// #
+		erreur = SHA256_arbre(nom_fichier_a_verifier,NULL,0);														// #
+	}																												// #
+	else																											// #
+	{																												// #
+		erreur = SHA256(nom_fichier_a_verifier);																	// #
+	}																												// ##
+
+	if(erreur != 0)																	// ##
+	{																				// #
+		remove(travail.signature);													// #
+		printf("\nLe fichier original ne peut pas être lu, la signature n'est pas vérifiée.\n\n");	// #
+	}																				// #
+	else if(comparer_empreintes() == 1)												// #
+	{																				// #
+		printf("\nLa signature est valide!\n\n");									// #
+	}																				// #  Affichage du résultat
+	else																			// #
+	{																				// #
+		printf("\nLa signature est invalide.\n\n");									// #
+	}																				// ##
 
-		c3 = XOR(c1,c2);								// #  XOR entre X et MGF1(r)
+	STATS_FIN(STAT_TOTAL);															// ##
+	STATS_EXPORTER("verification_signature");										// ##  Export des statistiques de la vérification
+};
 
-		if(mpz_cmp_ui(div,0)!=0)						// ##
-		{												// #
-			mpz_mul(puissance,puissance,div);			// #
-			mpz_sub(z_X,z_X,puissance);					// #  Décrémentation de puissance et de X
-			mpz_divexact(puissance,puissance,div);		// #
-		}												// #
-		mpz_divexact_ui(puissance,puissance,16);		// ##
-		
-		B = hex_to_int(c3);								// #  Stockage du résultat dans lettre
-		lettre = B * 16;								// #
-		
-		mpz_fdiv_q(div,z_X,puissance);					// ##
-		A = mpz_get_ui(div);							// #  Récupération d'une valeur hexadécimale de X
-		c2 = int_to_hex(A);								// ##
-		
-		c1 = fgetc(MGF);								// #  Récupération d'une valeur hexadécimale de MGF1(r)
 
-		c3 = XOR(c1,c2);								// #  XOR entre X et MGF1(r)
+#define LOT_VERIFICATION 16			// Le nombre d'entrées du manifeste qu'un worker prend à la fois
 
-		if(mpz_cmp_ui(div,0)!=0)						// ##
-		{												// #
-			mpz_mul(puissance,puissance,div);			// #
-			mpz_sub(z_X,z_X,puissance);					// #  Décrémentation de puissance et de X
-			mpz_divexact(puissance,puissance,div);		// #
-		}												// #
-		mpz_divexact_ui(puissance,puissance,16);		// ##
 
-		B = hex_to_int(c3);								// #  Stockage du résultat dans lettre
-		lettre = lettre + B;							// #
+// Entrée d'un manifeste de vérification : fichier original, signature, clef publique, numéro de ligne et résultat (1 valide, 0 invalide, -1 erreur, -2 ligne mal formée)
+typedef struct
+{
+	char fichier[100];
+	char signature[100];
+	char clef[100];
+	unsigned long ligne;
+	int resultat;
+} entree_manifeste;
 
-		if (dernier==0)									// ##
-		{												// #
-			fputc(lettre,clair);						// #
-		}												// #
-		else											// #
-		{												// #  Ecriture d'un octet du résultat dans le fichier clair
-			if (j < rtemp)								// #
-			{											// #
-				fputc(lettre,clair);					// #
-			}											// #
-		}												// #
-		lettre = 0;										// ##
-	}
 
-	mpz_clears(puissance,z_X,div,temp,r,l,NULL);		// ##
-	fclose(MGF);										// #  Fermeture et suppression du fichier MGF1
-	remove("MGF1");										// ##
-}
+// Travail partagé par les workers de la vérification par lot
+typedef struct
+{
+	entree_manifeste* entrees;
+	unsigned long nb_entrees;
+	unsigned long suivante;
+} verification_lot;
 
 
-// Cette fonction sert soit à chiffrer un fichier, soit à signer un fichier 
-// Entrée : un entier signature, si signature vaut 0 on chiffre, si signature vaut 1 on signe
-// Sortie : vide mais on crée soit un fichier contenant un chiffré ou un fichier contenant une signature
-void encrypt(unsigned int signature) 
+// Cette fonction vérifie une signature entièrement en mémoire : chaque bloc est élevé à la puissance publique, le padding est retiré puis le résultat est comparé au hash attendu
+// Entrée : un flux signature, une empreinte SHA-256 de 32 octets du fichier original et une clef publique
+// Sortie : 1 si la signature est valide, 0 sinon
+int verifier_signature_memoire(FILE* signature, unsigned char* empreinte, cle_rsa* publique)
 {
-	char choix;
-
-	char nom_fichier_cle_publique[100];													// ##
-																						// #
-	etiquette:																			// #
-   		printf("\nQuel est le nom du fichier contenant la clé publique?\n\n");			// #
-    	scanf(" %99s", nom_fichier_cle_publique);										// #
-		if(access( nom_fichier_cle_publique, F_OK ) != 0)								// #  Ouverture du fichier contenant la clé publique
+	mpz_t h, bloc;																		// ##
+	mpz_inits(h, bloc, NULL);															// #
+	char* attendu;																		// #
+	size_t taille_attendu;																// #  Hash attendu écrit comme le fichier HASHER
+	FILE* flux_attendu = open_memstream(&attendu, &taille_attendu);						// #
+	mpz_import(h,32,1,1,1,0,empreinte);													// #
+	mpz_out_raw(flux_attendu,h);														// #
+	fclose(flux_attendu);																// ##
+
+	char* obtenu;																		// ##
+	size_t taille_obtenu;																// #
+	FILE* flux_obtenu = open_memstream(&obtenu, &taille_obtenu);						// #
+	fseek(signature,0,SEEK_END);														// #
+	unsigned long taille_signature = ftell(signature);									// #
+	rewind(signature);																	// #
+	unsigned long compteur = 0;															// #
+	int taille_n = taille_256(publique->n)-1;											// #
+	while(compteur < taille_signature)													// #
+	{																					// #
+		size_t lu = mpz_inp_raw(bloc,signature);										// #  Déchiffrement de la signature avec l'exposant public
+		if(lu == 0)																		// #
 		{																				// #
-			printf("\nAttention, le nom de fichier saisi n'existe pas!");				// #
-			goto etiquette;																// #
+			break;																		// #
 		}																				// #
-    FILE* publique = fopen(nom_fichier_cle_publique,"rb+");								// ##
+		compteur = compteur + lu;														// #
+		dechiffrer_bloc(bloc,publique,0,0,NULL);										// #
+		inv_OAEP(taille_n,compteur == taille_signature,bloc,flux_obtenu);				// #
+	}																					// #
+	fclose(flux_obtenu);																// ##
 
+	int valide = (compteur == taille_signature) && (taille_obtenu == taille_attendu) && (memcmp(obtenu, attendu, taille_attendu) == 0);	// #  Comparaison en mémoire
 
-	char nom_fichier_a_chiffrer[100];													// ##
-																						// #
-	etiquette2:																			// #
-		if(signature == 0)																// #
-		{																				// #
-   			printf("\nQuel est le nom du fichier que vous désirez chiffrer?\n\n");		// #
-   		}																				// #
-   		else																			// #
-   		{																				// #  Ouverture du fichier contenant le fichier que l'on va signer ou chiffrer
-   			printf("\nQuel est le nom du fichier que vous désirez signer?\n\n");		// #
-   		}																				// #
-    	scanf(" %99s", nom_fichier_a_chiffrer);											// #
-    	if(access( nom_fichier_a_chiffrer, F_OK ) != 0)									// #
-		{																				// #
-			printf("\nAttention, le nom de fichier saisi n'existe pas!");				// #
-			goto etiquette2;															// #
-		}																				// #
-	FILE* clair;																		// #
-	if(signature == 0)																	// #
-	{																					// #
-   		clair = fopen(nom_fichier_a_chiffrer,"rb+");									// #
-   	}																					// #
-   	else																				// #
-   	{																					// #
-   		SHA256(nom_fichier_a_chiffrer);													// #
-   		clair = fopen("HASHER","rb+");													// #
-   	}																					// #
-																						// ##
+	free(attendu);
+	free(obtenu);
+	mpz_clears(h, bloc, NULL);
+	return valide;
+};
 
 
-    char nom_fichier_chiffrer[100];																										// ##
-    																																	// #
-    etiquette3:																															// #
-    	if (signature == 0)																												// #
-    	{																																// #
-    		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker le chiffré ?\n\n");									// #
-    	}																																// #
-    	else																															// #
-    	{																																// #
-    		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker la signature?\n\n");									// #
-    	}																																// #
-   		scanf(" %99s", nom_fichier_chiffrer);																							// #
-   		if(access( nom_fichier_chiffrer, F_OK ) == 0)																					// #
-		{																																// #  Création ou édition et ouverture du fichier de destination
+// Cette fonction est exécutée par chaque worker de la vérification par lot : elle prend les entrées du manifeste par paquets de LOT_VERIFICATION
+// Entrée : un pointeur vers le travail partagé
+// Sortie : NULL
+void* verifier_lot(void* argument)
+{
+	verification_lot* lot = argument;
+	unsigned char empreinte[32];
+
+	while(1)
+	{
+		unsigned long debut = __atomic_fetch_add(&lot->suivante, LOT_VERIFICATION, __ATOMIC_RELAXED);	// #  Réservation d'un paquet d'entrées
+		if(debut >= lot->nb_entrees)
+		{
+			break;
+		}
+		for(unsigned long i = debut; (i < debut + LOT_VERIFICATION) && (i < lot->nb_entrees); i++)
+		{
+			entree_manifeste* entree = &lot->entrees[i];
+			if(entree->resultat == -2)																	// ##
+			{																							// #  Ligne mal formée, rien à vérifier
+				continue;																				// #
+			}																							// ##
+			if((access(entree->fichier, R_OK) != 0) || (access(entree->signature, R_OK) != 0) || (access(entree->clef, R_OK) != 0))	// ##
+			{																							// #  Fichier manquant
+				entree->resultat = -1;																	// #
+				continue;																				// #
+			}																							// ##
+			cle_en_magasin* publique = charger_cle(entree->clef,0);										// ##
+			if(publique == NULL)																		// #
+			{																							// #  Clef servie par le magasin du worker, une clef illisible
+				entree->resultat = -1;																	// #  donne une erreur pour cette ligne seulement
+				continue;																				// #
+			}																							// ##
+			STATS_DEBUT(STAT_HACHAGE);																	// ##
+			int erreur = sha256_fichier(entree->fichier,empreinte);										// #
+			STATS_FIN(STAT_HACHAGE);																	// #
+			STATS_AJOUTER(STAT_HACHAGES,1);																// #  Hash en mémoire du fichier original
+			if(erreur != 0)																				// #
+			{																							// #
+				entree->resultat = -1;																	// #
+				continue;																				// #
+			}																							// ##
+			FILE* signature = fopen(entree->signature,"rb");											// ##
+			if(signature == NULL)																		// #
+			{																							// #
+				entree->resultat = -1;																	// #
+				continue;																				// #  Vérification de la signature
+			}																							// #
+			entree->resultat = verifier_signature_memoire(signature,empreinte,&publique->cle);			// #
+			fclose(signature);																			// ##
+		}
+	}
+
+	vider_magasin_cles();
+	return NULL;
+};
+
+
+// Cette fonction lit une ligne du manifeste et découpe ses trois champs, une ligne trop longue est lue jusqu'au bout pour ne pas décaler les suivantes
+// Entrée : un flux manifeste et une entrée à remplir
+// Sortie : 1 si l'entrée est remplie, 0 pour une ligne vide, -1 pour une ligne mal formée (nombre de champs ou chemin trop long) et -2 à la fin du manifeste
+int lire_ligne_manifeste(FILE* manifeste, entree_manifeste* entree)
+{
+	char ligne[512];																			// ##
+	if(fgets(ligne, sizeof(ligne), manifeste) == NULL)											// #
+	{																							// #
+		return -2;																				// #
+	}																							// #
+	size_t longueur = strlen(ligne);															// #
+	if((longueur > 0) && (ligne[longueur-1] != '\n') && (feof(manifeste) == 0))				// #  Lecture de la ligne entière
+	{																							// #
+		int c;																					// #
+		while(((c = fgetc(manifeste)) != EOF) && (c != '\n'));									// #
+		return -1;																				// #
+	}																							// ##
+
+	char* champs[4];																			// ##
+	unsigned int nb_champs = 0;																	// #
+	char* suite;																				// #
+	char* champ = strtok_r(ligne, " \t\r\n", &suite);											// #
+	while((champ != NULL) && (nb_champs < 4))													// #
+	{																							// #
+		champs[nb_champs] = champ;																// #
+		nb_champs++;																			// #
+		champ = strtok_r(NULL, " \t\r\n", &suite);												// #
+	}																							// #  Découpage en champs, chacun doit tenir dans l'entrée sans être tronqué
+	if(nb_champs == 0)																			// #
+	{																							// #
+		return 0;																				// #
+	}																							// #
+	if((nb_champs != 3) || (strlen(champs[0]) >= sizeof(entree->fichier)) || (strlen(champs[1]) >= sizeof(entree->signature)) || (strlen(champs[2]) >= sizeof(entree->clef)))	// #
+	{																							// #
+		return -1;																				// #
+	}																							// ##
+
+	strcpy(entree->fichier, champs[0]);															// ##
+	strcpy(entree->signature, champs[1]);														// #  Copie des champs
+	strcpy(entree->clef, champs[2]);															// #
+	return 1;																					// ##
+};
+
+
+// Cette fonction vérifie toutes les signatures d'un manifeste, une ligne "fichier signature clef_publique" par signature
+// Les fichiers sont hashés et vérifiés en parallèle sur tous les coeurs et les résultats sont écrits une ligne par entrée, dans l'ordre du manifeste
+// Entrée : vide
+// Sortie : vide mais le fichier de résultats est créé
+void verification_lot_signatures()
+{
+	char choix;
+	STATS_REINITIALISER();
+
+	char nom_manifeste[100];																					// ##
+	etiquette:																									// #
+		printf("\nQuel est le nom du manifeste (une ligne \"fichier signature clef_publique\" par signature)?\n\n");	// #
+		scanf(" %99s", nom_manifeste);																			// #  Choix du manifeste
+		if(access( nom_manifeste, F_OK ) != 0)																	// #
+		{																										// #
+			printf("\nAttention, le nom de fichier saisi n'existe pas!");										// #
+			goto etiquette;																						// #
+		}																										// #
+	FILE* manifeste = fopen(nom_manifeste,"r");																	// #
+	if(manifeste == NULL)																						// #
+	{																											// #
+		printf("\nAttention, le manifeste ne peut pas être ouvert!");											// #
+		goto etiquette;																							// #
+	}																											// ##
+
+	char nom_resultats[100];																											// ##
+	etiquette2:																															// #
+		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker les résultats?\n\n");										// #
+		scanf(" %99s", nom_resultats);																									// #
+		if(access( nom_resultats, F_OK ) == 0)																							// #
+		{																																// #
 			printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
 			scanf(" %c",&choix);																										// #
-			while((choix != 'Y') & (choix != 'N'))																						// #
+			while((choix != 'Y') & (choix != 'N'))																						// #  Choix du fichier de résultats
 			{																															// #
 				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
 				scanf(" %c",&choix);																									// #
 			}																															// #
-																																		// #
 			if(choix == 'N')																											// #
 			{																															// #
-				goto etiquette3;																										// #
+				goto etiquette2;																										// #
 			}																															// #
 		}																																// #
-	FILE* cypher = fopen(nom_fichier_chiffrer,"wb+");																					// ##
+	FILE* resultats = fopen(nom_resultats,"w");																							// #
+	if(resultats == NULL)																												// #
+	{																																	// #
+		printf("\nAttention, le fichier de résultats ne peut pas être créé!");															// #
+		goto etiquette2;																												// #
+	}																																	// ##
+
+	STATS_DEBUT(STAT_TOTAL);
+	verification_lot lot = {NULL, 0, 0};																// ##
+	unsigned long capacite = 0;																			// #
+	unsigned long numero_ligne = 0;																		// #
+	int lecture = 0;																					// #
+	while(lecture != -2)																				// #
+	{																									// #
+		if(lot.nb_entrees == capacite)																	// #
+		{																								// #
+			capacite = 2*capacite + 64;																	// #
+			entree_manifeste* agrandi = realloc(lot.entrees, capacite * sizeof(entree_manifeste));		// #
+			if(agrandi == NULL)																			// #
+			{																							// #
+				printf("\nAttention, mémoire insuffisante, seules les %lu premières entrées du manifeste sont vérifiées.\n", lot.nb_entrees);	// #  Lecture du manifeste, les lignes vides sont ignorées
+				break;																					// #  et une ligne mal formée donne une erreur dans les résultats
+			}																							// #
+			lot.entrees = agrandi;																		// #
+		}																								// #
+		entree_manifeste* entree = &lot.entrees[lot.nb_entrees];										// #
+		lecture = lire_ligne_manifeste(manifeste, entree);												// #
+		numero_ligne++;																					// #
+		if((lecture == 1) || (lecture == -1))															// #
+		{																								// #
+			entree->ligne = numero_ligne;																// #
+			entree->resultat = (lecture == 1) ? -1 : -2;												// #
+			lot.nb_entrees++;																			// #
+		}																								// #
+	}																									// #
+	fclose(manifeste);																					// ##
+
+	unsigned int nb_workers = sysconf(_SC_NPROCESSORS_ONLN);											// ##
+	pthread_t* workers = malloc(nb_workers * sizeof(pthread_t));										// #
+	for(unsigned int i = 0; i < nb_workers; i++)														// #
+	{																									// #
+		pthread_create(&workers[i], NULL, verifier_lot, &lot);											// #  Vérification en parallèle
+	}																									// #
+	for(unsigned int i = 0; i < nb_workers; i++)														// #
+	{																									// #
+		pthread_join(workers[i], NULL);																	// #
+	}																									// #
+	free(workers);																						// ##
+
+	unsigned long nb_valides = 0, nb_invalides = 0, nb_erreurs = 0;										// ##
+	for(unsigned long i = 0; i < lot.nb_entrees; i++)													// #
+	{																									// #
+		entree_manifeste* entree = &lot.entrees[i];														// #
+		if(entree->resultat == 1)																		// #
+		{																								// #
+			fprintf(resultats, "VALIDE %s %s\n", entree->fichier, entree->signature);					// #
+			nb_valides++;																				// #
+		}																								// #
+		else if(entree->resultat == 0)																	// #  Ecriture d'une ligne de résultat par entrée
+		{																								// #
+			fprintf(resultats, "INVALIDE %s %s\n", entree->fichier, entree->signature);					// #
+			nb_invalides++;																				// #
+		}																								// #
+		else if(entree->resultat == -2)																	// #
+		{																								// #
+			fprintf(resultats, "ERREUR ligne %lu du manifeste mal formée\n", entree->ligne);			// #
+			nb_erreurs++;																				// #
+		}																								// #
+		else																							// #
+		{																								// #
+			fprintf(resultats, "ERREUR %s %s\n", entree->fichier, entree->signature);					// #
+			nb_erreurs++;																				// #
+		}																								// #
+	}																									// #
+	fclose(resultats);																					// #
+	free(lot.entrees);																					// ##
+
+	printf("\n%lu signatures valides, %lu invalides, %lu erreurs.\n\n", nb_valides, nb_invalides, nb_erreurs);
+
+	STATS_FIN(STAT_TOTAL);																				// ##
+	STATS_EXPORTER("verification_lot");																	// ##  Export des statistiques de la vérification par lot
+};
+
+
+#define TAILLE_FILE_CONNEXIONS 64			// Le nombre de connexions acceptées en attente d'un worker
+#define MAX_CLES_DEMON 16					// Le nombre maximal de fichiers de clef que le démon peut utiliser
+#define TAILLE_MAX_REQUETE 8388608			// La taille maximale des données d'une requête (8 Mo) : la mémoire d'un worker reste bornée face à un client quelconque
+#define MODE_FORMAT 0x10					// Pour chiffrer, le mode MODE_FORMAT + format choisit le format du chiffré, les modes inférieurs gardent le format préfixé des anciens clients
+
+// Protocole du démon, tous les entiers sont en big-endian :
+// 	- requête : opération (1 octet), mode de déchiffrement 1 à 6 comme dans le menu, ou pour chiffrer MODE_FORMAT + format du chiffré 0 à 2 (préfixé, compact, compressé) (1 octet), longueur (2 octets) et chemin de la clef publique, longueur (2 octets) et chemin de la clef privée, longueur (4 octets) et données
+// 	- réponse : statut (1 octet), longueur (4 octets) et données
+// Seuls les fichiers de clef donnés au lancement du démon peuvent être utilisés, et seul un client du même utilisateur que le démon peut l'arrêter
+// Pour une vérification les données sont la longueur de la signature (4 octets), la signature puis le message. Un client peut envoyer plusieurs requêtes à la suite, les réponses arrivent dans le même ordre
+enum { OPERATION_ARRET, OPERATION_CHIFFRER, OPERATION_DECHIFFRER, OPERATION_SIGNER, OPERATION_VERIFIER };
+enum { STATUT_SUCCES, STATUT_SIGNATURE_INVALIDE, STATUT_ERREUR };
+
+
+// Connexions acceptées par le démon, en attente d'un worker, et fichiers de clef autorisés
+// en_cours donne pour chaque worker la connexion qu'il sert (-1 s'il attend), pour la couper à l'arrêt du démon
+typedef struct
+{
+	int connexions[TAILLE_FILE_CONNEXIONS];
+	unsigned int debut;
+	unsigned int nb;
+	int arret;
+	int ecoute;
+	char cles[MAX_CLES_DEMON][100];
+	unsigned int nb_cles;
+	int* en_cours;
+	pthread_mutex_t verrou;
+	pthread_cond_t non_vide;
+	pthread_cond_t non_pleine;
+} file_connexions;
+
+
+// Paramètres d'un worker du démon
+typedef struct
+{
+	file_connexions* file;
+	unsigned int numero;
+	pthread_t thread;
+} worker_demon;
+
+
+// Cette fonction lit exactement taille octets sur un descripteur
+// Entrée : un descripteur fd, un tableau tampon et une taille
+// Sortie : 0 si tout a été lu, -1 si la connexion a été fermée ou en cas d'erreur
+int lire_tout(int fd, void* tampon, size_t taille)
+{
+	unsigned char* position = tampon;
+	while(taille > 0)
+	{
+		ssize_t lu = read(fd, position, taille);
+		if(lu <= 0)
+		{
+			if((lu < 0) && (errno == EINTR))
+			{
+				continue;
+			}
+			return -1;
+		}
+		position += lu;
+		taille -= lu;
+	}
+	return 0;
+};
+
+
+// Cette fonction écrit exactement taille octets sur une socket, sans SIGPIPE si le client est parti
+// Entrée : un descripteur fd, un tableau tampon et une taille
+// Sortie : 0 si tout a été écrit, -1 sinon
+int ecrire_tout(int fd, const void* tampon, size_t taille)
+{
+	const unsigned char* position = tampon;
+	while(taille > 0)
+	{
+		ssize_t ecrit = send(fd, position, taille, MSG_NOSIGNAL);
+		if(ecrit <= 0)
+		{
+			if((ecrit < 0) && (errno == EINTR))
+			{
+				continue;
+			}
+			return -1;
+		}
+		position += ecrit;
+		taille -= ecrit;
+	}
+	return 0;
+};
+
+
+// Cette fonction lit un chemin de clef (longueur sur 2 octets puis caractères) sur une connexion
+// Entrée : un descripteur connexion et une chaîne chemin de 100 caractères
+// Sortie : 0 si le chemin a été lu, -1 sinon
+int lire_chemin(int connexion, char* chemin)
+{
+	unsigned char longueur[2];
+	if(lire_tout(connexion, longueur, 2) != 0)										// ##
+	{																				// #
+		return -1;																	// #
+	}																				// #
+	unsigned long taille = lire_entier(longueur, 2);								// #  Chemins limités à 99 caractères comme dans le menu
+	if((taille > 99) || (lire_tout(connexion, chemin, taille) != 0))				// #
+	{																				// #
+		return -1;																	// #
+	}																				// ##
+	chemin[taille] = '\0';
+	return 0;
+};
+
+
+// Cette fonction vérifie qu'un chemin de clef demandé par un client désigne un des fichiers de clef donnés au lancement du démon
+// Les chemins sont comparés une fois résolus, un client ne peut donc pas faire lire un autre fichier au démon
+// Entrée : la file de connexions du démon et une chaîne chemin, remplacée par le chemin donné au lancement s'il est autorisé
+// Sortie : 1 si la clef est autorisée, 0 sinon
+int cle_autorisee(file_connexions* file, char* chemin)
+{
+	char reel[PATH_MAX];
+	char reel_autorise[PATH_MAX];
+	if((chemin[0] == '\0') || (realpath(chemin, reel) == NULL))
+	{
+		return 0;
+	}
+	for(unsigned int i = 0; i < file->nb_cles; i++)
+	{
+		if((realpath(file->cles[i], reel_autorise) != NULL) && (strcmp(reel, reel_autorise) == 0))
+		{
+			strcpy(chemin, file->cles[i]);
+			return 1;
+		}
+	}
+	return 0;
+};
+
+
+// Cette fonction vérifie avec SO_PEERCRED que le client d'une connexion est le même utilisateur que le démon
+// Entrée : un descripteur connexion
+// Sortie : 1 si le client est le propriétaire du démon, 0 sinon
+int client_proprietaire(int connexion)
+{
+	struct ucred identite;
+	socklen_t taille = sizeof(identite);
+	if(getsockopt(connexion, SOL_SOCKET, SO_PEERCRED, &identite, &taille) != 0)
+	{
+		return 0;
+	}
+	return identite.uid == geteuid();
+};
+
+
+// Cette fonction ouvre les flux en mémoire d'une opération du démon : les données de la requête en lecture et un tampon extensible pour le résultat
+// Entrée : un tableau donnees et sa taille, deux pointeurs de flux entree et sortie, un pointeur resultat et un pointeur taille_resultat
+// Sortie : 0 si les deux flux sont ouverts, -1 sinon (aucun flux n'est alors ouvert)
+int ouvrir_flux_memoire(unsigned char* donnees, size_t taille, FILE** entree, FILE** sortie, char** resultat, size_t* taille_resultat)
+{
+	*entree = fmemopen(donnees, taille, "rb");
+	*sortie = open_memstream(resultat, taille_resultat);
+	if((*entree == NULL) || (*sortie == NULL))
+	{
+		if(*entree != NULL)
+		{
+			fclose(*entree);
+		}
+		if(*sortie != NULL)
+		{
+			fclose(*sortie);
+			free(*resultat);
+			*resultat = NULL;
+			*taille_resultat = 0;
+		}
+		return -1;
+	}
+	return 0;
+};
+
+
+// Cette fonction calcule l'empreinte SHA-256 d'un tableau d'octets
+// Entrée : un tableau donnees, sa taille et un tableau empreinte de 32 octets
+// Sortie : vide mais l'empreinte est écrite dans empreinte
+void sha256_memoire(const unsigned char* donnees, size_t taille, unsigned char* empreinte)
+{
+	contexte_sha256 contexte;
+	STATS_DEBUT(STAT_HACHAGE);
+	sha256_init(&contexte);
+	sha256_maj(&contexte, donnees, taille);
+	sha256_final(&contexte, empreinte);
+	STATS_FIN(STAT_HACHAGE);
+	STATS_AJOUTER(STAT_HACHAGES,1);
+};
+
+
+// Cette fonction traite une requête du protocole du démon et envoie la réponse
+// Les clefs sont servies par le magasin du worker, les données ne quittent pas la mémoire
+// Entrée : un descripteur connexion et la file de connexions du démon
+// Sortie : 0 pour continuer à lire des requêtes sur la connexion, -1 pour la fermer
+int traiter_requete(int connexion, file_connexions* file)
+{
+	unsigned char entete[2];																	// ##
+	unsigned char longueur[4];																	// #
+	char chemin_publique[100];																	// #
+	char chemin_privee[100];																	// #  Lecture de la requête
+	if((lire_tout(connexion, entete, 2) != 0) || (lire_chemin(connexion, chemin_publique) != 0) || (lire_chemin(connexion, chemin_privee) != 0) || (lire_tout(connexion, longueur, 4) != 0))	// #
+	{																							// #
+		return -1;																				// #
+	}																							// #
+	unsigned long taille = lire_entier(longueur, 4);											// #
+	if(taille > TAILLE_MAX_REQUETE)																// #
+	{																							// #
+		return -1;																				// #
+	}																							// #
+	unsigned char* donnees = malloc(taille + 1);												// #
+	if((donnees == NULL) || (lire_tout(connexion, donnees, taille) != 0))						// #
+	{																							// #
+		free(donnees);																			// #
+		return -1;																				// #
+	}																							// ##
+
+	int operation = entete[0];																	// ##
+	int mode = entete[1];																		// #
+	int statut = STATUT_SUCCES;																	// #
+	char* resultat = NULL;																		// #  Vérification des paramètres, les clefs privées sont
+	size_t taille_resultat = 0;																	// #  réservées au propriétaire du démon
+	int publique_valide = cle_autorisee(file, chemin_publique);								// #
+	int privee_valide = cle_autorisee(file, chemin_privee) && client_proprietaire(connexion);	// ##
+	FILE* entree;
+	FILE* sortie;
+
+	if(operation == OPERATION_CHIFFRER)
+	{
+		cle_en_magasin* publique = (publique_valide == 1) ? charger_cle(chemin_publique,0) : NULL;	// ##
+		if((publique == NULL) || (taille == 0) || (mode > MODE_FORMAT + FORMAT_COMPRESSE) || (ouvrir_flux_memoire(donnees, taille, &entree, &sortie, &resultat, &taille_resultat) != 0))	// #
+		{																						// #
+			statut = STATUT_ERREUR;																// #
+		}																						// #
+		else																					// #  Chiffrement des données avec la clef publique, en mémoire
+		{																						// #
+			chiffrer_fichier(entree,sortie,publique->cle.n,NULL,(mode >= MODE_FORMAT) ? mode - MODE_FORMAT : FORMAT_PREFIXE);	// #
+			fclose(entree);																		// #
+			fclose(sortie);																		// #
+		}																						// ##
+	}
+	else if(operation == OPERATION_DECHIFFRER)
+	{
+		cle_en_magasin* privee = (privee_valide == 1) ? charger_cle(chemin_privee,1) : NULL;	// ##
+		if((privee == NULL) || (taille == 0) || (mode < 1) || (mode > 6) || (ouvrir_flux_memoire(donnees, taille, &entree, &sortie, &resultat, &taille_resultat) != 0))	// #
+		{																						// #
+			statut = STATUT_ERREUR;																// #
+		}																						// #
+		else																					// #
+		{																						// #  Déchiffrement des données dans le mode demandé, aveuglé, en mémoire
+			unsigned int crt, temps_constant;													// #
+			mode_dechiffrement(mode,&crt,&temps_constant);										// #
+			dechiffrer_fichier(entree,sortie,&privee->cle,crt,temps_constant,&privee->aveuglement);	// #
+			fclose(entree);																		// #
+			fclose(sortie);																		// #
+		}																						// ##
+	}
+	else if(operation == OPERATION_SIGNER)
+	{
+		unsigned char empreinte[32];															// ##
+		char* hash = NULL;																		// #
+		size_t taille_hash = 0;																	// #
+		FILE* flux_hash = open_memstream(&hash, &taille_hash);									// #
+		if(flux_hash != NULL)																	// #
+		{																						// #
+			mpz_t h;																			// #  Hash des données écrit comme le fichier HASHER
+			mpz_init(h);																		// #
+			sha256_memoire(donnees, taille, empreinte);											// #
+			mpz_import(h,32,1,1,1,0,empreinte);													// #
+			mpz_out_raw(flux_hash,h);															// #
+			fclose(flux_hash);																	// #
+			mpz_clear(h);																		// #
+		}																						// ##
+
+		cle_en_magasin* privee = (privee_valide == 1) ? charger_cle(chemin_privee,1) : NULL;	// ##
+		if((privee == NULL) || (flux_hash == NULL) || (ouvrir_flux_memoire((unsigned char*) hash, taille_hash, &entree, &sortie, &resultat, &taille_resultat) != 0))	// #
+		{																						// #
+			statut = STATUT_ERREUR;																// #
+		}																						// #
+		else																					// #
+		{																						// #  Signature du hash avec le module de la clef privée
+			chiffrer_fichier(entree,sortie,privee->cle.n,privee,FORMAT_PREFIXE);				// #
+			fclose(entree);																		// #
+			fclose(sortie);																		// #
+		}																						// #
+		free(hash);																				// ##
+	}
+	else if(operation == OPERATION_VERIFIER)
+	{
+		unsigned long taille_signature = (taille >= 4) ? lire_entier(donnees, 4) : 0;			// ##
+		FILE* signature = NULL;																	// #
+		cle_en_magasin* publique = (publique_valide == 1) ? charger_cle(chemin_publique,0) : NULL;	// #
+		if((publique != NULL) && (taille_signature != 0) && (taille_signature <= taille - 4))	// #
+		{																						// #
+			signature = fmemopen(donnees+4, taille_signature, "rb");							// #
+		}																						// #
+		if(signature == NULL)																	// #
+		{																						// #
+			statut = STATUT_ERREUR;																// #
+		}																						// #
+		else																					// #  Vérification en mémoire de la signature avec la clef publique
+		{																						// #
+			unsigned char empreinte[32];														// #
+			sha256_memoire(donnees+4+taille_signature, taille-4-taille_signature, empreinte);	// #
+			if(verifier_signature_memoire(signature, empreinte, &publique->cle) == 0)			// #
+			{																					// #
+				statut = STATUT_SIGNATURE_INVALIDE;												// #
+			}																					// #
+			fclose(signature);																	// #
+		}																						// ##
+	}
+	else if((operation == OPERATION_ARRET) && (client_proprietaire(connexion) == 0))
+	{
+		statut = STATUT_ERREUR;																	// #  Arrêt refusé à un autre utilisateur
+	}
+	else if(operation != OPERATION_ARRET)														// #  L'arrêt a lieu une fois la réponse envoyée
+	{
+		statut = STATUT_ERREUR;
+	}
+
+	if(statut == STATUT_ERREUR)																	// ##
+	{																							// #
+		free(resultat);																			// #  Pas de résultat partiel en cas d'erreur
+		resultat = NULL;																		// #
+		taille_resultat = 0;																	// #
+	}																							// ##
+
+	unsigned char reponse[5];																	// ##
+	reponse[0] = statut;																		// #
+	ecrire_entier(reponse+1, 4, taille_resultat);												// #  Envoi de la réponse
+	int erreur = (ecrire_tout(connexion, reponse, 5) != 0) || (ecrire_tout(connexion, resultat, taille_resultat) != 0);	// #
+	free(donnees);																				// #
+	free(resultat);																				// ##
+
+	if((operation == OPERATION_ARRET) && (statut == STATUT_SUCCES))								// ##
+	{																							// #
+		pthread_mutex_lock(&file->verrou);														// #
+		file->arret = 1;																		// #  Arrêt du démon : accept() est débloqué en fermant la socket d'écoute
+		shutdown(file->ecoute, SHUT_RDWR);														// #  et l'attente d'une place dans la file est réveillée
+		pthread_cond_broadcast(&file->non_pleine);												// #
+		pthread_mutex_unlock(&file->verrou);													// #
+		return -1;																				// #
+	}																							// ##
+
+	return (erreur == 1) ? -1 : 0;
+};
+
+
+// Cette fonction est exécutée par chaque worker : elle prend les connexions dans la file et traite toutes leurs requêtes
+// Entrée : un pointeur vers les paramètres du worker
+// Sortie : NULL
+void* travailler_demon(void* argument)
+{
+	worker_demon* worker = argument;
+	file_connexions* file = worker->file;
+
+	while(1)
+	{
+		pthread_mutex_lock(&file->verrou);														// ##
+		while((file->nb == 0) && (file->arret == 0))											// #
+		{																						// #
+			pthread_cond_wait(&file->non_vide, &file->verrou);									// #
+		}																						// #
+		if(file->nb == 0)																		// #
+		{																						// #  Attente d'une connexion, fin du worker à l'arrêt du démon
+			pthread_mutex_unlock(&file->verrou);												// #
+			break;																				// #
+		}																						// #
+		int connexion = file->connexions[file->debut];											// #
+		file->debut = (file->debut + 1) % TAILLE_FILE_CONNEXIONS;								// #
+		file->nb--;																				// #
+		file->en_cours[worker->numero] = connexion;												// #
+		pthread_cond_signal(&file->non_pleine);													// #
+		pthread_mutex_unlock(&file->verrou);													// ##
+
+		while(traiter_requete(connexion, file) == 0);								// #  Requêtes de la connexion traitées dans l'ordre
+
+		pthread_mutex_lock(&file->verrou);														// ##
+		file->en_cours[worker->numero] = -1;													// #  La connexion n'est fermée qu'une fois retirée de en_cours,
+		pthread_mutex_unlock(&file->verrou);													// #  l'arrêt ne peut donc pas couper un descripteur réutilisé
+		close(connexion);																		// ##
+	}
+
+	vider_magasin_cles();																		// #  Effacement des clefs du worker
+	return NULL;
+};
+
+
+// Cette fonction lance le démon : elle écoute sur une socket Unix et confie les connexions à un groupe de workers jusqu'à une requête d'arrêt
+// Entrée : vide
+// Sortie : vide
+void demon()
+{
+	char nom_socket[100];
+	unsigned int nb_workers;
+
+	printf("\nQuel est le chemin de la socket sur laquelle le démon doit écouter?\n\n");
+	scanf(" %99s", nom_socket);
+	printf("\nCombien de workers souhaitez-vous (0 pour un par coeur)?\n\n");
+	scanf(" %u", &nb_workers);
+	if(nb_workers == 0)
+	{
+		nb_workers = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	file_connexions file;																		// ##
+	memset(&file, 0, sizeof(file));																// #
+	pthread_mutex_init(&file.verrou, NULL);														// #  Initialisation de la file de connexions
+	pthread_cond_init(&file.non_vide, NULL);													// #
+	pthread_cond_init(&file.non_pleine, NULL);													// ##
+
+	printf("\nCombien de fichiers de clef le démon peut-il utiliser (entre 1 et %d)?\n\n", MAX_CLES_DEMON);	// ##
+	scanf(" %u", &file.nb_cles);																// #
+	while((file.nb_cles < 1) || (file.nb_cles > MAX_CLES_DEMON))								// #
+	{																							// #
+		printf("\nLe nombre que vous avez indiqué n'est pas valable, combien de fichiers de clef (entre 1 et %d)?\n\n", MAX_CLES_DEMON);	// #
+		scanf(" %u", &file.nb_cles);															// #
+	}																							// #
+	for(unsigned int i = 0; i < file.nb_cles; i++)												// #  Fichiers de clef autorisés : les clients ne peuvent
+	{																							// #  pas en désigner d'autres
+		etiquette:																				// #
+			printf("\nQuel est le nom du fichier de clef n°%u?\n\n", i+1);						// #
+			scanf(" %99s", file.cles[i]);														// #
+			if(access(file.cles[i], R_OK) != 0)													// #
+			{																					// #
+				printf("\nAttention, le nom de fichier saisi n'existe pas!");					// #
+				goto etiquette;																	// #
+			}																					// #
+	}																							// ##
+
+	struct sockaddr_un adresse;																	// ##
+	memset(&adresse, 0, sizeof(adresse));														// #
+	adresse.sun_family = AF_UNIX;																// #
+	strncpy(adresse.sun_path, nom_socket, sizeof(adresse.sun_path)-1);							// #
+	unlink(nom_socket);																			// #
+	file.ecoute = socket(AF_UNIX, SOCK_STREAM, 0);												// #  Création de la socket d'écoute, accessible au seul propriétaire
+	if((file.ecoute < 0) || (bind(file.ecoute, (struct sockaddr*) &adresse, sizeof(adresse)) != 0) || (chmod(nom_socket, 0600) != 0) || (listen(file.ecoute, TAILLE_FILE_CONNEXIONS) != 0))	// #
+	{																							// #
+		printf("\nImpossible d'écouter sur %s.\n", nom_socket);									// #
+		close(file.ecoute);																		// #
+		return;																					// #
+	}																							// ##
+
+	worker_demon* workers = malloc(nb_workers * sizeof(worker_demon));							// ##
+	file.en_cours = malloc(nb_workers * sizeof(int));											// #
+	for(unsigned int i = 0; i < nb_workers; i++)												// #
+	{																							// #
+		file.en_cours[i] = -1;																	// #  Lancement des workers
+		workers[i].file = &file;																// #
+		workers[i].numero = i;																	// #
+		pthread_create(&workers[i].thread, NULL, travailler_demon, &workers[i]);				// #
+	}																							// ##
+	printf("\nLe démon écoute sur %s avec %u workers.\n", nom_socket, nb_workers);
+	fflush(stdout);
+
+	while(1)
+	{
+		int connexion = accept(file.ecoute, NULL, NULL);										// ##
+		pthread_mutex_lock(&file.verrou);														// #
+		int arret = file.arret;																	// #
+		pthread_mutex_unlock(&file.verrou);														// #
+		if(connexion < 0)																		// #
+		{																						// #
+			if((errno == EINTR) && (arret == 0))												// #
+			{																					// #
+				continue;																		// #
+			}																					// #
+			break;																				// #
+		}																						// #
+		pthread_mutex_lock(&file.verrou);														// #  Acceptation des connexions et ajout dans la file,
+		while((file.nb == TAILLE_FILE_CONNEXIONS) && (file.arret == 0))							// #  sauf si l'arrêt arrive pendant l'attente d'une place
+		{																						// #
+			pthread_cond_wait(&file.non_pleine, &file.verrou);									// #
+		}																						// #
+		if(file.arret == 1)																		// #
+		{																						// #
+			pthread_mutex_unlock(&file.verrou);													// #
+			close(connexion);																	// #
+			break;																				// #
+		}																						// #
+		file.connexions[(file.debut + file.nb) % TAILLE_FILE_CONNEXIONS] = connexion;			// #
+		file.nb++;																				// #
+		pthread_cond_signal(&file.non_vide);													// #
+		pthread_mutex_unlock(&file.verrou);														// ##
+	}
+
+	pthread_mutex_lock(&file.verrou);															// ##
+	file.arret = 1;																				// #
+	for(; file.nb > 0; file.nb--)																// #
+	{																							// #
+		close(file.connexions[file.debut]);														// #
+		file.debut = (file.debut + 1) % TAILLE_FILE_CONNEXIONS;									// #
+	}																							// #
+	for(unsigned int i = 0; i < nb_workers; i++)												// #  Arrêt : les connexions en attente sont fermées, celles en cours
+	{																							// #  coupées, les workers finissent leur requête puis s'arrêtent
+		if(file.en_cours[i] >= 0)																// #
+		{																						// #
+			shutdown(file.en_cours[i], SHUT_RDWR);												// #
+		}																						// #
+	}																							// #
+	pthread_cond_broadcast(&file.non_vide);														// #
+	pthread_mutex_unlock(&file.verrou);															// #
+	for(unsigned int i = 0; i < nb_workers; i++)												// #
+	{																							// #
+		pthread_join(workers[i].thread, NULL);													// #
+	}																							// #
+	free(workers);																				// #
+	free(file.en_cours);																		// #
+	close(file.ecoute);																			// #
+	unlink(nom_socket);																			// #
+	pthread_mutex_destroy(&file.verrou);														// #
+	pthread_cond_destroy(&file.non_vide);														// #
+	pthread_cond_destroy(&file.non_pleine);														// ##
+
+	printf("\nArret du démon.\n");
+};
+
+
+#define NB_ETAPES 19				// Le nombre d'étapes mesurées par benchmark()
+#define MAX_ITERATIONS 100000		// Le nombre maximal de mesures conservées par étape
+#define BUDGET_BENCHMARK 1.0		// La durée de mesure visée par étape et par taille (en secondes)
+
+const char* noms_etapes[NB_ETAPES] = {"crible", "miller_rabin", "exp_mod", "exp_mod_sec", "mpz_powm", "mpz_powm_sec", "dechiffrement_standard", "dechiffrement_crt", "dechiffrement_standard_sec", "dechiffrement_crt_sec", "dechiffrement_crt_parallele", "dechiffrement_crt_parallele_sec", "oaep", "inv_oaep", "mgf1", "sha256", "ecriture", "lecture", "alea"};
+
+
+// Contexte partagé par les étapes mesurées par benchmark()
+typedef struct
+{
+	__gmp_randstate_struct* generateur;
+	unsigned int bits;
+	unsigned long taille;
+	cle_rsa cle;
+	contexte_aveuglement aveuglement;
+	mpz_t premier;
+	mpz_t chiffre;
+	mpz_t resultat;
+	mpz_t* blocs;
+	unsigned int nb_blocs;
+} contexte_benchmark;
+
+
+// Cette fonction génère rapidement une clef de test de la taille voulue, sans passer par le crible
+// Entrée : une clef initialisée, un entier nombre_bit et un générateur aléatoire generateur
+// Sortie : vide mais la clef contient n, d, p, q, Ip, dp et dq
+void cle_de_test(cle_rsa* cle, unsigned int nombre_bit, gmp_randstate_t generateur)
+{
+	mpz_t phi, e;
+	mpz_inits(phi, e, NULL);
+	mpz_set_ui(e,65537);
+
+	do 																					// ##
+	{																					// #
+		mpz_urandomb(cle->p, generateur, nombre_bit/2);									// #
+		mpz_setbit(cle->p, nombre_bit/2 - 1);											// #
+		mpz_nextprime(cle->p, cle->p);													// #
+		mpz_urandomb(cle->q, generateur, nombre_bit - nombre_bit/2);					// #
+		mpz_setbit(cle->q, nombre_bit - nombre_bit/2 - 1);								// #  Tirage de p et q jusqu'à ce que e soit inversible modulo phi
+		mpz_nextprime(cle->q, cle->q);													// #
+		mpz_mul(cle->n, cle->p, cle->q);												// #
+		mpz_sub_ui(cle->p,cle->p,1);													// #
+		mpz_sub_ui(cle->q,cle->q,1);													// #
+		mpz_mul(phi, cle->p, cle->q);													// #
+		mpz_add_ui(cle->p,cle->p,1);													// #
+		mpz_add_ui(cle->q,cle->q,1);													// #
+	}while((mpz_cmp(cle->p, cle->q) == 0) || (mpz_invert(cle->d, e, phi) == 0));		// ##
+
+	mpz_invert(cle->Ip, cle->p, cle->q);												// #  Valeurs utilisées en mode crt
+	calcul_crt(cle);																	// #
+
+	mpz_clears(phi, e, NULL);
+};
+
+
+// Cette fonction crée un fichier de test rempli d'octets aléatoires
+// Entrée : un nom de fichier, un entier taille en octets et un générateur aléatoire generateur
+// Sortie : vide mais le fichier contient taille octets aléatoires
+void creer_fichier_test(char* nom_fichier, unsigned long taille, gmp_randstate_t generateur)
+{
+	unsigned char tampon[65536];
+	size_t ecrits;
+	mpz_t alea;
+	mpz_init(alea);
+
+	mpz_urandomb(alea, generateur, 8*sizeof(tampon));									// ##
+	memset(tampon, 0, sizeof(tampon));													// #  Un tampon aléatoire est réutilisé pour tout le fichier
+	mpz_export(tampon, &ecrits, 1, 1, 1, 0, alea);										// ##
+
+	FILE* fichier = fopen(nom_fichier,"wb");
+	for(unsigned long i = 0; i < taille; i += sizeof(tampon))
+	{
+		fwrite(tampon, 1, (taille - i < sizeof(tampon)) ? taille - i : sizeof(tampon), fichier);
+	}
+	fclose(fichier);
+	mpz_clear(alea);
+};
 
 
+// Cette fonction compare deux fichiers octet par octet
+// Entrée : deux noms de fichiers
+// Sortie : 1 si les fichiers sont identiques, 0 sinon
+int fichiers_identiques(char* nom_fichier_1, char* nom_fichier_2)
+{
+	FILE* fichier_1 = fopen(nom_fichier_1,"rb");
+	FILE* fichier_2 = fopen(nom_fichier_2,"rb");
+	int caractere1, caractere2;
 
-	mpz_t n, m, e;																		// ##
-	mpz_inits(n, m, e, NULL);															// #  Déclaration des variables pour chiffrer ou signer
-	FILE* privee;																		// ##
-	
-	if(signature == 0)																	// ##
+	do 
+	{
+		caractere1 = fgetc(fichier_1);
+		caractere2 = fgetc(fichier_2);
+	}while((caractere1 != EOF) & (caractere1 == caractere2));
+
+	fclose(fichier_1);
+	fclose(fichier_2);
+	return(caractere1 == caractere2);
+};
+
+
+// Cette fonction prépare les blocs paddés utilisés pour mesurer inv_OAEP()
+// Entrée : un contexte de benchmark dont la clef et la taille sont renseignées
+// Sortie : vide mais le contexte contient les blocs OAEP du fichier benchmark_entree
+void preparer_blocs(contexte_benchmark* contexte)
+{
+	int taille_n = taille_256(contexte->cle.n)-1;
+
+	FILE* clair = fopen("benchmark_entree","rb");										// ##
+	padding_fichier(clair, taille_n, contexte->taille);									// #  Padding du fichier de test
+	fclose(clair);																		// ##
+
+	FILE* OAE = fopen(travail.oaep,"r");												// ##
+	fseek(OAE,0,SEEK_END);																// #
+	contexte->nb_blocs = ftell(OAE) / (2*taille_n);										// #
+	rewind(OAE);																		// #
+	contexte->blocs = malloc(contexte->nb_blocs * sizeof(mpz_t));						// #  Lecture des blocs paddés
+	for(unsigned int b = 0; b < contexte->nb_blocs; b++)								// #
 	{																					// #
-		mpz_set_ui(e,65537);															// #
+		mpz_init(contexte->blocs[b]);													// #
+		lire_bloc_oaep(OAE, contexte->blocs[b], taille_n);								// #
 	}																					// #
-	else																				// #
-	{																					// #
-		char nom_fichier_cle_privee[100];												// #  
-																						// #  Choix entre chiffrement et signature :
-		etiquette4:																		// #  
-			printf("\nQuel est le nom du fichier contenant la clé privée?\n\n");		// #  	- chiffrement : on initialise e à 65537
-			scanf(" %99s", nom_fichier_cle_privee);										// #  
-			if(access( nom_fichier_cle_privee, F_OK ) != 0)								// #  	- signature : on ouvre le fichier contenant la clef privée et on initialise e à la valeur de la clef privée
-			{																			// #
-				printf("\nAttention, le nom de fichier saisi n'existe pas!");			// #
-				goto etiquette4;														// #
-			}																			// #
-		privee = fopen(nom_fichier_cle_privee,"rb+");									// #
-		//gmp_fscanf(privee, " %Zd", e);												// #
-		mpz_inp_raw(e,privee);															// #
-	}																					// ##
+	fclose(OAE);																		// #
+	remove(travail.oaep);																// ##
+};
 
-	//gmp_fscanf(publique, " %Zd", n);													// ##
-	mpz_inp_raw(n,publique);															// #
-																						// #  On attribue à n la valeur de la clef publique et on calcule la taille de n en base 256
-	int taille_n = taille_256(n)-1;														// #
-	unsigned int taille_fichier = 0;													// ##
-	int length_n;
 
-	fseek(clair,0,SEEK_END);															// ##
-    taille_fichier = ftell(clair);														// #  On récupère la taille du fichier à chiffrer ou signer
-    rewind(clair);																		// ##
+// Cette fonction exécute une fois une étape mesurée
+// Entrée : un entier etape indice dans noms_etapes et un contexte de benchmark
+// Sortie : vide
+void executer_etape(int etape, contexte_benchmark* contexte)
+{
+	int taille_n;
+	unsigned int crt, temps_constant;
+	FILE* fichier;
+	unsigned char tampon[65536];
 
-    int dernier = 0;																	// ##
-    int taille_padding = 8;																// #
-    length_n = taille_n - taille_padding;												// #  On initialise les variables pour le padding
-    int i = 0;																			// #
-    unsigned int k = 0;																			// ##
-    
-    while(i < taille_fichier)															// #  Boucle pour lire tout le fichier
-    {
-    	if (taille_fichier-i<taille_n)													// ##
-   		{																				// #  Modification pour le dernier bloc
-    		dernier = taille_fichier - i;												// #
-    	}																				// ##
-    	
-    	OAEP(length_n,dernier,clair);													// #  Padding
-    	i = i + length_n;
-    }		
+	switch(etape)
+	{
+		case 0:		// #  Recherche d'un premier de la moitié de la taille de la clef
+			optimized_crible_generation(contexte->resultat, contexte->bits/2, 1);
+			break;
+
+		case 1:		// #  Test de Miller-Rabin complet sur un nombre premier
+			Miller_Rabin(contexte->premier);
+			break;
+
+		case 2:		// #  Exponentiation à temps variable
+			exp_mod(contexte->resultat, contexte->chiffre, contexte->cle.d, contexte->cle.n);
+			break;
+
+		case 3:		// #  Exponentiation à temps constant
+			exp_mod_sec(contexte->resultat, contexte->chiffre, contexte->cle.d, contexte->cle.n);
+			break;
+
+		case 4:		// #  Référence GMP de exp_mod()
+			mpz_powm(contexte->resultat, contexte->chiffre, contexte->cle.d, contexte->cle.n);
+			break;
+
+		case 5:		// #  Référence GMP de exp_mod_sec()
+			mpz_powm_sec(contexte->resultat, contexte->chiffre, contexte->cle.d, contexte->cle.n);
+			break;
+
+		case 6:		// #  Déchiffrement aveuglé d'un bloc dans les six modes de decrypt()
+		case 7:
+		case 8:
+		case 9:
+		case 10:
+		case 11:
+			mode_dechiffrement(etape-5, &crt, &temps_constant);
+			mpz_set(contexte->resultat, contexte->chiffre);
+			dechiffrer_bloc(contexte->resultat, &contexte->cle, crt, temps_constant, &contexte->aveuglement);
+			break;
+
+		case 12:	// #  Padding OAEP du fichier de test
+			taille_n = taille_256(contexte->cle.n)-1;
+			fichier = fopen("benchmark_entree","rb");
+			padding_fichier(fichier, taille_n, contexte->taille);
+			fclose(fichier);
+			remove(travail.oaep);
+			break;
+
+		case 13:	// #  Suppression du padding des blocs préparés
+			taille_n = taille_256(contexte->cle.n)-1;
+			fichier = fopen("benchmark_sortie","wb");
+			for(unsigned int b = 0; b < contexte->nb_blocs; b++)
+			{
+				inv_OAEP(taille_n, b == contexte->nb_blocs-1, contexte->blocs[b], fichier);
+			}
+			fclose(fichier);
+			break;
+
+		case 14:	// #  Masque MGF1 de la taille du fichier de test
+			mpz_set_ui(contexte->resultat, contexte->taille);
+			mpz_set_str(contexte->chiffre, "123456789abcdef0", 16);
+			MGF1(contexte->chiffre, contexte->resultat);
+			vider_masque();
+			break;
+
+		case 15:	// #  Hash du fichier de test
+			SHA256("benchmark_entree");
+			remove(travail.hasher);
+			break;
+
+		case 16:	// #  Ecriture d'un fichier
+			memset(tampon, 0xa5, sizeof(tampon));
+			fichier = fopen("benchmark_sortie","wb");
+			for(unsigned long i = 0; i < contexte->taille; i += sizeof(tampon))
+			{
+				fwrite(tampon, 1, (contexte->taille - i < sizeof(tampon)) ? contexte->taille - i : sizeof(tampon), fichier);
+			}
+			fclose(fichier);
+			break;
+
+		case 17:	// #  Lecture d'un fichier
+			fichier = fopen("benchmark_entree","rb");
+			while(fread(tampon, 1, sizeof(tampon), fichier) == sizeof(tampon));
+			fclose(fichier);
+			break;
+
+		case 18:	// #  Production d'octets aléatoires par le générateur ChaCha20
+			for(unsigned long i = 0; i < contexte->taille; i += sizeof(tampon))
+			{
+				alea_octets(tampon, (contexte->taille - i < sizeof(tampon)) ? contexte->taille - i : sizeof(tampon));
+			}
+			break;
+	}
+};
 
-    FILE* OAE = fopen("OAEP","r");														// #  Ouverture du fichier contenant les blocs à chiffrer
-    
-    taille_fichier = 0;																	// ##
-    i = 0;																				// #  Initialisation des variables pour chiffrer/signer
-    char c;																				// ##
 
-	fseek(OAE,0,SEEK_END);																// ##
-    taille_fichier = ftell(OAE);														// #  On récupère la taille du fichier à chiffrer ou signer
-    rewind(OAE);																		// ##
+// Cette fonction compare deux durées pour qsort()
+int comparer_durees(const void* a, const void* b)
+{
+	double x = *(const double*) a;
+	double y = *(const double*) b;
+	return (x > y) - (x < y);
+};
 
-    while(i < taille_fichier)															// #  Boucle pour lire tout le fichier
-    {	
-    	mpz_set_ui(m,0);																// ##
-    	for (int j = 0; j < 2*taille_n; j++)											// #
-    	{																				// #
-    		c = fgetc(OAE);																// #
-    		mpz_mul_ui(m,m,16);															// #
-			if(c >= '0' && c <= '9')													// #
-			{																			// #  Lecture d'un bloc à chiffrer
-				mpz_add_ui(m,m,c - '0');												// #
-			}																			// #
-			if(c >= 'a' && c <= 'f')													// #
-			{																			// #
-				mpz_add_ui(m,m, c - 'a' + 10);											// #
-			}																			// #
-    	}																				// ##
-    	
-	    exp_mod(m,m,e,n);																// #  Chiffrement d'un bloc
-	    mpz_out_raw(cypher,m);															// #
 
-	    i += 2*taille_n;																			
-	}
+// Cette fonction mesure une étape pendant BUDGET_BENCHMARK secondes et écrit le résultat sur une ligne JSON
+// Entrée : un flux sortie, un entier etape, un contexte de benchmark et un entier valide indiquant si le résultat de l'étape a été vérifié
+// Sortie : le nombre d'exécutions par seconde, une ligne contenant ops/s, Mo/s et les percentiles de latence est ajoutée à sortie
+double mesurer(FILE* sortie, int etape, contexte_benchmark* contexte, int valide)
+{
+	double* durees = malloc(MAX_ITERATIONS * sizeof(double));							// ##
+	unsigned int iterations = 0;														// #  Initialisation des variables
+	double debut = chrono();															// #
+	double t;																			// ##
 
-    if(signature == 1)																	// ##
-    {																					// #
-    	fclose(privee);																	// #
-    }																					// #
-    mpz_clears(n, m, e, NULL);															// #
-    fclose(OAE);																		// #
-    fclose(clair);																		// #  Fermeture et suppression des fichiers
-	fclose(cypher);																		// #
-	fclose(publique);																	// #
-	remove("OAEP");																		// #
-	if(signature == 1)																	// #
+	do 																					// ##
 	{																					// #
-		remove("HASHER");																// #
-	}																					// ##
+		t = chrono();																	// #  Répétition de l'étape jusqu'à épuisement du budget
+		executer_etape(etape, contexte);												// #
+		durees[iterations] = chrono() - t;												// #
+		iterations++;																	// #
+	}while((iterations < MAX_ITERATIONS) && (chrono() - debut < BUDGET_BENCHMARK));		// ##
+
+	double total = chrono() - debut;													// ##
+	qsort(durees, iterations, sizeof(double), comparer_durees);							// #  Calcul des débits et des percentiles
+	double p50 = durees[(iterations-1)*50/100] * 1e6;									// #
+	double p90 = durees[(iterations-1)*90/100] * 1e6;									// #
+	double p99 = durees[(iterations-1)*99/100] * 1e6;									// ##
+
+	fprintf(sortie, "{\"etape\":\"%s\",\"bits\":%u,\"taille\":%lu,\"iterations\":%u,\"ops_s\":%.3f,\"mo_s\":%.3f,\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"valide\":%s,\"noyau\":\"%s\"}\n",
+		noms_etapes[etape], contexte->bits, contexte->taille, iterations, iterations / total, contexte->taille * (iterations / total) / 1e6, p50, p90, p99, valide ? "true" : "false", NOM_BACKEND_MONTGOMERY);
+	fflush(sortie);
+	printf("%-28s %6u bits %12lu octets %12.3f ops/s %10.3f Mo/s  p50 %.1f us\n", noms_etapes[etape], contexte->bits, contexte->taille, iterations / total, contexte->taille * (iterations / total) / 1e6, p50);
+
+	free(durees);
+	return iterations / total;
 };
 
 
-// Cette fonction sert à déchiffrer un fichier en mode standard ou en mode crt ou à déchiffrer une signature
-// Entrée : deux entiers crt et signature, si signature vaut 0 on déchiffre, si signature vaut 1 on déchiffre une signature. Si crt vaut 0 on dechiffre en mode standard si crt vaut 1 on déchiffre en mode crt.
-// Sortie : vide mais on crée un fichier contenant le clair ou la signature déchiffrée
-void decrypt(unsigned int crt, unsigned int signature)
-{														
-	char choix;																				// ##
-	mpz_t n, d, p, q, Ip, chiffre, puissance, div, dp, dq, mp, mq ;							// #
-    mpz_inits(n, d, p, q, Ip, chiffre, puissance, div,dp, dq, mp, mq,NULL);					// #
-    unsigned int lettre;																	// #  Initialisation des variables
-	unsigned int taille_n;																	// #
-	unsigned int compteur = 0;																// #
-	unsigned int taille_fichier = 0;														// #
-	FILE* privee;																			// ##
+// Cette fonction mesure séparément chaque étape du programme pour des clefs de 1024 à 4096 bits et des fichiers de 1 Ko à taille_max Ko
+// Les exponentiations sont comparées à la référence GMP : mpz_powm() pour exp_mod() et mpz_powm_sec() pour exp_mod_sec()
+// Entrée : un générateur aléatoire generateur, un flux sortie ouvert en écriture et un entier taille_max, la taille maximale des fichiers de test en Ko
+// Sortie : vide mais les mesures sont écrites au format JSON, une ligne par étape, dans sortie qui est fermé
+void benchmark(gmp_randstate_t generateur, FILE* sortie, unsigned long taille_max)
+{
+	unsigned int tailles_bits[4] = {1024, 2048, 3072, 4096};
+	unsigned long tailles_fichiers[5] = {1024, 32768, 1048576, 33554432, 1073741824};
 
-	char nom_fichier_a_dechiffrer[100];														// ##
-	etiquette:																				// #
-		if(signature == 0)																	// #
-		{																					// #
-			printf("\nQuel est le nom du fichier que vous souhaitez déchiffrer? \n\n");		// #
-		}																					// #
-		else																				// #
-		{																					// #
-			printf("\nQuel est le nom du fichier contenant la signature? \n\n");			// #  Ouverture du fichier à déchiffrer ou de la signature à déchiffrer
-		}																					// #
-		scanf(" %99s", nom_fichier_a_dechiffrer);											// #
-		if(access( nom_fichier_a_dechiffrer, F_OK ) != 0)									// #
-		{																					// #
-			printf("\nAttention, le nom de fichier saisi n'existe pas!");					// #
-			goto etiquette;																	// #
-		}																					// #
-	FILE* cypher = fopen(nom_fichier_a_dechiffrer,"rb+");									// ##
+	contexte_benchmark contexte;														// ##
+	contexte.generateur = generateur;													// #
+	init_cle_rsa(&contexte.cle);														// #  Initialisation du contexte
+	mpz_inits(contexte.premier, contexte.chiffre, contexte.resultat, NULL);				// ##
 
+	contexte.bits = 0;
+	for(int f = 0; f < 5; f++)															// ##
+	{																					// #
+		if(tailles_fichiers[f] > taille_max*1024)										// #
+		{																				// #
+			continue;																	// #
+		}																				// #  Etapes qui ne dépendent que de la taille du fichier
+		contexte.taille = tailles_fichiers[f];											// #
+		creer_fichier_test("benchmark_entree", contexte.taille, generateur);			// #
+		for(int etape = 14; etape < NB_ETAPES; etape++)									// #
+		{																				// #
+			mesurer(sortie, etape, &contexte, 1);										// #
+		}																				// #
+	}																					// ##
 
+	for(int t = 0; t < 4; t++)
+	{
+		contexte.bits = tailles_bits[t];												// ##
+		contexte.taille = 0;															// #
+		cle_de_test(&contexte.cle, contexte.bits, generateur);							// #  Clef de test, premier de test et chiffré aléatoire
+		mpz_set(contexte.premier, contexte.cle.p);										// #
+		mpz_urandomm(contexte.chiffre, generateur, contexte.cle.n);						// #
+		mpz_set_ui(contexte.resultat, 65537);											// #
+		init_aveuglement(&contexte.aveuglement, contexte.resultat, contexte.cle.n);	// ##
+
+		mpz_powm(contexte.premier, contexte.chiffre, contexte.cle.d, contexte.cle.n);	// ##
+		executer_etape(2, &contexte);													// #
+		int exp_mod_valide = (mpz_cmp(contexte.resultat, contexte.premier) == 0);		// #
+		mpz_powm_sec(contexte.premier, contexte.chiffre, contexte.cle.d, contexte.cle.n);	// #
+		executer_etape(3, &contexte);													// #  Les exponentiations du programme sont vérifiées contre celles de GMP
+		int exp_mod_sec_valide = (mpz_cmp(contexte.resultat, contexte.premier) == 0);	// #
+		mpz_set(contexte.premier, contexte.cle.p);										// ##
+
+		double debits[NB_ETAPES];														// ##
+		for(int etape = 0; etape < 12; etape++)											// #
+		{																				// #  Etapes qui ne dépendent que de la taille de la clef
+			debits[etape] = mesurer(sortie, etape, &contexte, (etape == 2) ? exp_mod_valide : ((etape == 3) ? exp_mod_sec_valide : 1));	// #
+		}																				// ##
+		printf("Référence GMP %u bits : exp_mod à %.2f fois le débit de mpz_powm, exp_mod_sec à %.2f fois le débit de mpz_powm_sec\n", contexte.bits, debits[2] / debits[4], debits[3] / debits[5]);	// Comparaison avec la référence
+
+		for(int f = 0; f < 5; f++)
+		{
+			if(tailles_fichiers[f] > taille_max*1024)
+			{
+				continue;
+			}
+			contexte.taille = tailles_fichiers[f];										// ##
+			creer_fichier_test("benchmark_entree", contexte.taille, generateur);		// #  Etapes OAEP, le déchiffrement des blocs préparés est vérifié
+			preparer_blocs(&contexte);													// #
+			mesurer(sortie, 12, &contexte, 1);											// #
+			executer_etape(13, &contexte);												// #
+			mesurer(sortie, 13, &contexte, fichiers_identiques("benchmark_entree","benchmark_sortie"));	// ##
+
+			for(unsigned int b = 0; b < contexte.nb_blocs; b++)
+			{
+				mpz_clear(contexte.blocs[b]);
+			}
+			free(contexte.blocs);
+		}
+		clear_aveuglement(&contexte.aveuglement);
+	}
 
-    char nom_fichier_cle_publique[100];														// ##
-    etiquette2:																				// #
-		printf("\nQuel est le nom du fichier contenant la clé publique?\n\n");				// #
-		scanf(" %99s", nom_fichier_cle_publique);											// #
-		if(access( nom_fichier_cle_publique, F_OK ) != 0)									// #  Ouverture du fichier contenant la clef publique
-		{																					// #
-			printf("\nAttention, le nom de fichier saisi n'existe pas!");					// #
-			goto etiquette2;																// #
-		}																					// #
-	FILE* publique = fopen(nom_fichier_cle_publique,"rb+");									// ##
-	
+	fclose(sortie);																		// ##
+	remove("benchmark_entree");															// #
+	remove("benchmark_sortie");															// #  Fermeture et suppression des fichiers de test
+	clear_cle_rsa(&contexte.cle);														// #
+	mpz_clears(contexte.premier, contexte.chiffre, contexte.resultat, NULL);			// ##
+};
 
-    mpz_inp_raw(n,publique);																// #  On initialise n à la valeur de la clef publique
 
+// Cette fonction demande le fichier des mesures et la taille maximale des fichiers de test puis lance benchmark()
+// Entrée : un générateur aléatoire generateur
+// Sortie : vide mais les mesures sont écrites au format JSON dans le fichier choisi
+void benchmark_interactif(gmp_randstate_t generateur)
+{
+	char choix;
+	unsigned long taille_max;
 
-	if(signature == 0)																		// ##
-	{																						// #
-		char nom_fichier_cle_privee[100];													// #
-	    etiquette3:																			// #
-			printf("\nQuel est le nom du fichier contenant la clé privée?\n\n");			// #
-			scanf(" %99s", nom_fichier_cle_privee);											// #
-			if(access( nom_fichier_cle_privee, F_OK ) != 0)									// #
-			{																				// #
-				printf("\nAttention, le nom de fichier saisi n'existe pas!");				// #  Choix entre déchiffrement d'un fichier chiffré ou d'une signature :
-				goto etiquette3;															// #
-			}																				// #  	- fichier chiffré : on récupère les clefs privées stockées dans un fichier et on les initialise (d vaut la valeur de la clef privée)
-		privee = fopen(nom_fichier_cle_privee,"rb+");										// #
-																							// #  	- signature chiffrée : on initialise d à la valeur de l'exposant publique 65537
-	    mpz_inp_raw(d,privee);																// #
-	    mpz_inp_raw(p,privee);																// #
-	    mpz_inp_raw(q,privee);																// #
-	    mpz_inp_raw(Ip,privee);																// #
-	}																						// #
-	else																					// #
-	{																						// #
-		mpz_set_ui(d,65537);																// #
-	}																						// ##
+	char nom_fichier_resultats[100];																									// ##
+	etiquette:																															// #
+		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker les mesures?\n\n");										// #
+		scanf(" %99s", nom_fichier_resultats);																							// #
+		if(access( nom_fichier_resultats, F_OK ) == 0)																					// #
+		{																																// #
+			printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
+			scanf(" %c",&choix);																										// #
+			while((choix != 'Y') & (choix != 'N'))																						// #
+			{																															// #  Création et ouverture du fichier des mesures
+				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
+				scanf(" %c",&choix);																									// #
+			}																															// #
+			if(choix == 'N')																											// #
+			{																															// #
+				goto etiquette;																											// #
+			}																															// #
+		}																																// #
+	FILE* sortie = fopen(nom_fichier_resultats,"w");																					// #
+	if(sortie == NULL)																													// #
+	{																																	// #
+		printf("\nImpossible de créer le fichier %s.\n", nom_fichier_resultats);														// #
+		goto etiquette;																													// #
+	}																																	// ##
 
+	printf("\nQuelle est la taille maximale des fichiers de test (en Ko, de 1 à 1048576)?\n\n");
+	scanf(" %lu", &taille_max);
 
-	FILE* clair;																															// ##
-	if(signature == 0)																														// #
-	{																																		// #
-		char nom_fichier_dechiffrer[100];																									// #
-		etiquette4:																															// #
-			printf("\nQuel est le nom du fichier dans lequel vous désirez stocké le clair? \n\n");											// #
-			scanf(" %99s", nom_fichier_dechiffrer);																							// #
-			if(access( nom_fichier_dechiffrer, F_OK ) == 0)																					// #
-			{																																// #
-				printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
-				scanf(" %c",&choix);																										// #
-				while((choix != 'Y') & (choix != 'N'))																						// #
-				{																															// #
-					printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #  Création et ouverture du fichier destination où l'on stocke le clair ou la signature à vérifier après déchiffrement
-					scanf(" %c",&choix);																									// #
-				}																															// #
-																																			// #
-				if(choix == 'N')																											// #
-				{																															// #
-					goto etiquette4;																										// #
-				}																															// #
-			}																																// #
-		clair = fopen(nom_fichier_dechiffrer,"wb");																						// #
-	}																																		// #
-	else																																	// #
-	{																																		// #
-		clair = fopen("signature_a_verifier","wb+");																						// #
-	}																																		// ##
+	benchmark(generateur, sortie, taille_max);
+};
 
-	fseek(cypher,0,SEEK_END);														// ##
-    taille_fichier = ftell(cypher);													// #  On récupère la taille du fichier à déchiffrer ou de la signature à déchiffrer
-    rewind(cypher);																	// ##
 
-	taille_n = taille_256(n)-1;														// ##
-    ui_expo_ui(puissance,256,taille_n);												// # Initialisation des variables pour la récupération des octets
-	mpz_set_ui(chiffre,0);
-	int dernier = 0;															// ##
+// Cette fonction mesure le débit d'un déchiffrement de fichier en mode crt avec aveuglement pour les réglages courants du profil
+// Entrée : une clef, un contexte d'aveuglement et le nom du fichier chiffré, dont le clair est autotune_clair
+// Sortie : la durée du déchiffrement en secondes, 0 si le clair obtenu est faux
+double mesurer_dechiffrement(cle_rsa* cle, contexte_aveuglement* aveuglement, char* nom_chiffre)
+{
+	FILE* cypher = fopen(nom_chiffre,"rb");
+	FILE* clair = fopen("autotune_sortie","wb");
+	double debut = chrono();
+	dechiffrer_fichier(cypher, clair, cle, 1, 0, aveuglement);
+	double duree = chrono() - debut;
+	fclose(cypher);
+	fclose(clair);
+	return fichiers_identiques("autotune_clair","autotune_sortie") ? duree : 0;
+};
 
-	if(crt == 1)																	// ##
-	{																				// #
-		mpz_sub_ui(p,p,1);															// #
-		modulo(dp,d,p);																// #
-		mpz_add_ui(p,p,1);															// #  Initialisation des variables pour le déchiffrement en mode crt
-																					// #
-		mpz_sub_ui(q,q,1);															// #
-		modulo(dq,d,q);																// #
-		mpz_add_ui(q,q,1);															// #
-	}																				// ##
 
-	do 																				// #  Boucle pour lire tout le fichier
-	{
-		compteur = compteur + mpz_inp_raw(chiffre,cypher);							// #  Mise à jour de la valeur de compteur et lecture du mpz_t chiffré
-		if(crt == 0)																// ##
-		{																			// #  Déchiffrement en mode standard ou déchiffrement de la signature
-			exp_mod(chiffre,chiffre,d,n);											// #
-		}																			// ##
-
-		if(crt == 1)																// ##
-		{																			// #
-			exp_mod(mp,chiffre,dp,p);												// #
-			exp_mod(mq,chiffre,dq,q);												// #
-			mpz_set(chiffre,mq);													// #
-			mpz_sub(chiffre,chiffre,mp);											// #  Déchiffrement en mode crt
-			mpz_mul(chiffre,chiffre,Ip);											// #
-			modulo(chiffre,chiffre,q);												// #
-			mpz_mul(chiffre,chiffre,p);												// #
-			mpz_add(chiffre,chiffre,mp);											// #
-		}																			// ##
-
-		if (compteur==taille_fichier)
+// Cette fonction mesure sur l'hôte la fenêtre d'exponentiation, le nombre de workers et le nombre de blocs par lot pour chaque taille de clef
+// La fenêtre est choisie sur des exponentiations à exposant plein, puis les workers et enfin les lots sur le déchiffrement d'un fichier
+// Entrée : un entier nombre_bit, la plus grande taille de clef mesurée, et un générateur aléatoire generateur
+// Sortie : vide mais profil_hote contient un réglage cle par taille de clef
+void optimisation_cles(unsigned int nombre_bit, gmp_randstate_t generateur)
+{
+	unsigned int tailles_bits[4] = {1024, 2048, 3072, 4096};
+	unsigned int candidats_lots[6] = {8, 16, 32, 64, 128, 256};
+	unsigned int nb_coeurs = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int candidats_workers[16];													// ##
+	unsigned int nb_candidats_workers = 0;												// #
+	for(unsigned int w = 1; (w < nb_coeurs) && (nb_candidats_workers < 15); w *= 2)		// #  Workers essayés : puissances de 2 puis le nombre de cœurs
+	{																					// #
+		candidats_workers[nb_candidats_workers++] = w;									// #
+	}																					// #
+	candidats_workers[nb_candidats_workers++] = nb_coeurs;								// ##
+
+	cle_rsa cle;
+	init_cle_rsa(&cle);
+	mpz_t chiffre, resultat, e;
+	mpz_inits(chiffre, resultat, e, NULL);
+	mpz_set_ui(e, 65537);
+
+	for(int t = 0; (t < 4) && ((t == 0) || (tailles_bits[t] <= nombre_bit)); t++)
+	{
+		unsigned int bits = tailles_bits[t];
+		cle_de_test(&cle, bits, generateur);
+		mpz_urandomm(chiffre, generateur, cle.n);
+		printf("\nClés de %u bits :\n", bits);
+
+		unsigned int meilleure_fenetre = 0;
+#ifdef MONTGOMERY_FIXE
+		double meilleur_debit = 0;
+		for(unsigned int fenetre = 1; fenetre <= MAX_FENETRE; fenetre++)
+		{
+			regler_cle(bits, fenetre, 1, BLOCS_PAR_LOT);								// ##
+			unsigned int iterations = 0;												// #
+			double debut = chrono();													// #
+			do 																			// #  Exponentiations à exposant plein pendant 0,2 seconde
+			{																			// #
+				exp_mod(resultat, chiffre, cle.d, cle.n);								// #
+				iterations++;															// #
+			}while(chrono() - debut < 0.2);												// #
+			double debit = iterations / (chrono() - debut);								// ##
+			printf("  fenêtre %u : %10.1f exponentiations/s\n", fenetre, debit);
+			if(debit > meilleur_debit)
+			{
+				meilleur_debit = debit;
+				meilleure_fenetre = fenetre;
+			}
+		}
+#endif
+
+		int taille_n = taille_256(cle.n)-1;												// ##
+		creer_fichier_test("autotune_clair", 256*(taille_n-8), generateur);				// #
+		FILE* clair = fopen("autotune_clair","rb");										// #  Fichier de test de 256 blocs chiffré une fois
+		FILE* cypher = fopen("autotune_chiffre","wb");									// #
+		chiffrer_fichier(clair, cypher, cle.n, NULL, FORMAT_PREFIXE);					// #
+		fclose(clair);																	// #
+		fclose(cypher);																	// ##
+		contexte_aveuglement aveuglement;
+		init_aveuglement(&aveuglement, e, cle.n);
+
+		unsigned int meilleurs_workers = 1;
+		unsigned int meilleur_lot = BLOCS_PAR_LOT;
+		double meilleure_duree = 0;
+		for(unsigned int i = 0; i < nb_candidats_workers; i++)
+		{
+			regler_cle(bits, meilleure_fenetre, candidats_workers[i], BLOCS_PAR_LOT);
+			double duree = mesurer_dechiffrement(&cle, &aveuglement, "autotune_chiffre");
+			printf("  %3u workers, %4u blocs par lot : %8.3f s\n", candidats_workers[i], BLOCS_PAR_LOT, duree);
+			if((duree > 0) && ((meilleure_duree == 0) || (duree < meilleure_duree)))
+			{
+				meilleure_duree = duree;
+				meilleurs_workers = candidats_workers[i];
+			}
+		}
+		for(int l = 0; l < 6; l++)
 		{
-			dernier=1;
+			regler_cle(bits, meilleure_fenetre, meilleurs_workers, candidats_lots[l]);
+			double duree = mesurer_dechiffrement(&cle, &aveuglement, "autotune_chiffre");
+			printf("  %3u workers, %4u blocs par lot : %8.3f s\n", meilleurs_workers, candidats_lots[l], duree);
+			if((duree > 0) && ((meilleure_duree == 0) || (duree < meilleure_duree)))
+			{
+				meilleure_duree = duree;
+				meilleur_lot = candidats_lots[l];
+			}
 		}
-		inv_OAEP(taille_n,dernier,chiffre,clair);
-	}while(compteur < taille_fichier);												
 
-	fclose(cypher);																	// ##
-	fclose(clair);																	// #
-	fclose(publique);																// #
-	if(signature == 0)																// #  Fermeture des fichiers
-	{																				// #
-		fclose(privee);																// #
-	}																				// #
-	mpz_clears(n, d, p, q, Ip, chiffre, puissance, div, dp, dq, mp, mq, NULL);		// ##
+		regler_cle(bits, meilleure_fenetre, meilleurs_workers, meilleur_lot);
+		printf("  => fenêtre %u, %u workers, %u blocs par lot retenus\n", meilleure_fenetre, meilleurs_workers, meilleur_lot);
+		clear_aveuglement(&aveuglement);
+	}
+
+	remove("autotune_clair");															// ##
+	remove("autotune_chiffre");															// #  Suppression des fichiers de test
+	remove("autotune_sortie");															// ##
+	clear_cle_rsa(&cle);
+	mpz_clears(chiffre, resultat, e, NULL);
 };
 
 
-// Cette fonction sert à vérifier une signature
-// Entrée : vide
-// Sortie : vide mais affichage de la validité de la signature
-void verification_signature()
+// Cette fonction mesure tous les réglages de l'hôte et écrit le profil lu au démarrage
+// Entrée : un générateur aléatoire generateur
+// Sortie : vide mais FICHIER_PROFIL contient les réglages crible et cle mesurés
+void optimisation_hote(gmp_randstate_t generateur)
 {
-	decrypt(0,1);																	// #  Déchiffrement de la signature
-
-	int caractere1, caractere2;																						// ##
-	char nom_fichier_a_verifier[100];																				// #
-	etiquette:																										// #
-		printf("\nQuel est le nom du fichier original dont vous voulez vérifier la signature associée? \n\n");		// #
-		scanf(" %99s", nom_fichier_a_verifier);																		// #
-		if(access( nom_fichier_a_verifier, F_OK ) != 0)																// #  Ouverture du fichier original et du fichier contenant la signature déchiffrée
-		{																											// #
-			printf("\nAttention, le nom de fichier saisi n'existe pas!");											// #
-			goto etiquette;																							// #
-		}																											// #
-	SHA256(nom_fichier_a_verifier);																					// #
-	FILE* cypher = fopen("HASHER","rb+");																			// #
-	FILE* signature = fopen("signature_a_verifier","rb+");															// ##
+	unsigned int nombre_bit;
+	printf("\nJusqu'à quelle longueur de clé publique faut-il optimiser (en bit) ?\n\n");
+	scanf(" %u", &nombre_bit);
 
-	caractere1 = fgetc(cypher);														// ##
-	caractere2 = fgetc(signature);													// #
-	while((caractere1 != EOF) & (caractere2 != EOF) & (caractere1 == caractere2))	// #
-	{																				// #  Comparaison octet par octet des deux fichiers
-		caractere1 = fgetc(cypher);													// #
-		caractere2 = fgetc(signature);												// #
-	}																				// ##
+	optimisation_crible(nombre_bit);
+	optimisation_cles(nombre_bit, generateur);
 
-	if(caractere1 == caractere2)													// ##
-	{																				// #
-		printf("\nLa signature est valide!\n\n");									// #
-	}																				// #  Affichage du résultat
-	else																			// #
-	{																				// #
-		printf("\nLa signature est invalide.\n\n");									// #
-	}																				// ##
-	
-	fclose(cypher);																	// ##
-	fclose(signature);																// #  Fermeture des fichiers et suppression du fichier intermédiaire
-	remove("signature_a_verifier");													// #
-	remove("HASHER");																// ##											
+	ecrire_profil_hote();
+	printf("\nProfil écrit dans %s.\n", FICHIER_PROFIL);
 };
 
 
 // Corps du programme
-int main()
+// Lancé avec --benchmark <fichier JSON> <taille maximale en Ko>, le programme mesure ses performances sans poser de question puis s'arrête
+int main(int argc, char* argv[])
 {
 	gmp_randstate_t generateur;					// ##
 	gmp_randinit_default(generateur);			// #  Initialisation des variable et du générateur aléatoire
-	gmp_randseed_ui(generateur, time(NULL));	// #
-	unsigned int choix1, choix2, nombre_bit;	// ##
-
-	printf("\nBienvenue dans le programme de chiffrement RSA, que souhaitez-vous faire?\n\n1 : Générer de nouvelles clés RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");	// #  Affichage des options du programme
+	semer_generateur_gmp(generateur);			// #
+	charger_profil_hote();						// #  Lecture des réglages mesurés sur cette machine
+	unsigned int choix1, choix2, nombre_bit;	// #
+	unsigned int crt, temps_constant;			// ##
+#ifdef MONTGOMERY_FIXE
+	choisir_backend_montgomery();				// Noyaux de Montgomery adaptés au processeur
+#endif
+
+	if((argc > 1) && (strcmp(argv[1], "--benchmark") == 0))																		// ##
+	{																																// #
+		char* fin = NULL;																											// #
+		unsigned long taille_max = (argc == 4) ? strtoul(argv[3], &fin, 10) : 0;													// #
+		if((argc != 4) || (*fin != '\0') || (taille_max == 0))																		// #
+		{																															// #
+			fprintf(stderr, "Usage : %s --benchmark <fichier JSON> <taille maximale des fichiers de test en Ko>\n", argv[0]);		// #
+			gmp_randclear(generateur);																								// #
+			return 1;																												// #
+		}																															// #  Mesure des performances sans interaction
+		FILE* sortie = fopen(argv[2], "w");																							// #
+		if(sortie == NULL)																											// #
+		{																															// #
+			fprintf(stderr, "Impossible de créer le fichier %s.\n", argv[2]);														// #
+			gmp_randclear(generateur);																								// #
+			return 1;																												// #
+		}																															// #
+		benchmark(generateur, sortie, taille_max);																					// #
+		gmp_randclear(generateur);																									// #
+		return 0;																													// #
+	}																																// ##
+
+	printf("\nBienvenue dans le programme de chiffrement RSA, que souhaitez-vous faire?\n\n" MENU);	// #  Affichage des options du programme
 	
 
 	marqueur:
-		scanf(" %d", &choix1);																																																																// ##
-		while((choix1 != 1) & (choix1 != 2) & (choix1 != 3) & (choix1 != 4) & (choix1 != 5) & (choix1 != 6))																																												// #
-		{																																																																					// #  Boucle pour avoir une réponse valide
-			printf("\nLe chiffre que vous avez indiqué ne correspond à aucune commande, que souhaiez-vous faire?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");	// #
-			scanf(" %d", &choix1);																																																															// #
-		}																																																																					// ##
+		scanf(" %d", &choix1);																									// ##
+		while((choix1 < 1) | (choix1 > NB_OPTIONS))																				// #
+		{																														// #  Boucle pour avoir une réponse valide
+			printf("\nLe chiffre que vous avez indiqué ne correspond à aucune commande, que souhaiez-vous faire?\n\n" MENU);	// #
+			scanf(" %d", &choix1);																								// #
+		}																														// ##
 		
 
 		switch(choix1)	// #  Switch séparant toutes les options du programmes
@@ -1303,10 +7136,10 @@ int main()
 				scanf(" %d", &nombre_bit);
 
 
-				generation_cle(nombre_bit, generateur);
+				generation_cle(nombre_bit);
 
 
-				printf("\nQue souhaiez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaiez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
@@ -1314,10 +7147,19 @@ int main()
 			case 2:		// #  Chiffrement d'un fichier
 
 
-				encrypt(0);
+				printf("\nDans quel format souhaitez-vous chiffrer?\n\n1 : Blocs préfixés par leur taille\n2 : Blocs compacts de la taille du module\n3 : Blocs compacts, clair compressé\n\n");												// ##
+				scanf(" %d", &choix2);																																					// #
+				while((choix2 < 1) | (choix2 > 3))																																		// #  Choix du format du chiffré
+				{																																										// #
+					printf("\nLe chiffre que vous avez indiqué ne correspond à aucune commande, dans quel format souhaitez-vous chiffrer?\n\n1 : Blocs préfixés par leur taille\n2 : Blocs compacts de la taille du module\n3 : Blocs compacts, clair compressé\n\n");	// #
+					scanf(" %d", &choix2);																																				// #
+				}																																										// ##
 
 
-				printf("\nQue souhaiez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				encrypt(0, choix2 - 1);
+
+
+				printf("\nQue souhaiez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
@@ -1325,46 +7167,40 @@ int main()
 
 			case 3:		// #  Déchiffrement d'un fichier
 				
-				printf("\nComment souhaitez-vous déchiffrer?\n\n1 : Mode classique\n2 : Mode CRT\n\n");																									// ##
-				scanf(" %d", &choix2);																																									// #
-				while((choix2 != 1) & (choix2 != 2))																																					// #
-				{																																														// #  Choix du mode de déchiffrement
-					printf("\nLe chiffre que vous avez indiqué ne correspond à aucune commande, comment souhaitez-vous déchiffrer?\n\n1 : Mode classique\n2 : Mode CRT\n3 : Arret du programme\n\n");	// #
-					scanf(" %d", &choix2);																																								// #
-				}																																														// ##
-
-
-				if(choix2 == 3)
-				{
-					printf("\nArret du programme.\n");
-					break;
-				}
+				printf("\nComment souhaitez-vous déchiffrer?\n\n1 : Mode classique\n2 : Mode CRT\n3 : Mode classique à temps constant\n4 : Mode CRT à temps constant\n5 : Mode CRT parallèle\n6 : Mode CRT parallèle à temps constant\n\n");																			// ##
+				scanf(" %d", &choix2);																																																				// #
+				while((choix2 < 1) | (choix2 > 6))																																																	// #
+				{																																																									// #  Choix du mode de déchiffrement
+					printf("\nLe chiffre que vous avez indiqué ne correspond à aucune commande, comment souhaitez-vous déchiffrer?\n\n1 : Mode classique\n2 : Mode CRT\n3 : Mode classique à temps constant\n4 : Mode CRT à temps constant\n5 : Mode CRT parallèle\n6 : Mode CRT parallèle à temps constant\n\n");	// #
+					scanf(" %d", &choix2);																																																			// #
+				}																																																									// ##
 
 
 
-				decrypt(choix2-1,0);
+				mode_dechiffrement(choix2,&crt,&temps_constant);
+				decrypt(crt,0,temps_constant);
 
 
 
-				printf("\nQue souhaitez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
 			case 4:		// #  Signature d'un fichier
 
 
-				encrypt(1);
+				encrypt(1, FORMAT_PREFIXE);
 
-				printf("\nQue souhaitez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
 			case 5:		// #  Vérification d'une signature
 
 
-				verification_signature();
+				verification_signature(0);
 
-				printf("\nQue souhaitez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
@@ -1372,8 +7208,99 @@ int main()
 
 				printf("\nArret du programme.\n");
 				break;
+
+			case 7:		// #  Mesure des performances
+
+
+				benchmark_interactif(generateur);
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
+
+			case 8:		// #  Démon sur une socket Unix
+
+
+				demon();
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
+
+			case 9:		// #  Vérification d'un lot de signatures
+
+
+				verification_lot_signatures();
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
+
+			case 10:	// #  Signature de la racine de l'arbre de Merkle d'un fichier
+
+
+				encrypt(2, FORMAT_PREFIXE);
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
+
+			case 11:	// #  Vérification d'une signature en arbre de Merkle
+
+
+				verification_signature(1);
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
+
+			case 12:	// #  Génération d'un lot de clefs RSA
+
+
+				generation_lot_cles();
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
+
+			case 13:	// #  Recherche de premiers à l'avance pour la génération de clefs
+
+
+				remplissage_reserve_premiers();
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
+
+			case 14:	// #  Mesure des réglages de l'hôte
+
+
+				optimisation_hote(generateur);
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
+
+			case 15:	// #  Chiffrement d'un fichier pour plusieurs destinataires
+
+
+				printf("\nDans quel format souhaitez-vous chiffrer?\n\n1 : Blocs préfixés par leur taille\n2 : Blocs compacts de la taille du module\n3 : Blocs compacts, clair compressé\n\n");												// ##
+				scanf(" %d", &choix2);																																					// #
+				while((choix2 < 1) | (choix2 > 3))																																		// #  Choix du format des chiffrés
+				{																																										// #
+					printf("\nLe chiffre que vous avez indiqué ne correspond à aucune commande, dans quel format souhaitez-vous chiffrer?\n\n1 : Blocs préfixés par leur taille\n2 : Blocs compacts de la taille du module\n3 : Blocs compacts, clair compressé\n\n");	// #
+					scanf(" %d", &choix2);																																				// #
+				}																																										// ##
+
+
+				encrypt_destinataires(choix2 - 1);
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
 		}
 
+	vider_magasin_cles();						// #  Effacement des clefs en mémoire
 	gmp_randclear(generateur);
 	return 0;
 };
\ No newline at end of file
@@ -4,9 +4,188 @@
 #include <time.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdint.h>
+#include <sys/random.h>
+#include <sys/stat.h>
 
-#define K 200        // Le nombre de premiers utilisés pour le crible K<=1000
-#define securite 10  // t le paramètre entier de sécurité pour Miller-Rabin
+#define K 200        // Le nombre de premiers utilisés pour le crible sans profil de l'hôte
+#define TAILLE_LECTURE 1048576  // La taille des lectures et des tampons de fichiers (en octets)
+
+#define NB_OPTIONS 7  // Le nombre d'options du menu principal
+#define MENU "1 : Générer de nouvelles clés RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n7 : Mesurer les performances\n\n"
+
+
+// Générateur pseudo-aléatoire cryptographique ChaCha20, un par thread, initialisé avec getrandom()
+// Chaque recharge produit TAILLE_RESERVE_ALEA octets dont les 32 premiers remplacent la clef (effacement rapide de la clef)
+#define TAILLE_RESERVE_ALEA 1024		// Le nombre d'octets produits à chaque recharge du générateur
+#define RECHARGES_AVANT_RESEMENCE 65536	// Le nombre de recharges entre deux appels à getrandom()
+
+typedef struct
+{
+	uint32_t cle[8];
+	uint64_t compteur;
+	unsigned char reserve[TAILLE_RESERVE_ALEA];
+	unsigned int position;
+	unsigned int recharges;
+} generateur_chacha20;
+
+_Thread_local generateur_chacha20 alea_thread = { .position = TAILLE_RESERVE_ALEA };
+
+#define ROTATION(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define QUART_DE_TOUR(a, b, c, d) \
+	a += b; d ^= a; d = ROTATION(d, 16); \
+	c += d; b ^= c; b = ROTATION(b, 12); \
+	a += b; d ^= a; d = ROTATION(d, 8); \
+	c += d; b ^= c; b = ROTATION(b, 7)
+
+
+// Cette fonction calcule un bloc de 64 octets du flux ChaCha20 (nonce nul, compteur sur 64 bits)
+// Entrée : un tableau sortie de 64 octets, une clef de 8 mots de 32 bits et un compteur de bloc
+// Sortie : vide mais sortie contient le bloc du flux en little-endian
+void bloc_chacha20(unsigned char* sortie, uint32_t* cle, uint64_t compteur)
+{
+	uint32_t etat[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};	// ##
+	memcpy(etat+4, cle, 32);												// #  Constantes, clef, compteur et nonce nul
+	etat[12] = (uint32_t) compteur;											// #
+	etat[13] = (uint32_t) (compteur >> 32);									// ##
+
+	uint32_t x[16];
+	memcpy(x, etat, sizeof(x));
+	for(int i = 0; i < 10; i++)												// ##
+	{																		// #
+		QUART_DE_TOUR(x[0], x[4], x[8], x[12]);								// #
+		QUART_DE_TOUR(x[1], x[5], x[9], x[13]);								// #
+		QUART_DE_TOUR(x[2], x[6], x[10], x[14]);							// #
+		QUART_DE_TOUR(x[3], x[7], x[11], x[15]);							// #  20 tours : 10 doubles tours colonnes puis diagonales
+		QUART_DE_TOUR(x[0], x[5], x[10], x[15]);							// #
+		QUART_DE_TOUR(x[1], x[6], x[11], x[12]);							// #
+		QUART_DE_TOUR(x[2], x[7], x[8], x[13]);								// #
+		QUART_DE_TOUR(x[3], x[4], x[9], x[14]);								// #
+	}																		// ##
+
+	for(int i = 0; i < 16; i++)												// ##
+	{																		// #
+		uint32_t mot = x[i] + etat[i];										// #
+		sortie[4*i] = mot;													// #  Ajout de l'état initial et sérialisation
+		sortie[4*i+1] = mot >> 8;											// #
+		sortie[4*i+2] = mot >> 16;											// #
+		sortie[4*i+3] = mot >> 24;											// #
+	}																		// ##
+};
+
+
+// Cette fonction recharge la réserve du générateur du thread et renouvelle sa clef, en la ressemant avec getrandom() au premier appel puis périodiquement
+// Entrée : un générateur
+// Sortie : vide mais la réserve contient TAILLE_RESERVE_ALEA-32 octets neufs
+void recharger_alea(generateur_chacha20* generateur)
+{
+	if(generateur->recharges % RECHARGES_AVANT_RESEMENCE == 0)								// ##
+	{																						// #
+		uint32_t graine[8];																	// #
+		size_t lu = 0;																		// #
+		while(lu < sizeof(graine))															// #
+		{																					// #
+			ssize_t r = getrandom((unsigned char*) graine + lu, sizeof(graine) - lu, 0);	// #  Semence (ou resemence) avec l'aléa du noyau
+			if(r > 0)																		// #
+			{																				// #
+				lu += r;																	// #
+			}																				// #
+		}																					// #
+		for(int i = 0; i < 8; i++)															// #
+		{																					// #
+			generateur->cle[i] ^= graine[i];												// #
+		}																					// #
+		memset(graine, 0, sizeof(graine));													// #
+	}																						// ##
+	generateur->recharges++;
+
+	for(unsigned int i = 0; i < TAILLE_RESERVE_ALEA; i += 64)								// ##
+	{																						// #  Production de la réserve
+		bloc_chacha20(generateur->reserve + i, generateur->cle, generateur->compteur++);	// #
+	}																						// ##
+
+	memcpy(generateur->cle, generateur->reserve, 32);										// ##
+	memset(generateur->reserve, 0, 32);														// #  Les 32 premiers octets deviennent la nouvelle clef
+	generateur->position = 32;																// ##
+};
+
+
+// Cette fonction remplit un tampon d'octets aléatoires avec le générateur du thread appelant
+// Entrée : un tableau tampon et sa taille
+// Sortie : vide mais tampon contient taille octets aléatoires
+void alea_octets(unsigned char* tampon, size_t taille)
+{
+	generateur_chacha20* generateur = &alea_thread;
+	while(taille > 0)
+	{
+		if(generateur->position == TAILLE_RESERVE_ALEA)							// #  Recharge lorsque la réserve est vide
+		{																		// #
+			recharger_alea(generateur);											// #
+		}																		// #
+		size_t morceau = TAILLE_RESERVE_ALEA - generateur->position;			// ##
+		if(morceau > taille)													// #
+		{																		// #
+			morceau = taille;													// #
+		}																		// #  Copie puis effacement des octets servis
+		memcpy(tampon, generateur->reserve + generateur->position, morceau);	// #
+		memset(generateur->reserve + generateur->position, 0, morceau);			// #
+		generateur->position += morceau;										// #
+		tampon += morceau;														// #
+		taille -= morceau;														// ##
+	}
+};
+
+
+// Cette fonction remplit un tampon d'octets aléatoires non nuls, pour le padding PKCS#1 v1.5
+// Entrée : un tableau tampon et sa taille
+// Sortie : vide mais tampon contient taille octets aléatoires entre 1 et 255
+void alea_octets_non_nuls(unsigned char* tampon, size_t taille)
+{
+	alea_octets(tampon, taille);
+	for(size_t i = 0; i < taille; i++)
+	{
+		while(tampon[i] == 0)			// #  Nouveau tirage des octets nuls
+		{								// #
+			alea_octets(tampon+i, 1);	// #
+		}								// #
+	}
+};
+
+
+// Cette fonction initialise un générateur GMP avec 256 bits issus du générateur ChaCha20
+// Entrée : un générateur aléatoire GMP
+// Sortie : vide mais le générateur est semé
+void semer_generateur_gmp(gmp_randstate_t generateur)
+{
+	unsigned char graine[32];
+	mpz_t z;
+	alea_octets(graine, sizeof(graine));
+	mpz_init(z);
+	mpz_import(z, sizeof(graine), 1, 1, 1, 0, graine);
+	gmp_randseed(generateur, z);
+	mpz_clear(z);
+	memset(graine, 0, sizeof(graine));
+};
+
+
+// Cette fonction tire un mpz uniforme entre 0 et borne-1 directement avec le générateur ChaCha20 du thread, en rejetant les tirages trop grands
+// Les valeurs secrètes (bases de Miller-Rabin, candidats premiers) ne passent ainsi jamais par le générateur de GMP
+// Entrée : deux mpz resultat et borne, avec borne > 0
+// Sortie : vide mais resultat contient le tirage
+void alea_mpz(mpz_t resultat, const mpz_t borne)
+{
+	size_t bits = mpz_sizeinbase(borne, 2);
+	size_t octets = (bits + 7) / 8;
+	unsigned char* tampon = malloc(octets);
+	do
+	{
+		alea_octets(tampon, octets);
+		tampon[0] &= 0xFF >> (8*octets - bits);					// #  Autant de bits que borne, moins d'un tirage sur deux est rejeté
+		mpz_import(resultat, octets, 1, 1, 1, 0, tampon);
+	}while(mpz_cmp(resultat, borne) >= 0);
+	memset(tampon, 0, octets);
+	free(tampon);
+};
 
 
 // Cette fonction renvoie le reste modulaire d'un unsigned int
@@ -180,10 +359,157 @@ void modular_inv(mpz_t inv_mod, mpz_t b, mpz_t a)
 };
 
 
+// Profil de l'hôte : réglages mesurés sur la machine par le mode d'optimisation de RSA.c, lus au démarrage dans FICHIER_PROFIL
+// Une ligne par réglage, les lignes inconnues sont ignorées. Sans profil les valeurs par défaut sont utilisées
+#define FICHIER_PROFIL "profil_hote.txt"
+#define MAX_K 8192					// Le nombre maximal de premiers du crible, calculés au démarrage
+#define NB_TAILLES_PROFIL 16		// Le nombre de tailles de premiers réglées dans le profil
+
+// Réglage du crible pour une taille de premier : nombre de premiers du crible et tours de Miller-Rabin
+typedef struct
+{
+	unsigned int bits;
+	unsigned int k;
+	unsigned int tours;
+} reglage_crible;
+
+struct
+{
+	reglage_crible crible[NB_TAILLES_PROFIL];
+	unsigned int nb_crible;
+} profil_hote;
+
+unsigned int premiers_crible[MAX_K];								// Les MAX_K plus petits premiers, calculés au premier besoin
+
+
+// Cette fonction calcule les MAX_K plus petits premiers par le crible d'Eratosthène
+// Entrée : vide
+// Sortie : vide mais premiers_crible est rempli
+void calculer_premiers_crible()
+{
+	unsigned int limite = 100000;									// ##
+	unsigned char* compose = calloc(limite, 1);						// #
+	unsigned int nb = 0;											// #
+	for(unsigned int i = 2; (i < limite) && (nb < MAX_K); i++)		// #
+	{																// #
+		if(compose[i] == 0)											// #  Le MAX_K-ième premier (84589 pour 8192) est sous la limite
+		{															// #
+			premiers_crible[nb++] = i;								// #
+			for(unsigned long j = (unsigned long) i*i; j < limite; j += i)	// #
+			{														// #
+				compose[j] = 1;										// #
+			}														// #
+		}															// #
+	}																// #
+	free(compose);													// ##
+};
+
+
+// Cette fonction donne le nombre de tours de Miller-Rabin pour une probabilité d'erreur inférieure à 2^-80 sur un candidat aléatoire
+// Les seuils sont ceux de la table 4.4 du Handbook of Applied Cryptography (Damgård, Landrock et Pomerance)
+// Entrée : un entier bits
+// Sortie : le nombre de tours
+unsigned int tours_miller_rabin(unsigned int bits)
+{
+	unsigned int seuils[11] = {1300, 850, 650, 550, 450, 400, 350, 300, 250, 200, 150};
+	unsigned int tours[11] = {2, 3, 4, 5, 6, 7, 8, 9, 12, 15, 18};
+	for(int i = 0; i < 11; i++)
+	{
+		if(bits >= seuils[i])
+		{
+			return tours[i];
+		}
+	}
+	return 27;
+};
+
+
+// Cette fonction donne le réglage du profil le plus proche d'une taille de premier
+// Entrée : un entier bits
+// Sortie : un pointeur vers le réglage, NULL si le profil n'en contient pas
+reglage_crible* reglage_pour(unsigned int bits)
+{
+	reglage_crible* meilleur = NULL;
+	for(unsigned int i = 0; i < profil_hote.nb_crible; i++)
+	{
+		reglage_crible* reglage = &profil_hote.crible[i];
+		if((meilleur == NULL) || (abs((int) reglage->bits - (int) bits) < abs((int) meilleur->bits - (int) bits)))
+		{
+			meilleur = reglage;
+		}
+	}
+	return meilleur;
+};
+
+
+// Cette fonction donne le nombre de premiers du crible pour une taille de premier, K sans profil
+// Entrée : un entier bits
+// Sortie : le nombre de premiers du crible
+unsigned int taille_crible(unsigned int bits)
+{
+	reglage_crible* reglage = reglage_pour(bits);
+	return (reglage != NULL) ? reglage->k : K;
+};
+
+
+// Cette fonction donne le nombre de tours de Miller-Rabin pour une taille de premier, celui de la table sans profil
+// Entrée : un entier bits
+// Sortie : le nombre de tours
+unsigned int nb_tours_miller_rabin(unsigned int bits)
+{
+	reglage_crible* reglage = reglage_pour(bits);
+	return ((reglage != NULL) && (reglage->bits == bits)) ? reglage->tours : tours_miller_rabin(bits);
+};
+
+
+// Cette fonction ajoute ou remplace le réglage d'une taille de premier dans le profil
+// Le profil peut seulement augmenter le nombre de tours : il ne descend jamais sous celui de tours_miller_rabin()
+// Entrée : trois entiers bits, k et tours
+// Sortie : vide
+void regler_crible(unsigned int bits, unsigned int k, unsigned int tours)
+{
+	reglage_crible* reglage = reglage_pour(bits);
+	if((reglage == NULL) || (reglage->bits != bits))
+	{
+		if(profil_hote.nb_crible == NB_TAILLES_PROFIL)
+		{
+			return;
+		}
+		reglage = &profil_hote.crible[profil_hote.nb_crible++];
+	}
+	reglage->bits = bits;
+	reglage->k = (k > MAX_K) ? MAX_K : ((k < 1) ? 1 : k);
+	reglage->tours = (tours < tours_miller_rabin(bits)) ? tours_miller_rabin(bits) : tours;
+};
+
+
+// Cette fonction lit le profil de l'hôte s'il existe
+// Entrée : vide
+// Sortie : vide mais profil_hote contient les réglages du fichier
+void charger_profil_hote()
+{
+	FILE* fichier = fopen(FICHIER_PROFIL,"r");
+	if(fichier == NULL)
+	{
+		return;
+	}
+	char ligne[256];
+	unsigned int bits, k, tours;
+	while(fgets(ligne, sizeof(ligne), fichier) != NULL)
+	{
+		if(sscanf(ligne, "crible %u %u %u", &bits, &k, &tours) == 3)
+		{
+			regler_crible(bits, k, tours);
+		}
+	}
+	fclose(fichier);
+};
+
+
 // Cette fonction vérifie si un nombre et premier par Miller-Rabin
-// Entrée : un mpz nombre et un générateur aléatoire generateur
+// Entrée : un mpz nombre, les bases sont tirées du générateur ChaCha20 du thread
 // Sortie : 0 si nombre est composé et 1 s'il est probablement premier
-int Miller_Rabin(mpz_t nombre, gmp_randstate_t generateur)
+int Miller_Rabin(mpz_t nombre)
 {
 	mpz_t r, a, y, j;
 	mpz_inits(r, a, y, j, NULL);											// ##
@@ -197,10 +523,11 @@ int Miller_Rabin(mpz_t nombre, gmp_randstate_t generateur)
 		mpz_divexact_ui(r,r,2);												// #
 	}																		// ##
 
-	for(unsigned int i =1; i< securite; i++)								// Boucle avec le paramètre de sécurité
+	unsigned int tours = nb_tours_miller_rabin(mpz_sizeinbase(nombre,2));	// Nombre de tours pour une erreur inférieure à 2^-80 ou celui du profil
+	for(unsigned int i = 0; i < tours; i++)									// Boucle avec le paramètre de sécurité
 	{
 		mpz_sub_ui(nombre,nombre,3);										// ##
-		mpz_urandomm(a, generateur, nombre);								// #  Tirage aléatoire de a entre 2 et n-2
+		alea_mpz(a, nombre);												// #  Tirage aléatoire de a entre 2 et n-2
 		mpz_add_ui(nombre,nombre,3);										// #
 		mpz_add_ui(a, a, 2);												// ##
 
@@ -239,27 +566,23 @@ int Miller_Rabin(mpz_t nombre, gmp_randstate_t generateur)
 
 
 // Cette fonction génère aléatoirement un nombre premier par la méthode du crible optimisé
-// Entrée : un mpz nb_premier, un entier b et un générateur alétoire state
+// Entrée : un mpz nb_premier et un entier b, le candidat est tiré du générateur ChaCha20 du thread
 // Sortie : vide mais nb_premier est un nombre premier de taille b bits
-void optimized_crible_generation(mpz_t nb_premier, unsigned int b, gmp_randstate_t state)
+void optimized_crible_generation(mpz_t nb_premier, unsigned int b)
 {
 	mpz_t sub;												// ##																			
 	mpz_t s_1;												// #  Initialisation des variables
 	mpz_t s_2;												// #
 	mpz_inits(sub,s_1,s_2,NULL);							// ##
 
-	unsigned int res[K];									// ##
-	unsigned int r;											// #  Déclaration d'un tableau de résidus et d'un tableau de premiers de taille K
-	unsigned int premiers[K];								// ##
-	
-	FILE* fichier;											// #  Ouverture du fichier contenant les XX premiers nombres premiers
-	fichier = fopen("primes.txt","r");						// #
-	
-	for(unsigned int i = 0; i< K; i++)						// ##
+	if(premiers_crible[0] == 0)								// ##
 	{														// #
-		fscanf(fichier,"%d",premiers+i);					// #  Lecture et stockage des K plus petits premiers
-		fgetc(fichier);										// #
-	}														// ##
+		calculer_premiers_crible();							// #
+	}														// #
+	unsigned int k = taille_crible(b);						// #  Déclaration d'un tableau de résidus de taille k, celle du profil pour b bits
+	unsigned int res[k];									// #
+	unsigned int r;											// #
+	unsigned int* premiers = premiers_crible;				// ##
 	
 	ui_expo_ui(s_1,2,b);									// ##
 	ui_expo_ui(s_2,2,b-1);									// #  Calcul de sub = 2^b - 2^(b-1) -1
@@ -268,23 +591,23 @@ void optimized_crible_generation(mpz_t nb_premier, unsigned int b, gmp_randstate
 	
 	do 														// ##
 	{														// #
-		mpz_urandomm(nb_premier,state,sub);					// #  Génération d'un nombre aléatoire impaire s'écrivant sur b bits
+		alea_mpz(nb_premier,sub);							// #  Génération d'un nombre aléatoire impaire s'écrivant sur b bits
 		mpz_add(nb_premier,nb_premier,s_2);					// #
 		r = modulo_ui(nb_premier,2);						// #
 	}while(r == 0);											// ##
 	
-	for(int i=0;i<K;i++) 									// ## 
+	for(unsigned int i=0;i<k;i++) 						// ## 
 	{														// #
 		r = modulo_ui(nb_premier,premiers[i]);				// #  Initialisation du tableau de résidus
 		res[i] = r;											// #
 	}														// ##
 
 	etiquette:
-		for(unsigned int j=0;j<K;j++)						// ##
+		for(unsigned int j=0;j<k;j++)						// ##
 		{													// #
 			while(res[j] == 0)								// #
 			{												// #
-				for(unsigned int l=0;l<K;l++)				// #
+				for(unsigned int l=0;l<k;l++)				// #
 				{											// #  Modification de nb_premier jusqu'à trouver un candidat
 					res[l] = mod(res[l]+2, premiers[l]);	// #
 				}											// #
@@ -292,9 +615,9 @@ void optimized_crible_generation(mpz_t nb_premier, unsigned int b, gmp_randstate
 			}												// #
 		}													// ##
 
-		if(Miller_Rabin(nb_premier,state) == 0)				// ##
+		if(Miller_Rabin(nb_premier) == 0)					// ##
 		{													// #
-			for(int m=0;m<K;m++)							// #
+			for(unsigned int m=0;m<k;m++)				// #
 			{												// #
 				res[m] = mod(res[m]+2, premiers[m]);		// #  Appel de la fonction Miller_Rabin() pour tester notre candidat, on recommence au cas échéant
 			}												// #
@@ -304,15 +627,14 @@ void optimized_crible_generation(mpz_t nb_premier, unsigned int b, gmp_randstate
 		goto etiquette2;
 
 	etiquette2:
-		fclose(fichier);
 		mpz_clears(sub,s_1,s_2,NULL);
 };
 
 
 // Cette fonction génère l'ensemble des clefs publique et secrète nécessaire pour RSA
-// Entrée : un entier nombre_bit et un génnérateur aléatoire generateur
+// Entrée : un entier nombre_bit
 // Sortie : vide mais création d'un fichier contenant une clef publique et un autre la clef secrète associée
-void generation_cle(unsigned int nombre_bit, gmp_randstate_t generateur)
+void generation_cle(unsigned int nombre_bit)
 {
 
 	mpz_t borne, phi, e, cle_publique, cle_prive, p, q, Ip;							// ##
@@ -367,13 +689,13 @@ void generation_cle(unsigned int nombre_bit, gmp_randstate_t generateur)
 	{																				// #
 		if( mod(nombre_bit,2) == 0)													// #
 		{																			// #
-			optimized_crible_generation(p, nombre_bit/2, generateur);				// #
-			optimized_crible_generation(q, nombre_bit/2, generateur);				// #
+			optimized_crible_generation(p, nombre_bit/2);							// #
+			optimized_crible_generation(q, nombre_bit/2);							// #
 		}																			// #
 		else																		// # Appel de la fonction optimized_crible_generation() pour génèrer p et q et calcul de la clef publique avec vériffication de sa taille
 		{																			// #
-			optimized_crible_generation(p, (nombre_bit-1)/2, generateur);			// #
-			optimized_crible_generation(q, (nombre_bit+1)/2, generateur);			// #
+			optimized_crible_generation(p, (nombre_bit-1)/2);						// #
+			optimized_crible_generation(q, (nombre_bit+1)/2);						// #
 		}																			// #
 		mpz_mul(cle_publique, p, q);												// #
 	}																				// #
@@ -446,9 +768,173 @@ void SHA256(char* nom_du_fichier_a_hasher)
 };
 
 
+// Cette fonction construit un bloc PKCS#1 v1.5 de k octets : 0x00 || type || PS || 0x00 || données
+// Entrée : un tableau bloc de k octets, un entier k, un tableau donnees de taille_donnees octets (au plus k-11) et un entier signature, si signature vaut 0 le bloc est de type 2 (PS aléatoire non nul), si signature vaut 1 il est de type 1 (PS rempli de 0xFF)
+// Sortie : vide mais bloc contient le message encodé
+void encoder_pkcs1(unsigned char* bloc, int k, unsigned char* donnees, int taille_donnees, unsigned int signature)
+{
+	int taille_padding = k - 3 - taille_donnees;										// #  Au moins 8 octets de padding
+
+	bloc[0] = 0x00;																		// ##
+	if(signature == 0)																	// #
+	{																					// #
+		bloc[1] = 0x02;																	// #
+		alea_octets_non_nuls(bloc+2, taille_padding);									// #  En-tête et padding PS
+	}																					// #
+	else																				// #
+	{																					// #
+		bloc[1] = 0x01;																	// #
+		memset(bloc+2, 0xFF, taille_padding);											// #
+	}																					// ##
+
+	bloc[2+taille_padding] = 0x00;														// ##
+	memcpy(bloc+3+taille_padding, donnees, taille_donnees);								// ##  Séparateur et données
+};
+
+
+// Cette fonction retire le padding PKCS#1 v1.5 d'un bloc de k octets
+// Un déchiffrement n'accepte que le type 2 et une vérification de signature que le type 1, pour qu'un bloc ne puisse pas servir dans l'autre usage
+// Les blocs produits par les versions précédentes (octet de tête 0x10 dans les deux usages, éventuellement sans 0x00 initial) sont acceptés
+// Entrée : un tableau bloc de k octets, un entier k et un entier signature valant 0 pour un déchiffrement et 1 pour une signature
+// Sortie : la position du premier octet de données dans bloc, ou -1 si le bloc est mal formé ou n'a pas le type attendu
+int decoder_pkcs1(unsigned char* bloc, int k, unsigned int signature)
+{
+	unsigned char type = (signature == 0) ? 0x02 : 0x01;								// ##
+	int i = 0;																			// #
+	if(bloc[0] == 0x00)																	// #
+	{																					// #
+		i = 1;																			// #  Vérification de l'octet de type
+	}																					// #
+	if((bloc[i] != type) && (bloc[i] != 0x10))											// #
+	{																					// #
+		return -1;																		// #
+	}																					// ##
+
+	int debut_padding = i+1;															// ##
+	i = debut_padding;																	// #
+	while((i < k) && (bloc[i] != 0x00))													// #  Recherche du séparateur 0x00 après au moins 8 octets de padding
+	{																					// #
+		i++;																			// #
+	}																					// #
+	if((i == k) || (i - debut_padding < 8))												// #
+	{																					// #
+		return -1;																		// #
+	}																					// ##
+
+	return i+1;
+};
+
+
+// Cette fonction écrit un mpz dans un bloc de k octets en big-endian, complété à gauche par des zéros
+// Entrée : un tableau bloc de k octets, un entier k et un mpz m
+// Sortie : 0 si m tient sur k octets, -1 sinon
+int mpz_vers_bloc(unsigned char* bloc, int k, mpz_t m)
+{
+	size_t taille = (mpz_sizeinbase(m,2)+7)/8;											// ##
+	if(taille > (size_t) k)																// #
+	{																					// #
+		return -1;																		// #  Conversion en une seule passe avec mpz_export()
+	}																					// #
+	memset(bloc, 0, k-taille);															// #
+	mpz_export(bloc+k-taille, NULL, 1, 1, 1, 0, m);										// ##
+	return 0;
+};
+
+
+// Découpage d'un fichier en sous-messages, calculé avant toute lecture
+typedef struct
+{
+	unsigned long taille_fichier;
+	unsigned long nb_blocs;
+	unsigned int taille_bloc;
+	unsigned int taille_dernier_bloc;
+} plan_blocs;
+
+
+// Cette fonction donne la taille d'un fichier ouvert sans le lire, à l'aide de fstat()
+// Entrée : un flux fichier
+// Sortie : la taille du fichier en octets
+unsigned long taille_flux(FILE* fichier)
+{
+	struct stat informations;
+	fstat(fileno(fichier), &informations);
+	return informations.st_size;
+};
+
+
+// Cette fonction prépare le découpage d'un fichier en blocs de taille_bloc octets
+// Entrée : un plan, la taille du fichier et la taille d'un bloc
+// Sortie : vide mais plan contient le nombre de blocs et la taille du dernier bloc (éventuellement partiel)
+void planifier_blocs(plan_blocs* plan, unsigned long taille_fichier, unsigned int taille_bloc)
+{
+	plan->taille_fichier = taille_fichier;												// ##
+	plan->taille_bloc = taille_bloc;													// #
+	plan->nb_blocs = (taille_fichier + taille_bloc - 1) / taille_bloc;					// #  Nombre de blocs et taille du dernier
+	plan->taille_dernier_bloc = taille_fichier - (plan->nb_blocs - 1) * taille_bloc;	// #
+	if(plan->nb_blocs == 0)																// #
+	{																					// #
+		plan->taille_dernier_bloc = 0;													// #
+	}																					// ##
+};
+
+
+// Cette fonction applique le padding PKCS#1 v1.5 à un fichier et chiffre ou signe chaque sous-message
+// Le fichier est lu une seule fois, par tranches d'environ TAILLE_LECTURE octets contenant un nombre entier de sous-messages
+// Entrée : deux flux clair et cypher, deux mpz e et n, un entier taille_fichier correspondant à la taille de clair et un entier signature choisissant le type de bloc
+// Sortie : 0 si tous les sous-messages chiffrés ou signés sont écrits dans cypher, -1 si clair ne peut pas être lu jusqu'au bout ou cypher écrit
+int chiffrer_pkcs1(FILE* clair, FILE* cypher, mpz_t e, mpz_t n, unsigned long taille_fichier, unsigned int signature)
+{
+	mpz_t m;																			// ##
+	mpz_init(m);																		// #
+	int k = taille_256(n);																// #
+	plan_blocs plan;																	// #
+	planifier_blocs(&plan, taille_fichier, k-11);										// #  Initialisation des variables, du plan et des tampons
+	unsigned long blocs_par_lecture = TAILLE_LECTURE / plan.taille_bloc + 1;			// #
+	unsigned char* bloc = malloc(k);													// #
+	unsigned char* tampon = malloc(blocs_par_lecture * plan.taille_bloc);				// #
+	unsigned char* donnees = tampon;													// #
+	int erreur = 0;																		// ##
+
+	for(unsigned long i = 0; i < plan.nb_blocs; i++)									// #  Boucle sur les sous-messages prévus par le plan
+	{
+		if(i % blocs_par_lecture == 0)													// ##
+		{																				// #
+			unsigned long taille_lecture = plan.taille_fichier - i * plan.taille_bloc;	// #
+			if(taille_lecture > blocs_par_lecture * plan.taille_bloc)					// #
+			{																			// #  Lecture de la tranche suivante du fichier
+				taille_lecture = blocs_par_lecture * plan.taille_bloc;					// #
+			}																			// #
+			if(fread(tampon, 1, taille_lecture, clair) != taille_lecture)				// #
+			{																			// #
+				erreur = -1;															// #  Une lecture incomplète arrête le chiffrement
+				break;																	// #
+			}																			// #
+			donnees = tampon;															// #
+		}																				// ##
+
+		int taille_donnees = (i == plan.nb_blocs-1) ? plan.taille_dernier_bloc : plan.taille_bloc;	// ##
+		encoder_pkcs1(bloc, k, donnees, taille_donnees, signature);						// #
+		mpz_import(m, k, 1, 1, 1, 0, bloc);												// #  Encodage, chiffrement ou signature et écriture du sous-message
+		exp_mod(m,m,e,n);																// #
+		if(mpz_out_raw(cypher,m) == 0)													// #
+		{																				// #
+			erreur = -1;																// #
+			break;																		// #
+		}																				// #
+		donnees += taille_donnees;														// ##
+	}
+
+	memset(bloc, 0, k);																	// ##
+	free(bloc);																			// #  Libération de l'espace
+	free(tampon);																		// #
+	mpz_clear(m);																		// ##
+	return erreur;
+};
+
+
 // Cette fonction sert soit à chiffrer un fichier, soit à signer un fichier 
 // Entrée : un entier signature, si signature vaut 0 on chiffre, si signature vaut 1 on signe
-// Sortie : vide mais on crée soit un fichier contenant un chiffré ou un fichier contenant une signature
+// Sortie : vide mais on crée soit un fichier contenant un chiffré ou un fichier contenant une signature, aucun si le fichier ne peut pas être lu ou le résultat écrit
 void encrypt(unsigned int signature) 
 {
 	char choix;
@@ -554,68 +1040,12 @@ void encrypt(unsigned int signature)
 
 	//gmp_fscanf(publique, " %Zd", n);													// ##
 	mpz_inp_raw(n,publique);															// #
-	srand(time(NULL));																	// #  On attribue à n la valeur de la clef publique et on calcule la taille de n en base 256
-	int taille_n = taille_256(n)-11;													// #
-	unsigned int taille_fichier = 0;													// ##
-
-
-	while (fgetc(clair)!= EOF)															// ##
-    {																					// #
-    	taille_fichier += 1;															// #  On récupère la taille du fichier à chiffrer ou signer
-    }																					// #
-    rewind(clair);																		// ##
+																						// #  On attribue à n la valeur de la clef publique et on calcule la taille de n en base 256
+	unsigned long taille_fichier = taille_flux(clair);									// ##  On récupère la taille du fichier à chiffrer ou signer sans le lire
+	setvbuf(cypher, NULL, _IOFBF, TAILLE_LECTURE);										// ##  Ecritures par grandes tranches
 
 
-    int taille_padding = 8;																// #  On initialise les variables pour le padding
-    mpz_set_ui(m,16);																	// #
-
-    if (taille_fichier-1<taille_n)														// ##
-    {																					// #
-    	taille_padding = 8 + taille_n-(taille_fichier-1);								// #
-    }																					// #
-    																					// #
-    for (int i = 0; i <taille_padding ;i++)												// #  Génération du padding pour le premier sous-message
-    {																					// #
-    	mpz_mul_ui(m,m,256);															// #
-    	int A = (int)(rand() / (double)RAND_MAX * (255 - 17))+16;						// #
-    	mpz_add_ui(m,m,A);																// #
-    }																					// ##
-
-
-    mpz_mul_ui(m,m,256);																// ##
-    mpz_add_ui(m,m,0);																	// #  Initialisation de variable pour le chiffrement ou la signature
-    unsigned int compteur = 0;															// ##
-
-
-    for (int i = 0; i < taille_fichier; i++)											// #  Boucle pour lire tout le fichier
-    {
-    	mpz_mul_ui(m,m,256);															// ##
-    	mpz_add_ui(m,m,fgetc(clair));													// #  Lecture d'un octet du fichier à chiffrer ou signer
-    	compteur = compteur+1;															// ##
-
-    	if ((compteur == taille_n) || (i==taille_fichier-1))							// #  Condition permettant de rentrer lorsque l'on a un sous-message m complet ou que l'on se trouve à la fin du fichier
-    	{																				
-    		exp_mod(m,m,e,n);															// ##
-    		//gmp_fprintf(cypher,"%Zd ",m);												// #  Calcul et écriture d'un sous-message du chiffré ou de la signature dans le fichier destination
-    		mpz_out_raw(cypher,m);														// ##
-    		
-    		mpz_set_ui(m,16);															// ##
-    		if (taille_fichier-1-i<taille_n)											// #
-    		{																			// #
-    			taille_padding = 8 + taille_n-(taille_fichier-1-i);						// #
-    		}																			// #
-    		for (int j = 0; j <taille_padding;j++)										// #  Génération du padding pour le prochain sous-message
-		    {																			// #
-		    	mpz_mul_ui(m,m,256);													// #
-		    	int A = (int)(rand() / (double)RAND_MAX * (255 - 17))+16;				// #
-		    	mpz_add_ui(m,m,A);														// #
-		    }																			// ##
-		    
-		    mpz_mul_ui(m,m,256);														// ##
-    		mpz_add_ui(m,m,0);															// #
-    		compteur = 0;																// #  Initialisation des variables pour le prochain tour
-    	}																				// #
-    }																					// ##
+    int erreur = chiffrer_pkcs1(clair,cypher,e,n,taille_fichier,signature);			// #  Padding, chiffrement ou signature de tout le fichier
 
     if(signature == 1)																	// ##
     {																					// #
@@ -623,27 +1053,37 @@ void encrypt(unsigned int signature)
     }																					// #  Fermeture des fichiers
     mpz_clears(n, m, e, NULL);															// #
     fclose(clair);																		// #
-	fclose(cypher);																		// #
+	if(fclose(cypher) != 0)																// #
+	{																					// #
+		erreur = -1;																	// #
+	}																					// #
 	fclose(publique);																	// #
 	if(signature == 1)																	// #
 	{																					// #
 		remove("HASHER");																// #
 	}																					// ##
+
+	if(erreur != 0)																		// ##
+	{																					// #
+		remove(nom_fichier_chiffrer);													// #  Pas de chiffré tronqué après une erreur de lecture ou d'écriture
+		printf("\nErreur : le fichier ne peut pas être lu ou le résultat écrit jusqu'au bout, aucun fichier n'est créé.\n\n");	// #
+	}																					// ##
 };
 
 
 // Cette fonction sert à déchiffrer un fichier en mode standard ou en mode crt ou à déchiffrer une signature
 // Entrée : deux entiers crt et signature, si signature vaut 0 on déchiffre, si signature vaut 1 on déchiffre une signature. Si crt vaut 0 on dechiffre en mode standard si crt vaut 1 on déchiffre en mode crt.
-// Sortie : vide mais on crée un fichier contenant le clair ou la signature déchiffrée
-void decrypt(unsigned int crt, unsigned int signature)
+// Sortie : 0 si on a créé un fichier contenant le clair ou la signature déchiffrée (vide pour un chiffré vide), -1 si un bloc lu est mal formé ou tronqué :
+// le déchiffrement s'arrête et le fichier est supprimé
+int decrypt(unsigned int crt, unsigned int signature)
 {														
 	char choix;																				// ##
-	mpz_t n, d, p, q, Ip, chiffre, puissance, div, dp, dq, mp, mq ;							// #
-    mpz_inits(n, d, p, q, Ip, chiffre, puissance, div,dp, dq, mp, mq,NULL);					// #
-    unsigned int lettre;																	// #  Initialisation des variables
-	unsigned int taille_n;																	// #
-	unsigned int compteur = 0;																// #
-	unsigned int taille_fichier = 0;														// #
+	mpz_t n, d, p, q, Ip, chiffre, dp, dq, mp, mq ;											// #
+    mpz_inits(n, d, p, q, Ip, chiffre, dp, dq, mp, mq,NULL);								// #
+    unsigned char* bloc;																	// #  Initialisation des variables
+	int k, debut_donnees;																	// #
+	unsigned long compteur = 0;															// #
+	unsigned long taille_fichier = 0;														// #
 	FILE* privee;																			// ##
 
 	char nom_fichier_a_dechiffrer[100];														// ##
@@ -706,9 +1146,9 @@ void decrypt(unsigned int crt, unsigned int signature)
 
 
 	FILE* clair;																															// ##
+	char nom_fichier_dechiffrer[100];																										// #
 	if(signature == 0)																														// #
 	{																																		// #
-		char nom_fichier_dechiffrer[100];																									// #
 		etiquette4:																															// #
 			printf("\nQuel est le nom du fichier dans lequel vous désirez stocker le clair? \n\n");											// #
 			scanf(" %99s", nom_fichier_dechiffrer);																							// #
@@ -731,17 +1171,16 @@ void decrypt(unsigned int crt, unsigned int signature)
 	}																																		// #
 	else																																	// #
 	{																																		// #
-		clair = fopen("signature_a_verifier","wb+");																						// #
+		strcpy(nom_fichier_dechiffrer, "signature_a_verifier");																				// #
+		clair = fopen(nom_fichier_dechiffrer,"wb+");																						// #
 	}																																		// ##
 
-	while (fgetc(cypher)!= EOF)														// ##
-    {																				// #
-    	taille_fichier ++;															// #  Récupération de la taille du fichier à déchiffrer ou vérifier
-    };																				// #
-    rewind(cypher);																	// ##
+	taille_fichier = taille_flux(cypher);											// ##  Récupération de la taille du fichier à déchiffrer ou vérifier sans le lire
+	setvbuf(cypher, NULL, _IOFBF, TAILLE_LECTURE);									// #
+	setvbuf(clair, NULL, _IOFBF, TAILLE_LECTURE);									// ##  Lectures et écritures par grandes tranches
 
-	taille_n = taille_256(n)-2;														// ##
-    ui_expo_ui(puissance,256,taille_n);												// # Initialisation des variables pour la récupération des octets
+	k = taille_256(n);																// ##
+	bloc = malloc(k);																// # Initialisation du tampon d'un bloc pour la récupération des octets
 	mpz_set_ui(chiffre,0);															// ##
 
 	if(crt == 1)																	// ##
@@ -755,9 +1194,16 @@ void decrypt(unsigned int crt, unsigned int signature)
 		mpz_add_ui(q,q,1);															// #
 	}																				// ##
 
-	do 																				// #  Boucle pour lire tout le fichier
+	debut_donnees = 0;																// #  Un chiffré vide donne un clair vide
+	while(compteur < taille_fichier)												// #  Boucle pour lire tout le fichier
 	{
-		compteur = compteur + mpz_inp_raw(chiffre,cypher);							// #  Mise à jour de la valeur de compteur et lecture du mpz_t chiffré
+		size_t lu = mpz_inp_raw(chiffre,cypher);									// ##
+		if(lu == 0)																	// #
+		{																			// #  Lecture du mpz_t chiffré et mise à jour de compteur,
+			debut_donnees = -1;														// #  un bloc tronqué est mal formé
+			break;																	// #
+		}																			// #
+		compteur = compteur + lu;													// ##
 		
 		if(crt == 0)																// ##
 		{																			// #  Déchiffrement en mode standard ou déchiffrement de la signature
@@ -776,34 +1222,17 @@ void decrypt(unsigned int crt, unsigned int signature)
 			mpz_add(chiffre,chiffre,mp);											// #
 		}																			// ##
 
-		mpz_fdiv_q(div,chiffre,puissance);											// ##
-		do   																		// #
+		debut_donnees = -1;															// ##
+		if(mpz_vers_bloc(bloc,k,chiffre) == 0)										// #
 		{																			// #
-			mpz_mul(puissance,puissance,div);										// #
-			mpz_sub(chiffre,chiffre,puissance);										// #  Suppression du padding
-			mpz_divexact(puissance,puissance,div);									// #
-			mpz_divexact_ui(puissance,puissance,256);								// #
-			mpz_fdiv_q(div,chiffre,puissance);										// #
-		}while(mpz_cmp_ui(div,0)!= 0);												// #
-		mpz_divexact_ui(puissance,puissance,256);									// ##
-
-		while(mpz_cmp_ui(puissance,0) != 0)											// ##
+			debut_donnees = decoder_pkcs1(bloc,k,signature);						// #  Suppression du padding, un bloc mal formé arrête le déchiffrement
+		}																			// #
+		if(debut_donnees < 0)														// #
 		{																			// #
-			mpz_fdiv_q(div,chiffre,puissance);										// #
-			lettre = mpz_get_ui(div) ;												// #
-			fputc(lettre,clair);													// #
-																					// #
-			if(mpz_cmp_ui(div,0) != 0)												// #  Récupération et écriture des octets de donnés dans le fichier destination
-			{																		// #
-				mpz_mul(puissance,puissance,div);									// #
-				mpz_sub(chiffre,chiffre,puissance);									// #
-				mpz_divexact(puissance,puissance,div);								// #
-			}																		// #
-			mpz_divexact_ui(puissance,puissance,256);								// #
+			break;																	// #
 		}																			// ##
-
-		ui_expo_ui(puissance,256,taille_n);											// #  Réinitialisation de la variable puissance
-	}while(compteur < taille_fichier);												
+		fwrite(bloc+debut_donnees, 1, k-debut_donnees, clair);						// #  Ecriture des octets de données dans le fichier destination
+	}
 
 	fclose(cypher);																	// ##
 	fclose(clair);																	// #
@@ -812,7 +1241,20 @@ void decrypt(unsigned int crt, unsigned int signature)
 	{																				// #
 		fclose(privee);																// #
 	}																				// #
-	mpz_clears(n, d, p, q, Ip, chiffre, puissance, div, dp, dq, mp, mq, NULL);		// ##
+	mpz_clears(n, d, p, q, Ip, chiffre, dp, dq, mp, mq, NULL);						// #
+	memset(bloc, 0, k);																// #
+	free(bloc);																		// ##
+
+	if(debut_donnees < 0)															// ##
+	{																				// #
+		remove(nom_fichier_dechiffrer);												// #  Pas de clair partiel après un bloc mal formé
+		if(signature == 0)															// #
+		{																			// #
+			printf("\nErreur : un bloc du chiffré est mal formé, le déchiffrement est interrompu.\n\n");	// #
+		}																			// #
+		return -1;																	// #
+	}																				// #
+	return 0;																		// ##
 };
 
 
@@ -821,7 +1263,7 @@ void decrypt(unsigned int crt, unsigned int signature)
 // Sortie : vide mais affichage de la validité de la signature
 void verification_signature()
 {
-	decrypt(0,1);																	// #  Déchiffrement de la signature
+	int erreur = decrypt(0,1);														// #  Déchiffrement de la signature
 
 	int caractere1, caractere2;																						// ##
 	char nom_fichier_a_verifier[100];																				// #
@@ -833,6 +1275,11 @@ void verification_signature()
 			printf("\nAttention, le nom de fichier saisi n'existe pas!");											// #
 			goto etiquette;																							// #
 		}																											// #
+	if(erreur != 0)																									// #
+	{																												// #
+		printf("\nLa signature est invalide.\n\n");																	// #  Une signature mal formée est invalide sans hasher le fichier
+		return;																										// #
+	}																												// #
 	SHA256(nom_fichier_a_verifier);																					// #
 	FILE* cypher = fopen("HASHER","rb+");																			// #
 	FILE* signature = fopen("signature_a_verifier","rb+");															// ##
@@ -861,25 +1308,185 @@ void verification_signature()
 };
 
 
+// Cette fonction renvoie le temps écoulé en secondes depuis une origine fixe
+// Entrée : vide
+// Sortie : un double contenant le temps en secondes
+double chrono()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+};
+
+
+// Cette fonction compare deux durées pour qsort()
+int comparer_durees(const void* a, const void* b)
+{
+	double x = *(const double*) a;
+	double y = *(const double*) b;
+	return (x > y) - (x < y);
+};
+
+
+#define MAX_ITERATIONS 100000		// Le nombre maximal de mesures conservées par étape
+#define BUDGET_BENCHMARK 1.0		// La durée de mesure visée par étape et par taille (en secondes)
+
+
+// Cette fonction mesure une étape du padding PKCS#1 v1.5 pendant BUDGET_BENCHMARK secondes et écrit le résultat sur une ligne JSON
+// Entrée : un flux sortie, un entier etape (0 : exp_mod, 1 : chiffrement_pkcs1, 2 : lecture), un entier bits, un entier taille et deux mpz e et n
+// Sortie : vide mais une ligne contenant ops/s, Mo/s et les percentiles de latence est ajoutée à sortie
+void mesurer(FILE* sortie, int etape, unsigned int bits, unsigned long taille, mpz_t e, mpz_t n)
+{
+	const char* noms_etapes[3] = {"exp_mod", "chiffrement_pkcs1", "lecture"};
+	unsigned char tampon[65536];
+	double* durees = malloc(MAX_ITERATIONS * sizeof(double));							// ##
+	unsigned int iterations = 0;														// #
+	double debut = chrono();															// #  Initialisation des variables
+	double t;																			// #
+	mpz_t m;																			// #
+	mpz_init_set_ui(m, 0x1234567);														// ##
+
+	do 																					// ##
+	{																					// #
+		t = chrono();																	// #
+		if(etape == 0)																	// #
+		{																				// #
+			exp_mod(m, m, e, n);														// #
+		}																				// #
+		if(etape == 1)																	// #
+		{																				// #
+			FILE* clair = fopen("benchmark_entree","rb");								// #
+			FILE* cypher = fopen("benchmark_sortie","wb");								// #  Répétition de l'étape jusqu'à épuisement du budget
+			chiffrer_pkcs1(clair, cypher, e, n, taille, 0);								// #
+			fclose(clair);																// #
+			fclose(cypher);																// #
+		}																				// #
+		if(etape == 2)																	// #
+		{																				// #
+			FILE* clair = fopen("benchmark_entree","rb");								// #
+			while(fread(tampon, 1, sizeof(tampon), clair) == sizeof(tampon));			// #
+			fclose(clair);																// #
+		}																				// #
+		durees[iterations] = chrono() - t;												// #
+		iterations++;																	// #
+	}while((iterations < MAX_ITERATIONS) && (chrono() - debut < BUDGET_BENCHMARK));		// ##
+
+	double total = chrono() - debut;													// ##
+	qsort(durees, iterations, sizeof(double), comparer_durees);							// #  Calcul des débits et des percentiles
+	double p50 = durees[(iterations-1)*50/100] * 1e6;									// #
+	double p90 = durees[(iterations-1)*90/100] * 1e6;									// #
+	double p99 = durees[(iterations-1)*99/100] * 1e6;									// ##
+
+	fprintf(sortie, "{\"etape\":\"%s\",\"bits\":%u,\"taille\":%lu,\"iterations\":%u,\"ops_s\":%.3f,\"mo_s\":%.3f,\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"valide\":true}\n",
+		noms_etapes[etape], bits, taille, iterations, iterations / total, taille * (iterations / total) / 1e6, p50, p90, p99);
+	fflush(sortie);
+	printf("%-28s %6u bits %12lu octets %12.3f ops/s %10.3f Mo/s  p50 %.1f us\n", noms_etapes[etape], bits, taille, iterations / total, taille * (iterations / total) / 1e6, p50);
+
+	mpz_clear(m);
+	free(durees);
+};
+
+
+// Cette fonction mesure le chiffrement PKCS#1 v1.5 pour des clefs de 1024 à 4096 bits et des fichiers de 1 Ko à 1 Go
+// Entrée : un générateur aléatoire generateur
+// Sortie : vide mais les mesures sont écrites au format JSON, une ligne par étape, dans le fichier choisi
+void benchmark(gmp_randstate_t generateur)
+{
+	char choix;
+	unsigned long taille_max;
+	unsigned int tailles_bits[4] = {1024, 2048, 3072, 4096};
+	unsigned long tailles_fichiers[5] = {1024, 32768, 1048576, 33554432, 1073741824};
+
+	char nom_fichier_resultats[100];																									// ##
+	etiquette:																															// #
+		printf("\nQuel est le nom du fichier dans lequel vous désirez stocker les mesures?\n\n");										// #
+		scanf(" %99s", nom_fichier_resultats);																							// #
+		if(access( nom_fichier_resultats, F_OK ) == 0)																					// #
+		{																																// #
+			printf("\nAttention, le nom de fichier saisi existe déjà, êtes-vous sûr de vouloir l'effacer?[Y/N]\n\n");					// #
+			scanf(" %c",&choix);																										// #
+			while((choix != 'Y') & (choix != 'N'))																						// #  Création et ouverture du fichier des mesures
+			{																															// #
+				printf("Le choix que vous avez fait n'a pas été compris, êtes-vous sûr de vouloir l'effacer (attendu Y ou N)?\n\n");	// #
+				scanf(" %c",&choix);																									// #
+			}																															// #
+			if(choix == 'N')																											// #
+			{																															// #
+				goto etiquette;																											// #
+			}																															// #
+		}																																// #
+	FILE* sortie = fopen(nom_fichier_resultats,"w");																					// ##
+
+	printf("\nQuelle est la taille maximale des fichiers de test (en Ko, de 1 à 1048576)?\n\n");
+	scanf(" %lu", &taille_max);
+
+	unsigned char tampon[65536];														// ##
+	mpz_t e, n, p;																		// #
+	mpz_inits(e, n, p, NULL);															// #  Initialisation des variables
+	mpz_set_ui(e, 65537);																// ##
+
+	for(int t = 0; t < 4; t++)
+	{
+		mpz_urandomb(p, generateur, tailles_bits[t]/2);									// ##
+		mpz_setbit(p, tailles_bits[t]/2 - 1);											// #
+		mpz_nextprime(p, p);															// #
+		mpz_urandomb(n, generateur, tailles_bits[t]/2);									// #  Module de test de la taille voulue
+		mpz_setbit(n, tailles_bits[t]/2 - 1);											// #
+		mpz_nextprime(n, n);															// #
+		mpz_mul(n, n, p);																// ##
+
+		mesurer(sortie, 0, tailles_bits[t], 0, e, n);
+
+		for(int f = 0; f < 5; f++)
+		{
+			if(tailles_fichiers[f] > taille_max*1024)
+			{
+				continue;
+			}
+
+			FILE* fichier = fopen("benchmark_entree","wb");								// ##
+			for(unsigned long i = 0; i < tailles_fichiers[f]; i += sizeof(tampon))		// #
+			{																			// #
+				alea_octets(tampon, sizeof(tampon));									// #  Création du fichier de test
+				fwrite(tampon, 1, (tailles_fichiers[f] - i < sizeof(tampon)) ? tailles_fichiers[f] - i : sizeof(tampon), fichier);	// #
+			}																			// #
+			fclose(fichier);															// ##
+
+			mesurer(sortie, 1, tailles_bits[t], tailles_fichiers[f], e, n);
+			if(t == 0)
+			{
+				mesurer(sortie, 2, 0, tailles_fichiers[f], e, n);
+			}
+		}
+	}
+
+	fclose(sortie);																		// ##
+	remove("benchmark_entree");															// #  Fermeture et suppression des fichiers de test
+	remove("benchmark_sortie");															// #
+	mpz_clears(e, n, p, NULL);															// ##
+};
+
+
 // Corps du programme
 int main()
 {
 	gmp_randstate_t generateur;					// ##
 	gmp_randinit_default(generateur);			// #  Initialisation des variable et du générateur aléatoire
-	gmp_randseed_ui(generateur, time(NULL));	// #
+	semer_generateur_gmp(generateur);			// #
+	charger_profil_hote();						// #  Lecture des réglages mesurés sur cette machine
 	unsigned int choix1, choix2, nombre_bit;	// ##
 
 
-	printf("\nBienvenue dans le programme de chiffrement RSA, que souhaitez-vous faire?\n\n1 : Générer de nouvelles clés RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");	// #  Affichage des options du programme
+	printf("\nBienvenue dans le programme de chiffrement RSA, que souhaitez-vous faire?\n\n" MENU);	// #  Affichage des options du programme
 	
 
 	marqueur:
-		scanf(" %d", &choix1);																																																																// ##
-		while((choix1 != 1) & (choix1 != 2) & (choix1 != 3) & (choix1 != 4) & (choix1 != 5) & (choix1 != 6))																																												// #
-		{																																																																					// #  Boucle pour avoir une réponse valide
-			printf("\nLe chiffre que vous avez indiqué ne correspond à aucune commande, que souhaiez-vous faire?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");	// #
-			scanf(" %d", &choix1);																																																															// #
-		}																																																																					// ##
+		scanf(" %d", &choix1);																									// ##
+		while((choix1 < 1) | (choix1 > NB_OPTIONS))																				// #
+		{																														// #  Boucle pour avoir une réponse valide
+			printf("\nLe chiffre que vous avez indiqué ne correspond à aucune commande, que souhaiez-vous faire?\n\n" MENU);	// #
+			scanf(" %d", &choix1);																								// #
+		}																														// ##
 		
 
 		switch(choix1)	// #  Switch séparant toutes les options du programmes
@@ -890,10 +1497,10 @@ int main()
 				scanf(" %d", &nombre_bit);
 
 
-				generation_cle(nombre_bit, generateur);
+				generation_cle(nombre_bit);
 
 
-				printf("\nQue souhaitez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
@@ -904,7 +1511,7 @@ int main()
 				encrypt(0);
 
 
-				printf("\nQue souhaitez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
@@ -933,7 +1540,7 @@ int main()
 
 
 
-				printf("\nQue souhaitez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
@@ -942,7 +1549,7 @@ int main()
 
 				encrypt(1);
 
-				printf("\nQue souhaitez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
@@ -951,7 +1558,7 @@ int main()
 
 				verification_signature();
 
-				printf("\nQue souhaitez-vous faire maintenant?\n\n1 : Générer de nouvelles clé RSA\n2 : Chiffrer un fichier\n3 : Déchiffrer un fichier\n4 : Signer un fichier\n5 : Vérifier une signature\n6 : Arret du programme\n\n");
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
 				goto marqueur;
 				break;
 
@@ -959,6 +1566,15 @@ int main()
 
 				printf("\nArret du programme.\n");
 				break;
+
+			case 7:		// #  Mesure des performances
+
+
+				benchmark(generateur);
+
+				printf("\nQue souhaitez-vous faire maintenant?\n\n" MENU);
+				goto marqueur;
+				break;
 		}
 
 	gmp_randclear(generateur);